@@ -21,26 +21,26 @@
 
 int main ( void )
 {
-	// mlogInfo(&log, "Jerry is born!");
+	// mlogInfo(LOG_BORN);
 
 	/* ======================================================================
 	 * Setup
 	 */
-	// mlogInfo(&log, "Initializing machinery ...");
+	// mlogInfo(LOG_INIT);
 
 	/// \todo Initialization code goes here
 
-	// mlogInfo(&log, "Every systems up!");
+	// mlogInfo(LOG_UP);
 
 
 	/* ======================================================================
 	 * Main loop
 	 */
-	// mlogInfo(&log, "Press start to begin the search!");
+	// mlogInfo(LOG_WAIT_START);
 
 	// util_waitStart();
 
-	// mlogInfo(&log, "Let the search begin!");
+	// mlogInfo(LOG_START);
 
 	// while (!state_isFinished()) {
 		// util_waitStep10ms();       // Cycle time is 10ms
@@ -57,13 +57,13 @@ int main ( void )
 		// actuators_update();        // Apply changes to actuators
 	// }
 
-	// mlogInfo(&log, "I got the there!");
+	// mlogInfo(LOG_GOAL);
 
-	// mlogInfo(&log, "Shuting down systems...");
+	// mlogInfo(LOG_SHUTDOWN);
 
 	/// \todo Stop code goes here
 
-	// mlogInfo(&log, "Jerry is terminated!");
+	// mlogInfo(LOG_TERMINATED);
 
 	return 0;
 }
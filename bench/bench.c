@@ -0,0 +1,337 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  bench/bench.c
+ *  \brief Run the microbenchmarks and compare them with a baseline.
+ *
+ *    usage: bench [-b baseline] [-t percent] [-u] [name ...]
+ *
+ *  Every benchmark (or the ones named) is first calibrated to run for at
+ *   least BENCH_REP_NS, then run BENCH_REPS times. The median time per
+ *   operation is reported, with the minimum and the spread (median
+ *   absolute deviation, in %), which tells how noisy the host was.
+ *
+ *  With -b the medians are compared with the baseline file, and the
+ *   program exits with status 1 if any is slower than the baseline by more
+ *   than the threshold (-t, BENCH_THRESHOLD % by default). A benchmark
+ *   that looks regressed is measured again, up to BENCH_TRIES times, so a
+ *   noisy host doesn't fail the check. With -u the baseline file is
+ *   updated instead, from the median of BENCH_TRIES measurements.
+ *
+ *  The baseline is a text file, one "name ns" line per benchmark. Its
+ *   values only hold for the host they were measured on.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+/* System headers go first, base.h defines an abs() macro */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <base.h>
+#include <mouse/mouse.h>
+#include "bench.h"
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Number of timed runs of each benchmark.
+ */
+#define BENCH_REPS       21
+
+/**
+ *  \brief Minimum duration of each run, in nanoseconds.
+ */
+#define BENCH_REP_NS     2000000
+
+/**
+ *  \brief Default regression threshold, in %.
+ */
+#define BENCH_THRESHOLD  25
+
+/**
+ *  \brief Times a benchmark is measured when updating the baseline (the
+ *   median is kept), or at most when it looks regressed (the best is kept).
+ */
+#define BENCH_TRIES      3
+
+
+/* ========================================================================== */
+
+#define BENCH(name) BENCH_##name,
+enum { BENCH_LIST N_BENCHES };
+#undef BENCH
+
+typedef struct {
+	const char* name;
+	void (*run) ( uint n );
+} benchEntry;
+
+#define BENCH(name) { #name, bench_##name },
+static const benchEntry benches[N_BENCHES] = { BENCH_LIST };
+#undef BENCH
+
+volatile int bench_sink = 0;
+
+static uint   seed = 2463534242u;                 // xorshift32 state
+static double baseline[N_BENCHES];                // 0 if not in the baseline
+
+
+/* ========================================================================== */
+
+static ulong nsNow ( void )
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+static int cmpDouble ( const void* a, const void* b )
+{
+	double x = *(const double*) a;
+	double y = *(const double*) b;
+
+	return (x > y) - (x < y);
+}
+
+void bench_random ( int* values, uint len, int min, int max )
+{
+	uint i;
+
+	for (i = 0; i < len; i++) {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+
+		values[i] = min + (int) (seed % (uint) (max - min + 1));
+	}
+}
+
+/* ===================
+ * Median, minimum and spread (in %) of the time per operation, in ns
+ */
+static void measure ( const benchEntry* bench, double* median, double* min, double* spread )
+{
+	double ns[BENCH_REPS];
+	double dev[BENCH_REPS];
+	ulong  start, t;
+	uint   n, i;
+
+	bench->run(0);                                // Draw the inputs
+
+	/* Double the operations until a run is long enough, this also warms up
+	 * the caches and the branch predictors */
+	for (n = 1024; ; n *= 2) {
+		start = nsNow();
+		bench->run(n);
+		t = nsNow() - start;
+
+		if (t >= BENCH_REP_NS)
+			break;
+	}
+
+	for (i = 0; i < BENCH_REPS; i++) {
+		start = nsNow();
+		bench->run(n);
+		ns[i] = (double) (nsNow() - start) / n;
+	}
+
+	qsort(ns, BENCH_REPS, sizeof(double), cmpDouble);
+
+	(*median) = ns[BENCH_REPS / 2];
+	(*min)    = ns[0];
+
+	for (i = 0; i < BENCH_REPS; i++) {
+		dev[i] = ns[i] > (*median) ? ns[i] - (*median) : (*median) - ns[i];
+	}
+
+	qsort(dev, BENCH_REPS, sizeof(double), cmpDouble);
+
+	(*spread) = 100.0 * dev[BENCH_REPS / 2] / (*median);
+}
+
+static bool regressed ( int bench, double median, double threshold )
+{
+	return baseline[bench] > 0 && median > baseline[bench] * (100.0 + threshold) / 100.0;
+}
+
+static bool loadBaseline ( const char* path )
+{
+	char   name[64];
+	double ns;
+	FILE*  f;
+	int    i;
+
+	if ((f = fopen(path, "r")) == NULL)
+		return false;
+
+	while (fscanf(f, "%63s %lf", name, &ns) == 2) {
+		for (i = 0; i < N_BENCHES; i++) {
+			if (strcmp(name, benches[i].name) == 0) {
+				baseline[i] = ns;
+			}
+		}
+	}
+
+	fclose(f);
+
+	return true;
+}
+
+static bool saveBaseline ( const char* path )
+{
+	FILE* f;
+	int   i;
+
+	if ((f = fopen(path, "w")) == NULL)
+		return false;
+
+	for (i = 0; i < N_BENCHES; i++) {
+		if (baseline[i] > 0) {
+			fprintf(f, "%s %.3f\n", benches[i].name, baseline[i]);
+		}
+	}
+
+	fclose(f);
+
+	return true;
+}
+
+static bool selected ( const char* name, int argc, char** argv )
+{
+	int i;
+
+	if (optind >= argc)
+		return true;
+
+	for (i = optind; i < argc; i++) {
+		if (strcmp(name, argv[i]) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+
+/* ========================================================================== */
+
+int main ( int argc, char** argv )
+{
+	const char* path = NULL;
+	double threshold = BENCH_THRESHOLD;
+	double median, min, spread;
+	double tries[BENCH_TRIES][3];
+	bool   update = false;
+	uint   regressions = 0;
+	int    opt, i, t;
+
+	while ((opt = getopt(argc, argv, "b:t:u")) != -1) {
+		switch (opt) {
+		case 'b':
+			path = optarg;
+			break;
+		case 't':
+			threshold = atof(optarg);
+			break;
+		case 'u':
+			update = true;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-b baseline] [-t percent] [-u] [name ...]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (update && path == NULL) {
+		fprintf(stderr, "bench: -u needs a baseline file (-b)\n");
+		return 1;
+	}
+
+	if (path != NULL && !loadBaseline(path) && !update) {
+		fprintf(stderr, "bench: can't read baseline %s\n", path);
+		return 1;
+	}
+
+	mouse_init();                                   // The modules use the HAL
+
+	printf("%-16s %10s %10s %8s %10s %8s\n", "benchmark", "median ns", "min ns",
+		"spread", "baseline", "change");
+
+	for (i = 0; i < N_BENCHES; i++) {
+		if (!selected(benches[i].name, argc, argv))
+			continue;
+
+		if (update) {
+			for (t = 0; t < BENCH_TRIES; t++) {
+				measure(&benches[i], &tries[t][0], &tries[t][1], &tries[t][2]);
+			}
+
+			qsort(tries, BENCH_TRIES, sizeof(tries[0]), cmpDouble);   // By median
+
+			median = tries[BENCH_TRIES / 2][0];
+			min    = tries[BENCH_TRIES / 2][1];
+			spread = tries[BENCH_TRIES / 2][2];
+
+		} else {
+			measure(&benches[i], &median, &min, &spread);
+
+			for (t = 1; t < BENCH_TRIES && regressed(i, median, threshold); t++) {
+				measure(&benches[i], &tries[0][0], &tries[0][1], &tries[0][2]);
+
+				if (tries[0][0] < median) {
+					median = tries[0][0];
+					min    = tries[0][1];
+					spread = tries[0][2];
+				}
+			}
+		}
+
+		printf("%-16s %10.2f %10.2f %7.1f%%", benches[i].name, median, min, spread);
+
+		if (update) {
+			baseline[i] = median;
+			printf("  (updated)\n");
+
+		} else if (baseline[i] > 0) {
+			printf(" %10.2f %+7.1f%%", baseline[i], 100.0 * (median - baseline[i]) / baseline[i]);
+
+			if (regressed(i, median, threshold)) {
+				printf("  REGRESSION");
+				regressions++;
+			}
+
+			printf("\n");
+
+		} else {
+			printf(" %10s\n", path != NULL ? "new" : "-");
+		}
+	}
+
+	if (update && !saveBaseline(path)) {
+		fprintf(stderr, "bench: can't write baseline %s\n", path);
+		return 1;
+	}
+
+	if (regressions) {
+		fprintf(stderr, "bench: %u benchmarks regressed more than %.0f%%\n", regressions, threshold);
+		return 1;
+	}
+
+	return 0;
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,72 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  bench/bench.h
+ *  \brief Host microbenchmarks of the library hot paths.
+ *
+ *  Each benchmark runs an operation n times over randomized inputs. It is
+ *   called first with n = 0, to draw the inputs from a fixed seed before
+ *   the timing starts, so every run sees the same ones. See bench.c for
+ *   the measurement.
+ *
+ *  To add a benchmark, add it to BENCH_LIST and define bench_<name>() in
+ *   the file of the module it measures.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+
+#include <base.h>
+
+
+/* ========================================================================== */
+
+#define BENCH_LIST \
+	BENCH(stBinSens) \
+	BENCH(updateBattery) \
+	BENCH(updateOdometry) \
+	BENCH(motorsPI) \
+	BENCH(servoToPos) \
+	BENCH(servoToDegree) \
+	BENCH(pwmMotor) \
+	BENCH(pwmServo) \
+	BENCH(mapUpdate) \
+	BENCH(avoidUpdate) \
+	BENCH(dwaUpdate) \
+	BENCH(mclUpdate)
+
+/**
+ *  \brief Number of random inputs of each benchmark (power of 2), they are
+ *   used in a loop.
+ */
+#define BENCH_INPUTS  4096
+#define BENCH_MASK    (BENCH_INPUTS - 1)
+
+
+/* ========================================================================== */
+
+#define BENCH(name) void bench_##name ( uint n );
+BENCH_LIST
+#undef BENCH
+
+/**
+ *  \brief Results are added to it, so the compiler can't drop the work.
+ */
+extern volatile int bench_sink;
+
+/**
+ *  \brief Fill an array with random values in [min, max].
+ */
+void bench_random ( int* values, uint len, int min, int max );
+
+
+/* ========================================================================== */
+#endif /* __BENCH_H__ */
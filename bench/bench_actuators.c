@@ -0,0 +1,83 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  bench/bench_actuators.c
+ *  \brief Benchmarks of the actuators module.
+ *
+ *  The module is included, so its static functions and macros can be used
+ *   directly.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include "../lib/mouse/actuators.c"
+#include "bench.h"
+
+
+/* ========================================================================== */
+
+static int inputs[3][BENCH_INPUTS];
+
+
+/* ========================================================================== */
+
+void bench_motorsPI ( uint n )
+{
+	static actuatorsCtx ctx;
+	uint i, j;
+
+	actuators_init_r(&ctx, state_default());
+
+	if (n == 0) {                           // Setup
+		bench_random(inputs[0], BENCH_INPUTS, -30, 30);
+		bench_random(inputs[1], BENCH_INPUTS, -30, 30);
+		bench_random(inputs[2], BENCH_INPUTS, -30, 30);
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		j = i & BENCH_MASK;
+
+		sensors.enc_left  = inputs[0][j];
+		sensors.enc_right = inputs[1][j];
+		motorsPI(&ctx, inputs[2][j], inputs[2][j] / 2);
+		bench_sink += actuators.vel_left;
+	}
+}
+
+void bench_servoToPos ( uint n )
+{
+	uint i;
+
+	if (n == 0) {                           // Setup
+		bench_random(inputs[0], BENCH_INPUTS, SERVO_DEGREE_MIN, SERVO_DEGREE_MAX);
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		bench_sink += SERVO_DEGREE_TO_POS(inputs[0][i & BENCH_MASK]);
+	}
+}
+
+void bench_servoToDegree ( uint n )
+{
+	uint i;
+
+	if (n == 0) {                           // Setup
+		bench_random(inputs[0], BENCH_INPUTS, SERVO_POS_LEFT, SERVO_POS_RIGHT);
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		bench_sink += SERVO_POS_TO_DEGREE(inputs[0][i & BENCH_MASK]) +
+		              SERVO_POS_TO_MDEGREE(inputs[0][i & BENCH_MASK]);
+	}
+}
+
+
+/* = EOF ==================================================================== */
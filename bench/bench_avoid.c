@@ -0,0 +1,63 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  bench/bench_avoid.c
+ *  \brief Benchmarks of the obstacle avoidance module.
+ *
+ *  The module is included, so its static functions can be called directly.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include "../lib/mouse/avoid.c"
+#include "bench.h"
+#include <hal/robot.h>
+
+
+/* ========================================================================== */
+
+static int inputs[7][BENCH_INPUTS];
+
+
+/* ========================================================================== */
+
+void bench_avoidUpdate ( uint n )
+{
+	static avoidCtx ctx;
+	uint i, j;
+
+	if (n == 0) {                           // Setup
+		avoid_init_r(&ctx);
+
+		/* Poses around a small area, so the places kept stay in range,
+		 *  readings from 5 cm to out of range */
+		bench_random(inputs[0], BENCH_INPUTS, -100, 100);
+		bench_random(inputs[1], BENCH_INPUTS, -100, 100);
+		bench_random(inputs[2], BENCH_INPUTS, -179, 180);
+		bench_random(inputs[3], BENCH_INPUTS, 50, 1000);
+		bench_random(inputs[4], BENCH_INPUTS, 50, 1000);
+		bench_random(inputs[5], BENCH_INPUTS, 50, 1000);
+		bench_random(inputs[6], BENCH_INPUTS, -179, 180);
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		j = i & BENCH_MASK;
+
+		sensors.obst_sens_right = inputs[3][j];
+		sensors.obst_sens_front = inputs[4][j];
+		sensors.obst_sens_left  = inputs[5][j];
+
+		avoid_update_r(&ctx, inputs[0][j], inputs[1][j], inputs[2][j], inputs[6][j]);
+	}
+
+	bench_sink += ctx.left;
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,77 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  bench/bench_dwa.c
+ *  \brief Benchmarks of the dynamic window planner module.
+ *
+ *  The module is included, so its static functions can be called directly.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include "../lib/mouse/dwa.c"
+#include "bench.h"
+#include <hal/robot.h>
+
+
+/* ========================================================================== */
+
+static int inputs[8][BENCH_INPUTS];
+
+
+/* ========================================================================== */
+
+void bench_dwaUpdate ( uint n )
+{
+	static mapCtx map;
+	static dwaCtx ctx;
+	uint i, j;
+
+	if (n == 0) {                           // Setup
+		map_clear_r(&map, 0, 0);
+		dwa_init_r(&ctx, &map);
+
+		/* Walls all around a 1 x 1 m area, from its center */
+		sensors.obst_sens_right = 44;
+		sensors.obst_sens_front = 44;
+		sensors.obst_sens_left  = 44;
+
+		for (i = 0; i < 360; i += 5) {
+			map_update_r(&map, 0, 0, i - 179);
+		}
+
+		/* Poses inside it, readings from 5 cm to out of range, goals
+		 *  around it */
+		bench_random(inputs[0], BENCH_INPUTS, -300, 300);
+		bench_random(inputs[1], BENCH_INPUTS, -300, 300);
+		bench_random(inputs[2], BENCH_INPUTS, -179, 180);
+		bench_random(inputs[3], BENCH_INPUTS, 5, 1000);
+		bench_random(inputs[4], BENCH_INPUTS, 5, 1000);
+		bench_random(inputs[5], BENCH_INPUTS, 5, 1000);
+		bench_random(inputs[6], BENCH_INPUTS, -1000, 1000);
+		bench_random(inputs[7], BENCH_INPUTS, -1000, 1000);
+		return;
+	}
+
+	/* Always the most samples, the budget is never over */
+	for (i = 0; i < n; i++) {
+		j = i & BENCH_MASK;
+
+		sensors.obst_sens_right = inputs[3][j];
+		sensors.obst_sens_front = inputs[4][j];
+		sensors.obst_sens_left  = inputs[5][j];
+
+		dwa_update_r(&ctx, inputs[0][j], inputs[1][j], inputs[2][j],
+			inputs[6][j], inputs[7][j], 1000000);
+	}
+
+	bench_sink += ctx.left;
+}
+
+
+/* = EOF ==================================================================== */
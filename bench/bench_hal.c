@@ -0,0 +1,60 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  bench/bench_hal.c
+ *  \brief Benchmarks of the PWM mapping done by the robot HAL.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include "../lib/hal/pwm.h"
+#include "bench.h"
+
+
+/* ========================================================================== */
+
+static int inputs[BENCH_INPUTS];
+
+
+/* ========================================================================== */
+
+/* ===================
+ * Both motors, as on every timer 2 interrupt
+ */
+void bench_pwmMotor ( uint n )
+{
+	bool reverse;
+	uint i;
+
+	if (n == 0) {                           // Setup
+		bench_random(inputs, BENCH_INPUTS, M_MINVEL, M_MAXVEL);
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		bench_sink += pwm_motor(inputs[i & BENCH_MASK], 64, &reverse) + reverse;
+		bench_sink += pwm_motor(-inputs[i & BENCH_MASK], 64, &reverse) + reverse;
+	}
+}
+
+void bench_pwmServo ( uint n )
+{
+	uint i;
+
+	if (n == 0) {                           // Setup
+		bench_random(inputs, BENCH_INPUTS, SERVO_POS_LEFT - 5, SERVO_POS_RIGHT + 5);
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		bench_sink += pwm_servo(pwm_servoLevel(inputs[i & BENCH_MASK]));
+	}
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,61 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  bench/bench_map.c
+ *  \brief Benchmarks of the map module.
+ *
+ *  The module is included, so its static functions can be called directly.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include "../lib/mouse/map.c"
+#include "bench.h"
+#include <hal/robot.h>
+
+
+/* ========================================================================== */
+
+static int inputs[6][BENCH_INPUTS];
+
+
+/* ========================================================================== */
+
+void bench_mapUpdate ( uint n )
+{
+	static mapCtx ctx;
+	uint i, j;
+
+	if (n == 0) {                           // Setup
+		map_clear_r(&ctx, 0, 0);
+
+		/* Poses in a 4 x 4 m arena, readings from 5 cm to out of range */
+		bench_random(inputs[0], BENCH_INPUTS, -2000, 2000);
+		bench_random(inputs[1], BENCH_INPUTS, -2000, 2000);
+		bench_random(inputs[2], BENCH_INPUTS, -179, 180);
+		bench_random(inputs[3], BENCH_INPUTS, 50, 1000);
+		bench_random(inputs[4], BENCH_INPUTS, 50, 1000);
+		bench_random(inputs[5], BENCH_INPUTS, 50, 1000);
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		j = i & BENCH_MASK;
+
+		sensors.obst_sens_right = inputs[3][j];
+		sensors.obst_sens_front = inputs[4][j];
+		sensors.obst_sens_left  = inputs[5][j];
+
+		map_update_r(&ctx, inputs[0][j], inputs[1][j], inputs[2][j]);
+	}
+
+	bench_sink += ctx.cells[0];
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,65 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  bench/bench_mcl.c
+ *  \brief Benchmarks of the Monte Carlo localization module.
+ *
+ *  The module is included, so its static functions can be called directly.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include "../lib/mouse/mcl.c"
+#include "bench.h"
+#include <hal/robot.h>
+
+
+/* ========================================================================== */
+
+static int inputs[3][BENCH_INPUTS];
+
+
+/* ========================================================================== */
+
+void bench_mclUpdate ( uint n )
+{
+	static mclCtx ctx;
+	uint i, j;
+
+	if (n == 0) {                           // Setup
+		mcl_init_r(&ctx);
+
+		/* A 4 x 3 m arena with two walls, the particles between them */
+		mcl_setArena_r(&ctx, 4000, 3000);
+		mcl_addWall_r(&ctx, 1000, 0, 1000, 1800);
+		mcl_addWall_r(&ctx, 2000, 3000, 2000, 1200);
+		mcl_setPose_r(&ctx, 1500, 600, 0, 200, 20);
+
+		/* Readings from 5 cm to out of range */
+		bench_random(inputs[0], BENCH_INPUTS, 50, 1000);
+		bench_random(inputs[1], BENCH_INPUTS, 50, 1000);
+		bench_random(inputs[2], BENCH_INPUTS, 50, 1000);
+		return;
+	}
+
+	/* Back and forth, so every call is an update of all the particles */
+	for (i = 0; i < n; i++) {
+		j = i & BENCH_MASK;
+
+		sensors.obst_sens_right = inputs[0][j];
+		sensors.obst_sens_front = inputs[1][j];
+		sensors.obst_sens_left  = inputs[2][j];
+
+		mcl_update_r(&ctx, (i & 1) * 2 * MCL_STEP_DIST, 0, 0);
+	}
+
+	bench_sink += ctx.estX;
+}
+
+
+/* = EOF ==================================================================== */
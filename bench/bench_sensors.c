@@ -0,0 +1,87 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  bench/bench_sensors.c
+ *  \brief Benchmarks of the sensors module.
+ *
+ *  The module is included, so its static functions can be called directly.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include "../lib/mouse/sensors.c"
+#include "bench.h"
+
+
+/* ========================================================================== */
+
+static int inputs[2][BENCH_INPUTS];
+
+
+/* ========================================================================== */
+
+void bench_stBinSens ( uint n )
+{
+	bool state = false;
+	uint count = 0;
+	uint i;
+
+	if (n == 0) {                           // Setup
+		/* Noisy binary sensor, on 1 out of 3 samples */
+		bench_random(inputs[0], BENCH_INPUTS, 0, 2);
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		stBinSens(inputs[0][i & BENCH_MASK] == 0, &state, &count, GROUND_ST_THRESHOLD);
+		bench_sink += state;
+	}
+}
+
+void bench_updateBattery ( uint n )
+{
+	static sensorsCtx ctx;
+	uint i;
+
+	sensors_init_r(&ctx, state_default());
+
+	if (n == 0) {                           // Setup
+		bench_random(inputs[0], BENCH_INPUTS, 900, 1023);
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		sensors.battery = inputs[0][i & BENCH_MASK];
+		updateBattery(&ctx);
+		bench_sink += ctx.battery;
+	}
+}
+
+void bench_updateOdometry ( uint n )
+{
+	static sensorsCtx ctx;
+	uint i;
+
+	sensors_init_r(&ctx, state_default());
+
+	if (n == 0) {                           // Setup
+		bench_random(inputs[0], BENCH_INPUTS, -30, 30);
+		bench_random(inputs[1], BENCH_INPUTS, -30, 30);
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		sensors.enc_left  = inputs[0][i & BENCH_MASK];
+		sensors.enc_right = inputs[1][i & BENCH_MASK];
+		updateOdometry(&ctx);
+		bench_sink += ctx.heading;
+	}
+}
+
+
+/* = EOF ==================================================================== */
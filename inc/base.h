@@ -37,6 +37,31 @@ typedef unsigned long  ulong  ;
 
 #define abs(val) ((val) > 0 ? (val) : -(val))
 
+/**
+ *  \brief Division rounded towards minus infinity, div must be positive.
+ */
+#define floorDiv(val, div) ((val) >= 0 ? (val) / (div) : -(((div) - 1 - (val)) / (div)))
+
+/**
+ *  \brief Core timer (readCoreTimer()) counts per microsecond.
+ */
+#define CORE_US  20
+
+
+/* ==========================================================================
+ * Library state
+ */
+
+/**
+ *  \brief Storage class of the library global state.
+ *
+ *  Empty on the robot. The host simulation defines it as thread local, so
+ *   each thread runs its own robot.
+ */
+#ifndef MR_TLS
+#define MR_TLS
+#endif
+
 
 /* ========================================================================== */
 #endif /* __BASE_H__ */
@@ -40,6 +40,104 @@
  */
 #define CICLE_T 10
 
+/**
+ * \def Overrun level added by each cycle that ends after its deadline, each
+ *  cycle on time subtracts 1 (see mouse_mode()).
+ *
+ * With the default a cycle can be late once every 9 cycles without the
+ *  level building up.
+ */
+#define OVERRUN_COST     8
+
+/**
+ * \def Overrun levels at which the degraded modes are entered. A mode is
+ *  left when the level drops below half of its threshold, except
+ *  MOUSE_SAFE which is never left.
+ */
+#define OVERRUN_SHED    16
+#define OVERRUN_SLOW    64
+#define OVERRUN_SAFE   256
+
+/**
+ * \def Velocity (in %) of the robot in the MOUSE_SLOW mode.
+ */
+#define OVERRUN_SLOW_VEL 50
+
+/**
+ * \brief Start the hardware watchdog on mouse_init().
+ *
+ * It is cleared on every cycle, so the robot is reset if the control loop
+ *  hangs. Without it the watchdog is only started on the MOUSE_SAFE mode.
+ *
+ * To active simply remove the #undef directive that follows the #define.
+ */
+#define WATCHDOG
+#undef WATCHDOG
+
+
+/* ==========================================================================
+ * Navigation modules
+ */
+
+/**
+ * \brief Build the default instance of a navigation module, and the
+ *  functions without the _r suffix that work on it.
+ *
+ * The instances take a lot of RAM, tens of KB together, and the whole
+ *  library is built into every application. Without its switch a module
+ *  only provides the _r functions, on instances the application owns.
+ *
+ * To active simply remove the #undef directive that follows the #define,
+ *  or define it when building (-DEXPLORE_DEFAULT for instance).
+ */
+#ifndef MAP_DEFAULT
+#define MAP_DEFAULT
+#undef MAP_DEFAULT
+#endif
+
+#ifndef PLAN_DEFAULT
+#define PLAN_DEFAULT
+#undef PLAN_DEFAULT
+#endif
+
+#ifndef EXPLORE_DEFAULT
+#define EXPLORE_DEFAULT
+#undef EXPLORE_DEFAULT
+#endif
+
+#ifndef MCL_DEFAULT
+#define MCL_DEFAULT
+#undef MCL_DEFAULT
+#endif
+
+#ifndef DWA_DEFAULT
+#define DWA_DEFAULT
+#undef DWA_DEFAULT
+#endif
+
+#ifndef TRAIL_DEFAULT
+#define TRAIL_DEFAULT
+#undef TRAIL_DEFAULT
+#endif
+
+#ifndef AVOID_DEFAULT
+#define AVOID_DEFAULT
+#undef AVOID_DEFAULT
+#endif
+
+#ifndef BEACON_DEFAULT
+#define BEACON_DEFAULT
+#undef BEACON_DEFAULT
+#endif
+
+#if defined(EXPLORE_DEFAULT) && !defined(PLAN_DEFAULT)
+#error "EXPLORE_DEFAULT needs PLAN_DEFAULT"
+#endif
+
+#if (defined(PLAN_DEFAULT) || defined(DWA_DEFAULT) || defined(EXPLORE_DEFAULT)) && !defined(MAP_DEFAULT)
+#error "PLAN_DEFAULT, DWA_DEFAULT and EXPLORE_DEFAULT need MAP_DEFAULT"
+#endif
+
 
 /* ==========================================================================
  * Servo calibration values
@@ -51,6 +149,40 @@
 #define SERVO_DEGREE_MIN -80 /// \todo Define SERVO_DEGREE_MIN
 #define SERVO_DEGREE_MAX  80 /// \todo Define SERVO_DEGREE_MAX
 
+/**
+ * \def Servo maximum angular speed in degrees per second.
+ */
+#define SERVO_MAX_SPEED 300          /// \todo Define SERVO_MAX_SPEED
+
+/**
+ * \def Time (in ms) the servo takes to settle after reaching the target.
+ */
+#define SERVO_SETTLE_T   30          /// \todo Define SERVO_SETTLE_T
+
+
+/* ==========================================================================
+ * Obstacle sensors calibration
+ */
+
+/**
+ * \def Obstacle sensors response: the ADC reading at d cm is
+ *  OBST_K / (d + 1).
+ */
+#define OBST_K        6000       /// \todo Define OBST_K
+
+/**
+ * \def Range (in cm) beyond which the readings are within the sensors
+ *  noise, and no obstacle is reported.
+ */
+#define OBST_RANGE      70       /// \todo Define OBST_RANGE
+
+/**
+ * \def Distance (in mm) from the robot center to the sensors, and angle
+ *  (in degrees) between the front sensor and the side ones.
+ */
+#define OBST_OFFSET     60       /// \todo Define OBST_OFFSET
+#define OBST_ANGLE      45       /// \todo Define OBST_ANGLE
+
 
 /* ==========================================================================
  * PI Control
@@ -60,6 +192,69 @@
 #define PI_KI     3
 #define PI_LIMIT 15
 
+/**
+ * \def Per wheel PI gains.
+ *
+ * By default both wheels use the generic gains. Replace them with the
+ *  values printed by calib_tunePI() for the robot being used.
+ */
+#define PI_KP_LEFT  PI_KP
+#define PI_KI_LEFT  PI_KI
+#define PI_KP_RIGHT PI_KP
+#define PI_KI_RIGHT PI_KI
+
+/**
+ * \brief Activate the cross-coupling between the wheels controllers.
+ *
+ * When active, the integrated difference between the distance traveled by
+ *  each wheel and the difference commanded by the set-points is fed to
+ *  both wheels controllers (slowing down the wheel ahead and speeding up
+ *  the one behind). This keeps the commanded curvature while removing the
+ *  heading drift caused by motors or friction asymmetries.
+ *
+ * To active simply remove the #undef directive that follows the #define,
+ *  or define it when building (-DPI_SYNC).
+ */
+#ifndef PI_SYNC
+#define PI_SYNC
+#undef PI_SYNC
+#endif
+
+/**
+ * \def Cross-coupling gain (in % per encoder tick of error).
+ */
+#define PI_SYNC_K      2
+
+/**
+ * \def Limit of the integrated cross-coupling error (in encoder ticks).
+ */
+#define PI_SYNC_LIMIT 10
+
+
+/* ==========================================================================
+ * PI auto-tuning (relay experiment)
+ */
+
+/**
+ * \def Motor command (in %) around which the relay oscillates.
+ */
+#define CALIB_RELAY_BIAS     40
+
+/**
+ * \def Relay amplitude (in %) added to and subtracted from the bias.
+ */
+#define CALIB_RELAY_AMP      20
+
+/**
+ * \def Relay hysteresis in encoder ticks per cycle.
+ */
+#define CALIB_RELAY_HYST      1
+
+/**
+ * \def Number of oscillation periods averaged by the experiment.
+ */
+#define CALIB_RELAY_PERIODS   8
+
 
 /* ==========================================================================
  * Wheels and encoders calibration
@@ -70,11 +265,26 @@
  */
 #define ENC_TPR    1          /// \todo Define ENC_TPR
 
+/**
+ * \def Define the direction of each encoder count.
+ *
+ * Use 1 if the encoder counts up when the wheel moves forward and -1
+ *  otherwise. The encoders values provided by the robot library are always
+ *  positive when moving forward.
+ */
+#define ENC_LEFT_DIR  -1
+#define ENC_RIGHT_DIR  1
+
 /**
  * \def Define the robot wheel circumference in milimeters.
  */
 #define WHEEL_CIRC 1          /// \todo Define WHEEL_CIRC
 
+/**
+ * \def Define the distance between the wheels in milimeters.
+ */
+#define WHEEL_BASE 1          /// \todo Define WHEEL_BASE
+
 
 /* ========================================================================== */
 #endif /* __CONF_H__ */
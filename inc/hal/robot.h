@@ -45,6 +45,16 @@
 #define SOFT_SLOPE
 #undef SOFT_SLOPE
 
+/**
+ *  \brief Profile the interrupt service routines.
+ *
+ *  Stamps the entry and exit of each ISR with the core timer, see
+ *   robot_isrStats(). To active simply remove the #undef directive that
+ *   follows the #define.
+ */
+#define ISR_PROF
+#undef ISR_PROF
+
 
 /* ========================================================================== */
 
@@ -60,6 +70,12 @@
  */
 #define N_LEDS 4
 
+/**
+ * \def Define the largest block of bytes robot_serialSend() can send, the
+ *      size of a DMA transfer.
+ */
+#define SERIAL_BLOCK_MAX 256
+
 
 /* ========================================================================== */
 
@@ -76,8 +92,8 @@ typedef union {
 
 	struct {
 		int obst[3];
-		int battery;
-		int ground;
+		int :32;                 // battery
+		int :32;                 // ground
 		int enc[2];
 	};
 
@@ -91,6 +107,12 @@ typedef struct {
 	int leds;
 } mrActs;
 
+/**
+ * \brief Timer 2 tick flags.
+ *
+ * Each flag is set by the timer 2 interrupt every 10ms, 20ms, ... and stays
+ *  set until it is cleared by the application.
+ */
 typedef union {
 	struct {
 		uint tick10ms:1;
@@ -107,12 +129,32 @@ typedef union {
 } mrClock;
 
 
+/**
+ * \brief Interrupt vectors profiled.
+ */
+#define ISR_T2       0
+#define ISR_ENC_M1   1
+#define ISR_ENC_M2   2
+#define N_ISRS       3
+
+/**
+ * \brief ISR statistics, times in core timer counts (50 ns).
+ */
+typedef struct {
+	uint count;
+	uint maxLatency;             ///< From the event to the entry (timer 2 only)
+	uint maxDuration;            ///< Including the ISRs that preempted it
+	uint preemptions;            ///< Times it preempted another ISR
+	unsigned long long busy;     ///< Total time, excluding preemptions
+} mrIsrStats;
+
+
 /* ========================================================================== */
 
 /// \todo Check volatiles
-volatile extern mrSens  sensors;
-volatile extern mrActs  actuators;
-volatile extern mrClock ticker;
+volatile extern MR_TLS mrSens  sensors;
+volatile extern MR_TLS mrActs  actuators;
+volatile extern MR_TLS mrClock ticker;
 
 
 /* ==========================================================================
@@ -133,6 +175,52 @@ void robot_disableObstSens   ( void );
 void robot_enableGroundSens  ( void );
 void robot_disableGroundSens ( void );
 
+/**
+ * \brief Called repeatedly while waiting for the next tick.
+ *
+ * On the robot this does nothing. On the host simulation it advances the
+ *  simulated time.
+ */
+void robot_idle              ( void );
+
+
+/* ==========================================================================
+ * Timer and watchdog
+ */
+
+/**
+ * \brief Number of timer 2 ticks (10ms) since robot_init(), wraps around.
+ */
+uint robot_ticks             ( void );
+
+/**
+ * \brief Time since the last timer 2 tick, in microseconds.
+ */
+uint robot_tickTime          ( void );
+
+/**
+ * \brief Time to the next timer 2 tick, in microseconds.
+ *
+ * On the host simulation time only moves on ticks, so the whole tick is
+ *  always left.
+ */
+uint robot_tickLeft          ( void );
+
+/**
+ * \brief Start the hardware watchdog.
+ *
+ * Once started the watchdog can't be stopped: the robot is reset if
+ *  robot_wdtClear() isn't called within the period set by the WDTPS
+ *  configuration bits. On the host simulation the program exits instead.
+ */
+void robot_wdtEnable         ( void );
+void robot_wdtClear          ( void );
+
+/**
+ * \brief Check if the last reset was caused by the watchdog.
+ */
+bool robot_wdtReset          ( void );
+
 
 /* ==========================================================================
  * Sensors
@@ -156,5 +244,64 @@ void robot_setLed            ( int ledNr );
 void robot_resetLed          ( int ledNr );
 
 
+/* ==========================================================================
+ * Serial port
+ */
+
+/**
+ * \brief Send a byte if the serial port transmit buffer has room for it.
+ *
+ * Unlike putChar() this never waits. Returns 0 if the byte wasn't sent.
+ */
+uint robot_serialPut         ( uchar c );
+
+/**
+ * \brief Send a block of bytes in the background, using DMA.
+ *
+ * The buffer MUST NOT be changed until robot_serialBusy() returns 0.
+ *  Returns 0 if the block wasn't started because the port is busy, or
+ *  because it's empty or longer than SERIAL_BLOCK_MAX bytes.
+ */
+uint robot_serialSend        ( const uchar* buf, uint len );
+
+/**
+ * \brief Check if a block started by robot_serialSend() is being sent.
+ */
+uint robot_serialBusy        ( void );
+
+
+/* ==========================================================================
+ * Interrupts profiling (only if ISR_PROF is defined)
+ */
+
+/**
+ * \brief Reset the statistics and the load measurement period.
+ */
+void robot_isrReset          ( void );
+
+/**
+ * \brief Statistics of an ISR (ISR_T2, ISR_ENC_M1 or ISR_ENC_M2).
+ */
+void robot_isrStats          ( uint isr, mrIsrStats* stats );
+
+/**
+ * \brief Time spent on ISRs since the reset, in 1/100 %.
+ */
+uint robot_isrLoad           ( void );
+
+/**
+ * \brief Longest time the ISRs were disabled by the library, in core timer
+ *  counts. This adds to the latency of every ISR.
+ */
+uint robot_isrMaxMasked      ( void );
+
+/**
+ * \brief Print the statistics in microseconds and the load.
+ *
+ * This uses printf, it MUST NOT be called inside the control loop.
+ */
+void robot_isrReport         ( void );
+
+
 /* ========================================================================== */
 #endif /* __HAL_ROBOT_H__ */
@@ -0,0 +1,61 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/mlogfmt.h
+ *  \brief This header provides the table of log messages.
+ *
+ *  The logger never sends text, only the index of the message in this
+ *   table and its integer arguments. The host decoder is built from this
+ *   same table, so it MUST be rebuilt after every change.
+ *
+ *  Each entry is MLOG_FMT(id, format). The id is the name used in the code,
+ *   the format is a printf format with up to MLOG_MAX_ARGS integer
+ *   conversions. New messages should be added at the end.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __MLOGFMT_H__
+#define __MLOGFMT_H__
+
+
+/* ==========================================================================
+ * Library messages [must not be changed]
+ */
+
+#define MLOG_FORMATS_LIB \
+	MLOG_FMT(MLOG_DROPPED,    "%d log records dropped") \
+	MLOG_FMT(MLOG_REC,        "%d bytes of recorded inputs") \
+	MLOG_FMT(MLOG_MODE,       "Mode %d, cycle %d us late, level %d")
+
+
+/* ==========================================================================
+ * Application messages [can be changed]
+ */
+
+#define MLOG_FORMATS_APP \
+	MLOG_FMT(LOG_BORN,        "Jerry is born!") \
+	MLOG_FMT(LOG_INIT,        "Initializing machinery ...") \
+	MLOG_FMT(LOG_UP,          "Every systems up!") \
+	MLOG_FMT(LOG_WAIT_START,  "Press start to begin the search!") \
+	MLOG_FMT(LOG_START,       "Let the search begin!") \
+	MLOG_FMT(LOG_GOAL,        "I got the there!") \
+	MLOG_FMT(LOG_SHUTDOWN,    "Shuting down systems...") \
+	MLOG_FMT(LOG_TERMINATED,  "Jerry is terminated!") \
+	MLOG_FMT(LOG_TEST_SENS,   "%3d %3d %3d | %d | %d%d%d%d%d | %3d %3d %5d %5d | %3d | %d%d")
+
+
+/* ========================================================================== */
+
+#define MLOG_FORMATS \
+	MLOG_FORMATS_LIB \
+	MLOG_FORMATS_APP
+
+
+/* ========================================================================== */
+#endif /* __MLOGFMT_H__ */
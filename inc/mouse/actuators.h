@@ -33,6 +33,27 @@
 
 
 #include <base.h>
+#include <mouse/state.h>
+#include <util/rec.h>
+
+
+/* ==========================================================================
+ * Constants
+ */
+
+/**
+ *  \brief Wall to follow.
+ */
+#define ACTUATORS_WALL_OFF     0       ///< Not following a wall
+#define ACTUATORS_WALL_LEFT    1
+#define ACTUATORS_WALL_RIGHT   2
+
+/**
+ *  \brief Wall following states.
+ */
+#define ACTUATORS_WALL_TRACK   0       ///< Holding the distance to the wall
+#define ACTUATORS_WALL_CORNER  1       ///< Turning away from a wall ahead
+#define ACTUATORS_WALL_LOST    2       ///< No wall on the side, turning to it
 
 
 /* ==========================================================================
@@ -48,7 +69,7 @@
  *
  *  *The changes are applied immediately*, without calling actuators_update().
  */
-void actuators_init    ( void );
+static inline void actuators_init    ( void );
 
 /**
  *  \brief Apply the requested changes to the actuators.
@@ -56,7 +77,7 @@ void actuators_init    ( void );
  *  The changes actually applied to the robot are the last ones
  *   requested by a call to a function.
  */
-void actuators_update  ( void );
+static inline void actuators_update  ( void );
 
 /**
  *  \brief Perform the necessary changes in order to stop the robot.
@@ -71,7 +92,7 @@ void actuators_update  ( void );
  *
  *  *The changes are applied immediately*, without calling actuators_update().
  */
-void actuators_stop    ( void );
+static inline void actuators_stop    ( void );
 
 
 /* ==========================================================================
@@ -90,7 +111,7 @@ void actuators_stop    ( void );
  *  \param left Velocity to apply to the left motor.
  *  \param right Velocity to apply to the right motor.
  */
-void actuators_setVel ( int left, int right );
+static inline void actuators_setVel ( int left, int right );
 
 /**
  *  \brief Get the velocity values that will be applied next.
@@ -109,7 +130,35 @@ void actuators_setVel ( int left, int right );
  *  \param right Location where the value for the right motor should be stored
  *               or `NULL` if you're not interested in this value.
  */
-void actuators_getVel ( int* left, int* right );
+static inline void actuators_getVel ( int* left, int* right );
+
+/**
+ *  \brief Set the gains of the motors PI controllers.
+ *
+ *  Each wheel has its own controller. The gains are set to the values
+ *   defined in conf.h (#PI_KP_LEFT, #PI_KI_LEFT, #PI_KP_RIGHT and
+ *   #PI_KI_RIGHT) by actuators_init(), so this must be called after it.
+ *
+ *  The gains are applied immediately.
+ *
+ *  \param kpL Proportional gain of the left motor.
+ *  \param kiL Integral gain of the left motor.
+ *  \param kpR Proportional gain of the right motor.
+ *  \param kiR Integral gain of the right motor.
+ */
+static inline void actuators_setPIGains ( int kpL, int kiL, int kpR, int kiR );
+
+/**
+ *  \brief Get the gains of the motors PI controllers.
+ *
+ *  Any of the arguments can be `NULL` if you're not interested in the value.
+ *
+ *  \param kpL Location where the left proportional gain should be stored.
+ *  \param kiL Location where the left integral gain should be stored.
+ *  \param kpR Location where the right proportional gain should be stored.
+ *  \param kiR Location where the right integral gain should be stored.
+ */
+static inline void actuators_getPIGains ( int* kpL, int* kiL, int* kpR, int* kiR );
 
 
 /* ==========================================================================
@@ -132,7 +181,7 @@ void actuators_getVel ( int* left, int* right );
  *
  *  \param degree The next position to apply to the beacon sensor.
  */
-void actuators_setBSensPos ( int degree );
+static inline void actuators_setBeaconSens    ( int degree );
 
 /**
  *  \brief Rotate the beacon sensor relatively to the current position.
@@ -141,12 +190,12 @@ void actuators_setBSensPos ( int degree );
  *   the sensor should be rotated from it's current position. The changes
  *   are only applied in the next call to actuators_update().
  *
- *  Check actuators_setBSensPos() for more details.
+ *  Check actuators_setBeaconSens() for more details.
  *
  *  \param degree The value in degrees the sensor should
  *                be rotated from it's current position.
  */
-void actuators_rotateBSens ( int degree );
+static inline void actuators_rotateBeaconSens ( int degree );
 
 /**
  *  \brief Get the beacon sensor position that will be applied next.
@@ -156,13 +205,98 @@ void actuators_rotateBSens ( int degree );
  *   was called at this moment.
  *
  *  Notice the values returned value can be different from the ones provided
- *   with the actuators_setBSensPos() or actuators_rotateBSens()
+ *   with the actuators_setBeaconSens() or actuators_rotateBeaconSens()
  *   functions, because of constraints of the robot (position limits) or rounding
  *   of the values.
  *
  *  \param degree Location where the value of the position should be stored.
  */
-void actuators_getBSensPos ( int* degree );
+static inline void actuators_getBeaconSens    ( int* degree );
+
+/**
+ *  \brief Enable or disable the beacon sweep mode.
+ *
+ *  In sweep mode the beacon sensor is continuously rotated from one side
+ *   to the other by actuators_update(), and the beam edges seen in each pass
+ *   are used to compute the beacon direction, the beam width and a
+ *   confidence value (see sensors_beaconDir(), sensors_beaconWidth() and
+ *   sensors_beaconConf()).
+ *
+ *  The sweep starts with the full servo range. Once the confidence is high
+ *   enough it is narrowed around the last known direction, increasing the
+ *   update rate. When the beacon is lost it goes back to the full range.
+ *
+ *  While in sweep mode the positions requested with
+ *   actuators_setBeaconSens() and actuators_rotateBeaconSens() are ignored.
+ *
+ *  \param enable True to start sweeping and false to stop.
+ */
+static inline void actuators_beaconSweep      ( bool enable );
+
+/**
+ *  \brief Enable or disable the beacon tracking mode.
+ *
+ *  In tracking mode actuators_update() keeps the beacon sensor pointed at
+ *   the beacon while the robot moves. The robot rotation (measured by
+ *   odometry) is compensated every cycle and the sensor dithers slightly
+ *   around the beacon direction to keep it centered. If the beacon is lost
+ *   the sweep mode is used until it is found again.
+ *
+ *  Tracking starts from the current sweep result, if the sweep is locked,
+ *   or from the current beacon sensor position otherwise. So it should be
+ *   enabled once the beacon is found.
+ *
+ *  The results are provided by sensors_beaconDir(),
+ *   sensors_beaconBearing() (world frame) and sensors_beaconConf().
+ *
+ *  While in tracking mode the positions requested with
+ *   actuators_setBeaconSens() and actuators_rotateBeaconSens() are ignored.
+ *   Enabling the sweep mode disables tracking.
+ *
+ *  \param enable True to start tracking and false to stop.
+ */
+static inline void actuators_beaconTrack      ( bool enable );
+
+
+/* ==========================================================================
+ * Wall following
+ */
+
+/**
+ *  \brief Follow a wall on one side of the robot.
+ *
+ *  While following, actuators_update() sets the motors velocities itself
+ *   every cycle: a PD controller holds the distance to the wall measured
+ *   by the obstacle sensor on that side, linearized and projected on the
+ *   perpendicular to the robot. The front obstacle sensor looks ahead for
+ *   inside corners, where the robot slows down and turns away from the
+ *   wall (spinning in place when it gets too close). When the wall ends
+ *   the robot turns towards its side to go round it.
+ *
+ *  The sensors are read directly, so this keeps working at the loop rate
+ *   even if sensors_update() isn't called on every cycle.
+ *
+ *  While following a wall the velocities requested with actuators_setVel()
+ *   are ignored.
+ *
+ *  \param side ACTUATORS_WALL_LEFT or ACTUATORS_WALL_RIGHT to follow a wall,
+ *              or ACTUATORS_WALL_OFF to stop (the robot is stopped).
+ *  \param dist Distance (in cm) to keep between the robot center and the
+ *              wall.
+ *  \param vel  Velocity (in cm/s) along the wall.
+ */
+static inline void actuators_wallFollow ( uint side, int dist, int vel );
+
+/**
+ *  \brief Get the wall following state on the last update.
+ *
+ *  \param dist Location where the distance (in mm) to the wall should be
+ *              stored, or `NULL`. It's -1 when there's no wall on the side.
+ *
+ *  \returns One of ACTUATORS_WALL_TRACK, ACTUATORS_WALL_CORNER and
+ *           ACTUATORS_WALL_LOST, meaningless when not following a wall.
+ */
+static inline uint actuators_wallState  ( int* dist );
 
 
 /* ==========================================================================
@@ -199,5 +333,183 @@ bool actuators_setLed  ( uint ledN, bool state );
 void actuators_setLeds ( uint bitmap );
 
 
+/* ==========================================================================
+ * Reentrant interface
+ */
+
+/**
+ *  \brief State of one instance of the module.
+ *
+ *  The fields are internal to the module, use the functions to access them.
+ */
+typedef struct {
+	stateCtx* state;
+
+	int  spLeft;                 // Motors
+	int  spRight;
+	int  velLeft;
+	int  velRight;
+
+	int  kpLeft;                 // Motors PI
+	int  kiLeft;
+	int  kpRight;
+	int  kiRight;
+	int  piIntLeft;
+	int  piIntRight;
+	int  syncErr;
+
+	int  servoDegree;            // Beacon servo
+	int  newServoDegree;
+	int  servoPos;
+	int  servoEstimate;          // Estimated true position (millidegrees)
+	int  servoSettle;            // Cycles since the target was reached
+
+	bool sweepOn;                // Beacon sweep (angles in millidegrees)
+	int  sweepDir;               // 1 rotating right, -1 rotating left
+	int  sweepLeft;
+	int  sweepRight;
+	bool sweepBeacon;            // Beacon sensor state in the last cycle
+	int  sweepAngle;             // Servo angle in the last cycle
+	bool sweepInBeam;            // A rising edge was seen in this pass
+	int  sweepRise;
+	bool sweepSeen;              // The beam was crossed in this pass
+	bool sweepLast;              // There's a previous pass result
+	int  sweepLastC;             // Center seen in the previous pass
+	int  sweepLastW;             // Width seen in the previous pass
+	int  sweepCenter;
+	int  sweepWidth;
+	int  sweepConf;
+
+	bool trackOn;                // Beacon tracking (angles in millidegrees)
+	int  trackAngle;             // Beacon direction relative to the robot
+	int  trackSide;              // Dithering side being visited
+	int  trackHits;              // Sides where the beacon was seen
+	int  trackMiss;
+	int  trackConf;
+
+	uint wallSide;               // Wall following (distances in mm)
+	int  wallSP;
+	int  wallVel;                // cm/s
+	uint wallState;
+	int  wallDist;               // -1 without wall
+	int  wallRate;               // Its derivative (in mm/s), filtered
+	int  wallLost;               // Distance traveled without wall
+} actuatorsCtx;
+
+/**
+ *  \brief Initialize an instance of the module.
+ *
+ *  The functions without the _r suffix operate on actuatorsDefault,
+ *   bound to state_default() by actuators_init(). The LEDs functions only
+ *   drive the robot directly and have no _r variant.
+ *
+ *  \param ctx   The instance.
+ *  \param state The state exchange area shared with the sensors instance
+ *         reading the same robot.
+ */
+void actuators_init_r   ( actuatorsCtx* ctx, stateCtx* state );
+
+void actuators_update_r ( actuatorsCtx* ctx );
+void actuators_stop_r   ( actuatorsCtx* ctx );
+
+void actuators_setVel_r     ( actuatorsCtx* ctx, int left, int right );
+void actuators_getVel_r     ( const actuatorsCtx* ctx, int* left, int* right );
+void actuators_setPIGains_r ( actuatorsCtx* ctx, int kpL, int kiL, int kpR, int kiR );
+void actuators_getPIGains_r ( const actuatorsCtx* ctx, int* kpL, int* kiL, int* kpR, int* kiR );
+
+void actuators_setBeaconSens_r    ( actuatorsCtx* ctx, int degree );
+void actuators_rotateBeaconSens_r ( actuatorsCtx* ctx, int degree );
+void actuators_getBeaconSens_r    ( const actuatorsCtx* ctx, int* degree );
+void actuators_beaconSweep_r      ( actuatorsCtx* ctx, bool enable );
+void actuators_beaconTrack_r      ( actuatorsCtx* ctx, bool enable );
+
+void actuators_wallFollow_r ( actuatorsCtx* ctx, uint side, int dist, int vel );
+uint actuators_wallState_r  ( const actuatorsCtx* ctx, int* dist );
+
+
+/* ==========================================================================
+ * Non reentrant interface
+ *
+ * Defined here so that they are inlined where they are called, the only
+ *  call left is to the function with the _r suffix.
+ */
+
+/**
+ *  \brief Instance used by the functions without the _r suffix.
+ */
+extern MR_TLS actuatorsCtx actuatorsDefault;
+
+static inline void actuators_init ( void )
+{
+	actuators_init_r(&actuatorsDefault, state_default());
+}
+
+static inline void actuators_update ( void )
+{
+	actuators_update_r(&actuatorsDefault);
+}
+
+static inline void actuators_stop ( void )
+{
+	actuators_stop_r(&actuatorsDefault);
+}
+
+static inline void actuators_setVel ( int left, int right )
+{
+	rec_vel(&left, &right);
+	actuators_setVel_r(&actuatorsDefault, left, right);
+}
+
+static inline void actuators_getVel ( int* left, int* right )
+{
+	actuators_getVel_r(&actuatorsDefault, left, right);
+}
+
+static inline void actuators_setPIGains ( int kpL, int kiL, int kpR, int kiR )
+{
+	actuators_setPIGains_r(&actuatorsDefault, kpL, kiL, kpR, kiR);
+}
+
+static inline void actuators_getPIGains ( int* kpL, int* kiL, int* kpR, int* kiR )
+{
+	actuators_getPIGains_r(&actuatorsDefault, kpL, kiL, kpR, kiR);
+}
+
+static inline void actuators_setBeaconSens ( int degree )
+{
+	actuators_setBeaconSens_r(&actuatorsDefault, degree);
+}
+
+static inline void actuators_rotateBeaconSens ( int degree )
+{
+	actuators_rotateBeaconSens_r(&actuatorsDefault, degree);
+}
+
+static inline void actuators_beaconSweep ( bool enable )
+{
+	actuators_beaconSweep_r(&actuatorsDefault, enable);
+}
+
+static inline void actuators_beaconTrack ( bool enable )
+{
+	actuators_beaconTrack_r(&actuatorsDefault, enable);
+}
+
+static inline void actuators_getBeaconSens ( int* degree )
+{
+	actuators_getBeaconSens_r(&actuatorsDefault, degree);
+}
+
+static inline void actuators_wallFollow ( uint side, int dist, int vel )
+{
+	actuators_wallFollow_r(&actuatorsDefault, side, dist, vel);
+}
+
+static inline uint actuators_wallState ( int* dist )
+{
+	return actuators_wallState_r(&actuatorsDefault, dist);
+}
+
+
 /* ========================================================================== */
 #endif /* __MOUSE_ACTUATORS_H__ */
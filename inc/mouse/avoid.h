@@ -0,0 +1,226 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/mouse/avoid.h
+ *  \brief Reactive obstacle avoidance.
+ *
+ *  A Vector Field Histogram: the obstacles seen by the three obstacle
+ *   sensors, on this cycle and on the last few places the robot went by,
+ *   are added to a polar histogram around the robot, AVOID_SECTORS sectors
+ *   wide. Each obstacle counts more the closer it is, and is widened by
+ *   the angle the robot (AVOID_RADIUS) takes at its distance, so any
+ *   sector that isn't blocked can be taken.
+ *
+ *  The direction taken is, among the openings between blocked sectors,
+ *   the closest to the goal, preferring the current heading and the last
+ *   direction taken so the robot doesn't hesitate between two openings.
+ *   Wide openings are taken AVOID_WIDE / 2 sectors away from their edges.
+ *   The robot turns towards it, slowing down as the obstacles ahead get
+ *   closer, and spins in place when it's more than AVOID_SPIN degrees
+ *   away or when every direction is blocked.
+ *
+ *  \code
+ *  mouse_waitStep10ms();
+ *  sensors_update();
+ *  avoid_update(goal);
+ *  actuators_update();
+ *  \endcode
+ *
+ *  All the math is integer, an update costs at most 3 * AVOID_HISTORY
+ *   obstacles of up to AVOID_SECTORS / 2 sectors each.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __MOUSE_AVOID_H__
+#define __MOUSE_AVOID_H__
+
+
+#include <base.h>
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Number of sectors of the histogram (360 must be a multiple).
+ */
+#define AVOID_SECTORS   36
+
+/**
+ *  \brief Number of places where the readings are kept, and distance (in
+ *   mm) or rotation (in degrees) between them.
+ *
+ *  The readings of the current place are replaced on every update.
+ */
+#define AVOID_HISTORY    8
+#define AVOID_STEP      40
+#define AVOID_STEP_DEG  15
+
+/**
+ *  \brief Distance (in mm) from the robot center beyond which obstacles are
+ *   ignored, and robot radius plus clearance (in mm).
+ */
+#define AVOID_RANGE    500
+#define AVOID_RADIUS   120
+
+/**
+ *  \brief Density above which a sector is blocked, and below which it's
+ *   free again.
+ *
+ *  An obstacle at distance d adds AVOID_RANGE - d to the density.
+ */
+#define AVOID_HIGH     300
+#define AVOID_LOW      200
+
+/**
+ *  \brief Sectors of an opening wide enough to keep away from its edges.
+ */
+#define AVOID_WIDE       8
+
+/**
+ *  \brief Direction (in degrees from the heading) beyond which the robot
+ *   spins in place.
+ */
+#define AVOID_SPIN      60
+
+/**
+ *  \brief Default maximum velocity (in cm/s).
+ */
+#define AVOID_VEL       40
+
+
+/* ==========================================================================
+ * Constants
+ */
+
+/**
+ *  \brief Avoidance states.
+ */
+#define AVOID_GOAL       0       ///< Going to the goal
+#define AVOID_STEER      1       ///< Going round obstacles
+#define AVOID_BLOCKED    2       ///< Every direction is blocked
+
+#define AVOID_SECTOR     (360 / AVOID_SECTORS)
+#define AVOID_POINTS     (3 * AVOID_HISTORY)
+
+
+/* ==========================================================================
+ * Management
+ */
+
+/**
+ *  \brief Initialize the avoidance module, forgetting the readings kept.
+ *
+ *  Like the other functions without the _r suffix, only built with
+ *   AVOID_DEFAULT (see conf.h).
+ */
+void avoid_init   ( void );
+
+/**
+ *  \brief Set the maximum velocity (in cm/s).
+ */
+void avoid_setVel ( int vel );
+
+/**
+ *  \brief Steer towards a goal avoiding the obstacles.
+ *
+ *  The pose is the one of sensors_position() and sensors_compass(), so this
+ *   MUST be called after sensors_update(). The wheels velocities are set
+ *   with actuators_setVel().
+ *
+ *  \param goal Direction of the goal, anticlockwise like sensors_compass().
+ *
+ *  \returns The avoidance state.
+ */
+uint avoid_update ( int goal );
+
+
+/* ==========================================================================
+ * Queries
+ */
+
+/**
+ *  \brief Direction taken on the last update, anticlockwise like
+ *   sensors_compass().
+ */
+int  avoid_direction ( void );
+
+/**
+ *  \brief Obstacles density of the sector containing a direction, relative
+ *   to the heading on the last update (positive to the left).
+ */
+uint avoid_density   ( int degree );
+
+/**
+ *  \brief Is the sector containing a direction, relative to the heading on
+ *   the last update, blocked.
+ */
+bool avoid_blocked   ( int degree );
+
+
+/* ==========================================================================
+ * Reentrant interface
+ */
+
+/**
+ *  \brief State of one instance of the module.
+ *
+ *  The fields are internal to the module, use the functions to access them.
+ */
+typedef struct {
+	int  ptX[AVOID_POINTS];      // Obstacles seen (in mm), 3 per place
+	int  ptY[AVOID_POINTS];
+	bool ptValid[AVOID_POINTS];
+	uint place;                  // Place being updated
+	int  placeX;                 // Pose where it started
+	int  placeY;
+	int  placeDeg;
+
+	ushort density[AVOID_SECTORS];
+	uchar  blocked[AVOID_SECTORS];
+
+	uint state;
+	int  direction;              // Direction taken (anticlockwise)
+	int  vel;
+	int  left;                   // Wheels velocities
+	int  right;
+} avoidCtx;
+
+/**
+ *  \brief Same as avoid_init() for the given instance.
+ */
+void avoid_init_r   ( avoidCtx* ctx );
+
+void avoid_setVel_r ( avoidCtx* ctx, int vel );
+
+/**
+ *  \brief Same as avoid_update() for the given instance and robot pose.
+ *
+ *  The obstacle sensors are read directly from the robot, the wheels
+ *   velocities are provided by avoid_getVel_r().
+ *
+ *  \param x, y   The robot position in mm.
+ *  \param degree The robot heading, anticlockwise.
+ *  \param goal   Direction of the goal, anticlockwise.
+ */
+uint avoid_update_r ( avoidCtx* ctx, int x, int y, int degree, int goal );
+
+/**
+ *  \brief Wheels velocities (in cm/s) computed by the last update.
+ */
+void avoid_getVel_r ( const avoidCtx* ctx, int* left, int* right );
+
+int  avoid_direction_r ( const avoidCtx* ctx );
+uint avoid_density_r   ( const avoidCtx* ctx, int degree );
+bool avoid_blocked_r   ( const avoidCtx* ctx, int degree );
+
+
+/* ========================================================================== */
+#endif /* __MOUSE_AVOID_H__ */
@@ -0,0 +1,186 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/mouse/beacon.h
+ *  \brief Beacon position from its bearings across several poses.
+ *
+ *  A bearing of the beacon only gives the line it's on. The bearings taken
+ *   from the positions the robot goes through are kept, and the beacon
+ *   position estimated as the point closest to all their lines, in the
+ *   least squares sense. A new bearing is only kept once the robot moved
+ *   BEACON_BASE mm from where the last one was taken, so the lines aren't
+ *   all the same, and the oldest are dropped beyond BEACON_BEARINGS.
+ *
+ *  The error of the estimate is given as its covariance, from the spread
+ *   of the lines around it (but no less than BEACON_NOISE degrees at its
+ *   distance) and from the angles between them: lines that are almost
+ *   parallel, as when the robot drives straight at the beacon, leave it
+ *   free along them. Its largest standard deviation tells whether the
+ *   estimate is good enough to drive straight to it.
+ *
+ *  \code
+ *  mouse_waitStep10ms();
+ *  sensors_update();
+ *  beacon_update();
+ *
+ *  if (beacon_error(NULL, NULL, NULL) < 100) {
+ *      beacon_position(&x, &y);
+ *  }
+ *  \endcode
+ *
+ *  The positions are the ones of sensors_position().
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __MOUSE_BEACON_H__
+#define __MOUSE_BEACON_H__
+
+
+#include <base.h>
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Number of bearings kept, and distance (in mm) the robot must
+ *   move before another one is kept.
+ */
+#define BEACON_BEARINGS   32
+#define BEACON_BASE      100
+
+/**
+ *  \brief Error (in degrees) of a bearing, the least the error of the
+ *   estimate is computed with.
+ */
+#define BEACON_NOISE       2
+
+/**
+ *  \brief Bearings needed for an estimate.
+ */
+#define BEACON_MIN         3
+
+/**
+ *  \brief Least confidence (see sensors_beaconConf()) of the bearings kept,
+ *   below it the sweep result can be stale while the robot turns.
+ */
+#define BEACON_CONF       50
+
+
+/* ==========================================================================
+ * Constants
+ */
+
+/**
+ *  \brief Error (in mm) when there's no estimate.
+ */
+#define BEACON_NO_ERROR  0x7FFFFFFF
+
+
+/* ==========================================================================
+ * Management
+ */
+
+/**
+ *  \brief Initialize the triangulation module, without bearings.
+ *
+ *  Like the other functions without the _r suffix, only built with
+ *   BEACON_DEFAULT (see conf.h).
+ */
+void beacon_init   ( void );
+
+/**
+ *  \brief Keep the current bearing of the beacon, if it's seen and the
+ *   robot moved enough, and estimate its position again.
+ *
+ *  The bearing is the one of sensors_beaconBearing(), on a valid reading
+ *   with at least BEACON_CONF confidence, so this MUST be called after
+ *   sensors_update().
+ *
+ *  \returns true if a bearing was kept.
+ */
+bool beacon_update ( void );
+
+
+/* ==========================================================================
+ * Queries
+ */
+
+/**
+ *  \brief Estimate of the beacon position (in mm).
+ *
+ *  \returns false if there's no estimate, from too few bearings, almost
+ *   parallel or behind the robot.
+ */
+bool beacon_position ( int* x, int* y );
+
+/**
+ *  \brief Covariance of the estimate (in mm^2).
+ *
+ *  Any of the arguments can be `NULL` if you're not interested in the value.
+ *
+ *  \returns The largest standard deviation (in mm), along the major axis of
+ *   the error ellipse, or BEACON_NO_ERROR if there's no estimate.
+ */
+uint beacon_error    ( int* xx, int* xy, int* yy );
+
+/**
+ *  \brief Number of bearings kept.
+ */
+uint beacon_bearings ( void );
+
+
+/* ==========================================================================
+ * Reentrant interface
+ */
+
+/**
+ *  \brief State of one instance of the module.
+ *
+ *  The fields are internal to the module, use the functions to access them.
+ */
+typedef struct {
+	int  bX[BEACON_BEARINGS];    // Where each bearing was taken (in mm)
+	int  bY[BEACON_BEARINGS];
+	int  bA[BEACON_BEARINGS];    // Bearing (in degrees)
+	uint n;
+	uint next;                   // Slot of the next bearing
+
+	bool valid;                  // Estimate
+	int  estX;
+	int  estY;
+	int  covXX;
+	int  covXY;
+	int  covYY;
+	uint error;
+} beaconCtx;
+
+/**
+ *  \brief Initialize an instance of the module.
+ */
+void beacon_init_r   ( beaconCtx* ctx );
+
+/**
+ *  \brief Same as beacon_update() for the given instance, robot position
+ *   and beacon reading.
+ *
+ *  \param x, y    The robot position in mm.
+ *  \param seen    Is the beacon seen, on a good enough reading.
+ *  \param bearing Its world bearing (in degrees), when seen.
+ */
+bool beacon_update_r ( beaconCtx* ctx, int x, int y, bool seen, int bearing );
+
+bool beacon_position_r ( const beaconCtx* ctx, int* x, int* y );
+uint beacon_error_r    ( const beaconCtx* ctx, int* xx, int* xy, int* yy );
+uint beacon_bearings_r ( const beaconCtx* ctx );
+
+
+/* ========================================================================== */
+#endif /* __MOUSE_BEACON_H__ */
@@ -0,0 +1,164 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/mouse/calib.h
+ *  \brief Calibration utilities.
+ *
+ *  This module provides routines that help finding the robot dependent
+ *   values of conf.h.
+ *
+ *  The motors PI gains are found with an Åström–Hägglund relay experiment:
+ *   each wheel is driven by a relay around an operating point until it
+ *   oscillates steadily. The ultimate gain (Ku) and the ultimate period (Tu)
+ *   are estimated from the amplitude and period of the oscillation and the
+ *   PI gains are computed with the Ziegler–Nichols rules:
+ *   - Kp = 0.45 Ku
+ *   - Ki = 0.54 Ku / Tu (Tu in cycles)
+ *
+ *  The relay experiment itself (calib_relayInit(), calib_relayStep(), ...)
+ *   doesn't access the hardware, it only processes the measured encoder
+ *   ticks and produces the motor command to apply. This way it can be run
+ *   against the robot (calib_tunePI()) or against a motor model.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __MOUSE_CALIB_H__
+#define __MOUSE_CALIB_H__
+
+
+#include <base.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Relay experiment phases.
+ */
+typedef enum {
+	CALIB_RELAY_SETTLE,  ///< Running at the bias command to find the speed.
+	CALIB_RELAY_RUN,     ///< Relay is running (waiting for steady state).
+	CALIB_RELAY_MEASURE, ///< Relay is running and being measured.
+	CALIB_RELAY_DONE,    ///< Experiment finished successfully.
+	CALIB_RELAY_FAILED   ///< The system didn't oscillate.
+} calibRelayPhase;
+
+/**
+ *  \brief State of a relay experiment on one wheel.
+ *
+ *  Treat it as opaque, use the calib_relay*() functions.
+ */
+typedef struct {
+	calibRelayPhase phase;
+
+	int  bias;       ///< Bias command (%).
+	int  amp;        ///< Relay amplitude (%).
+	int  sp;         ///< Operating point (ticks per cycle).
+
+	int  cycles;     ///< Cycles in the current phase.
+	int  acc;        ///< Accumulated speed during the settle phase.
+	bool high;       ///< Relay output state.
+
+	int  periods;    ///< Complete periods seen in the current phase.
+	int  periodLen;  ///< Cycles since the last rising switch.
+	int  max;        ///< Maximum speed in the current period.
+	int  min;        ///< Minimum speed in the current period.
+
+	int  sumTu;      ///< Sum of the measured periods (cycles).
+	int  sumPP;      ///< Sum of the measured peak to peak amplitudes.
+} calibRelay;
+
+
+/* ==========================================================================
+ * Relay experiment
+ */
+
+/**
+ *  \brief Prepare a relay experiment.
+ *
+ *  \param relay The experiment state.
+ *  \param bias  Command (in %) around which the relay switches.
+ *  \param amp   Relay amplitude (in %).
+ */
+void calib_relayInit  ( calibRelay* relay, int bias, int amp );
+
+/**
+ *  \brief Run one cycle of the experiment.
+ *
+ *  This function should be called once per cycle with the encoder ticks
+ *   read in that cycle. The returned value is the motor command to apply
+ *   in the next cycle.
+ *
+ *  \param relay The experiment state.
+ *  \param ticks Encoder ticks measured in the last cycle.
+ *
+ *  \returns The motor command (in %) to apply.
+ */
+int  calib_relayStep  ( calibRelay* relay, int ticks );
+
+/**
+ *  \brief Indicate whether the experiment is finished.
+ *
+ *  \returns True if the experiment is finished (either successfully or not).
+ */
+bool calib_relayDone  ( const calibRelay* relay );
+
+/**
+ *  \brief Get the ultimate gain and period estimated by the experiment.
+ *
+ *  \param relay The experiment state.
+ *  \param ku100 Location where the ultimate gain (x100, in % per tick)
+ *               should be stored, or `NULL`.
+ *  \param tu10  Location where the ultimate period (x10, in cycles)
+ *               should be stored, or `NULL`.
+ *
+ *  \returns True if the experiment finished successfully and false otherwise.
+ */
+bool calib_relayUltimate ( const calibRelay* relay, int* ku100, int* tu10 );
+
+/**
+ *  \brief Get the PI gains computed from the experiment.
+ *
+ *  The gains are in the units used by the motors PI controller and are
+ *   never smaller than 1.
+ *
+ *  \param relay The experiment state.
+ *  \param kp Location where the proportional gain should be stored.
+ *  \param ki Location where the integral gain should be stored.
+ *
+ *  \returns True if the experiment finished successfully and false otherwise.
+ */
+bool calib_relayGains ( const calibRelay* relay, int* kp, int* ki );
+
+
+/* ==========================================================================
+ * On robot calibration
+ */
+
+/**
+ *  \brief Tune the PI gains of both motors.
+ *
+ *  Runs the relay experiment on both wheels at the same time. The robot
+ *   moves forward during the experiment (usually less than 5 seconds), so
+ *   place it somewhere free or lift the wheels from the ground.
+ *
+ *  When successful, the gains are applied with actuators_setPIGains() and
+ *   printed in the conf.h format so they can be made permanent. The
+ *   actuators module must be initialized before, otherwise the gains are
+ *   reset by actuators_init().
+ *
+ *  This function is blocking and uses the robot directly, so the
+ *   sensors and actuators modules must not be updated while it runs.
+ *
+ *  \returns True if both wheels were tuned and false otherwise.
+ */
+bool calib_tunePI ( void );
+
+
+/* ========================================================================== */
+#endif /* __MOUSE_CALIB_H__ */
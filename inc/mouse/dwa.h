@@ -0,0 +1,223 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/mouse/dwa.h
+ *  \brief Dynamic window local planner.
+ *
+ *  On each cycle the wheels velocities that can be reached within the
+ *   acceleration limits (DWA_ACC) are sampled. Each pair is followed for
+ *   DWA_HORIZON ms, at constant velocities, against the occupied cells of
+ *   the map around the robot (see mouse/map.h) and the obstacles seen on
+ *   this cycle. Pairs that would hit an obstacle before being able to stop
+ *   are discarded. The others are scored by the direction to the goal half
+ *   way to it (or at the end of the horizon), the clearance to the
+ *   obstacles along the way and the speed, and the best one is given to
+ *   the wheels controllers.
+ *
+ *  Only local obstacles are known, so the goal should be a point a short
+ *   way ahead on a path (see mouse/plan.h): going straight to a far goal
+ *   gets the robot stuck in front of the walls across the way.
+ *
+ *  \code
+ *  mouse_waitStep10ms();
+ *  sensors_update();
+ *  map_update();
+ *  dwa_update(x, y);
+ *  actuators_update();
+ *  \endcode
+ *
+ *  The time taken is measured on each update, and the number of samples
+ *   is adapted so the next update takes about DWA_BUDGET_US, between
+ *   DWA_SAMPLES_MIN and DWA_SAMPLES_MAX. An update that still takes longer
+ *   stops sampling, after DWA_SAMPLES_MIN samples, when the budget is over.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __MOUSE_DWA_H__
+#define __MOUSE_DWA_H__
+
+
+#include <base.h>
+#include <mouse/map.h>
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Default maximum velocity of each wheel (in cm/s), and their
+ *   acceleration (in cm/s^2).
+ */
+#define DWA_VEL           50
+#define DWA_ACC          150
+
+/**
+ *  \brief Time (in ms) each pair of velocities is followed, and number of
+ *   steps in which it's checked against the obstacles.
+ *
+ *  The robot moves at most DWA_VEL * DWA_HORIZON / DWA_STEPS between two
+ *   checks, that should be less than the cells of the map.
+ */
+#define DWA_HORIZON     1000
+#define DWA_STEPS         20
+
+/**
+ *  \brief Robot radius plus clearance (in mm), and clearance beyond which
+ *   it no longer adds to the score.
+ */
+#define DWA_RADIUS       120
+#define DWA_CLEAR        300
+
+/**
+ *  \brief Distance (in mm) around the robot where occupied cells are looked
+ *   for, and maximum number of them, the closest ones.
+ */
+#define DWA_RANGE        600
+#define DWA_OBST          64
+
+/**
+ *  \brief Weights of the direction to the goal, the clearance and the
+ *   speed.
+ */
+#define DWA_K_HEADING      4
+#define DWA_K_CLEAR        2
+#define DWA_K_VEL          2
+
+/**
+ *  \brief Distance (in mm) to the goal at which it's reached.
+ */
+#define DWA_GOAL_DIST     50
+
+/**
+ *  \brief Time (in microseconds) spent by dwa_update() on each call, and
+ *   limits of the number of samples.
+ */
+#define DWA_BUDGET_US   1500
+#define DWA_SAMPLES_MIN    9
+#define DWA_SAMPLES_MAX  100
+
+
+/* ==========================================================================
+ * Constants
+ */
+
+/**
+ *  \brief Planner states.
+ */
+#define DWA_GO            0       ///< Going to the goal
+#define DWA_BLOCKED       1       ///< No safe velocities, braking
+#define DWA_ARRIVED       2       ///< On the goal, stopped or stopping
+
+#define DWA_REACH         (DWA_RADIUS + DWA_CLEAR)
+
+
+/* ==========================================================================
+ * Management
+ */
+
+/**
+ *  \brief Initialize the planner module, on the map of map_init().
+ *
+ *  Like the other functions without the _r suffix, only built with
+ *   DWA_DEFAULT (see conf.h).
+ */
+void dwa_init   ( void );
+
+/**
+ *  \brief Set the maximum velocity of each wheel (in cm/s).
+ */
+void dwa_setVel ( int vel );
+
+/**
+ *  \brief Choose the velocities towards a goal and set them with
+ *   actuators_setVel().
+ *
+ *  The pose is the one of sensors_position() and sensors_compass(), and
+ *   the obstacles the ones of the map, so this MUST be called after
+ *   sensors_update() and map_update().
+ *
+ *  \param x, y The goal, in mm in the frame of sensors_position().
+ *
+ *  \returns The planner state.
+ */
+uint dwa_update ( int x, int y );
+
+
+/* ==========================================================================
+ * Queries
+ */
+
+/**
+ *  \brief Samples scored on the last update, and the number the next one
+ *   will try.
+ */
+void dwa_samples ( uint* last, uint* next );
+
+/**
+ *  \brief Velocity (in mm/s) and angular velocity (in degrees/s,
+ *   anticlockwise) chosen on the last update.
+ */
+void dwa_getVel  ( int* vel, int* angVel );
+
+
+/* ==========================================================================
+ * Reentrant interface
+ */
+
+/**
+ *  \brief State of one instance of the module.
+ *
+ *  The fields are internal to the module, use the functions to access them.
+ */
+typedef struct {
+	const mapCtx* map;
+
+	int  velMax;                 // mm/s
+	int  left;                   // Wheels velocities chosen (in mm/s)
+	int  right;
+	uint state;
+
+	uint samples;                // Samples to try on the next update
+	uint scored;                 // Samples scored on the last update
+
+	int  obstX[DWA_OBST];        // Occupied cells, relative to the robot
+	int  obstY[DWA_OBST];
+	int  obstD2[DWA_OBST];       // Their distance, squared
+	uint nObst;
+} dwaCtx;
+
+/**
+ *  \brief Initialize an instance of the module, working on the given map.
+ */
+void dwa_init_r   ( dwaCtx* ctx, const mapCtx* map );
+
+void dwa_setVel_r ( dwaCtx* ctx, int vel );
+
+/**
+ *  \brief Same as dwa_update() for the given instance, robot pose and time
+ *   budget. The velocities are provided by dwa_getWheels_r().
+ *
+ *  \param x, y   The robot position in mm.
+ *  \param degree The robot heading, anticlockwise.
+ *  \param goalX, goalY The goal in mm.
+ */
+uint dwa_update_r ( dwaCtx* ctx, int x, int y, int degree, int goalX, int goalY, uint budgetUs );
+
+/**
+ *  \brief Wheels velocities (in cm/s) chosen by the last update.
+ */
+void dwa_getWheels_r ( const dwaCtx* ctx, int* left, int* right );
+
+void dwa_samples_r ( const dwaCtx* ctx, uint* last, uint* next );
+void dwa_getVel_r  ( const dwaCtx* ctx, int* vel, int* angVel );
+
+
+/* ========================================================================== */
+#endif /* __MOUSE_DWA_H__ */
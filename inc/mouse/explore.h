@@ -0,0 +1,244 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/mouse/explore.h
+ *  \brief Frontier based exploration of the map.
+ *
+ *  A frontier cell is a free cell of the map (see mouse/map.h) next to an
+ *   unknown one: going there shows what's beyond. The frontier cells are
+ *   kept in a bitmap, and counted in blocks of EXPLORE_BLOCK x EXPLORE_BLOCK
+ *   cells. The bitmap is updated from the map state change log, only the
+ *   cells that changed and their neighbours are looked at. When changes
+ *   are lost the whole map is scanned again, EXPLORE_SCAN_ROWS rows per
+ *   update.
+ *
+ *  Blocks with at least EXPLORE_MIN_CELLS frontier cells are candidate
+ *   goals. They are ranked by the straight line distance to them and the
+ *   turn to face them, less a bonus for the bigger frontiers and one for
+ *   those in the direction where the beacon was last seen, from where it
+ *   was seen. The goal is the frontier cell of the best block closest to
+ *   the middle of its frontier cells. It's kept until another block is
+ *   better by EXPLORE_HYST, or the goal is no longer a frontier.
+ *
+ *  A goal that is reached while still a frontier, or that can't be
+ *   reached, may be a frontier that can't be cleared (beyond a wall or
+ *   where the sensors don't see). So may a goal towards which the robot
+ *   doesn't move for EXPLORE_STUCK cycles, stuck against an obstacle the
+ *   sensors missed. Its block costs EXPLORE_K_TRIED more for each such
+ *   try, and after EXPLORE_TRIES it's no longer a candidate. The tries are
+ *   forgotten when a goal is cleared, and every EXPLORE_FORGET cycles.
+ *
+ *  When no block is a candidate, the blocks with fewer frontier cells are,
+ *   and then the ones given up, so the exploration is only done when there
+ *   are no frontiers left.
+ *
+ *  \code
+ *  mouse_waitStep10ms();
+ *  sensors_update();
+ *  map_update();
+ *  explore_update();
+ *  plan_update();
+ *  \endcode
+ *
+ *  explore_update() sets the goal of the planner (see mouse/plan.h), the
+ *   path is then followed by the motion layer, like dwa_update().
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __MOUSE_EXPLORE_H__
+#define __MOUSE_EXPLORE_H__
+
+
+#include <base.h>
+#include <mouse/map.h>
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Map cells on each side of a block (MAP_SIZE must be a multiple),
+ *   and frontier cells of a candidate block.
+ */
+#define EXPLORE_BLOCK         8
+#define EXPLORE_MIN_CELLS     4
+
+/**
+ *  \brief Map rows scanned on each update after changes were lost.
+ */
+#define EXPLORE_SCAN_ROWS     8
+
+/**
+ *  \brief Cost (in mm) of each degree of turn, bonus (in mm) of each
+ *   frontier cell of a block.
+ */
+#define EXPLORE_K_TURN        3
+#define EXPLORE_K_SIZE       20
+
+/**
+ *  \brief Bonus (in mm) of a block in the direction where the beacon was
+ *   last seen, and angle (in degrees) from that direction where the bonus
+ *   goes down to zero.
+ */
+#define EXPLORE_K_BEACON   2000
+#define EXPLORE_BEACON_CONE  30
+
+/**
+ *  \brief Cost (in mm) by which another block must be better to change the
+ *   goal, and cycles between two rankings.
+ */
+#define EXPLORE_HYST        300
+#define EXPLORE_PERIOD       50
+
+/**
+ *  \brief Distance (in mm) to the goal at which it's reached, and cycles
+ *   after which the goal is given up if the robot didn't move that much.
+ */
+#define EXPLORE_REACH       100
+#define EXPLORE_STUCK       500
+
+/**
+ *  \brief Cost (in mm) of each failed try of a block, tries after which
+ *   it's given up, and cycles after which the tries are forgotten.
+ */
+#define EXPLORE_K_TRIED    1000
+#define EXPLORE_TRIES         3
+#define EXPLORE_FORGET     3000
+
+
+/* ==========================================================================
+ * Constants
+ */
+
+/**
+ *  \brief Exploration states.
+ */
+#define EXPLORE_GO            0       ///< Going to a frontier
+#define EXPLORE_SCAN          1       ///< Scanning the map, no goal yet
+#define EXPLORE_DONE          2       ///< No frontiers left
+
+#define EXPLORE_BLOCKS_SIDE   (MAP_SIZE / EXPLORE_BLOCK)
+#define EXPLORE_BLOCKS        (EXPLORE_BLOCKS_SIDE * EXPLORE_BLOCKS_SIDE)
+
+
+/* ==========================================================================
+ * Management
+ */
+
+/**
+ *  \brief Initialize the exploration module, on the map of map_init().
+ *
+ *  Like the other functions without the _r suffix, only built with
+ *   EXPLORE_DEFAULT (see conf.h).
+ */
+void explore_init   ( void );
+
+/**
+ *  \brief Update the frontiers and the goal.
+ *
+ *  The pose is the one of sensors_position() and sensors_compass(), and
+ *   the beacon the one of sensors_beacon() and sensors_beaconBearing(), so
+ *   this MUST be called after sensors_update() and map_update().
+ *
+ *  A new goal is set with plan_setGoal(), and a goal the planner can't
+ *   reach (PLAN_NO_PATH) is rejected.
+ *
+ *  \returns The exploration state.
+ */
+uint explore_update ( void );
+
+/**
+ *  \brief Give up the current goal, as a failed try of its block.
+ */
+void explore_reject ( void );
+
+
+/* ==========================================================================
+ * Queries
+ */
+
+/**
+ *  \brief Current goal (in mm).
+ *
+ *  \returns false if there's no goal.
+ */
+bool explore_goal      ( int* x, int* y );
+
+/**
+ *  \brief Number of frontier cells.
+ */
+uint explore_frontiers ( void );
+
+
+/* ==========================================================================
+ * Reentrant interface
+ */
+
+/**
+ *  \brief State of one instance of the module.
+ *
+ *  The fields are internal to the module, use the functions to access them.
+ */
+typedef struct {
+	const mapCtx* map;
+	uint   mapSeq;               // Position in the map state change log
+	uint   scan;                 // Next map row to scan
+
+	uint   front[MAP_SIZE * MAP_SIZE / 32];
+	uint   nFront;
+
+	uchar  count[EXPLORE_BLOCKS];   // Frontier cells of each block
+	ushort sumX[EXPLORE_BLOCKS];    // Sum of their cells
+	ushort sumY[EXPLORE_BLOCKS];
+	uchar  tried[EXPLORE_BLOCKS];   // Failed tries of each block
+	uint   triedAge;                // Cycles since they were forgotten
+
+	bool   beaconOn;             // Where the beacon was last seen from
+	int    beaconX;
+	int    beaconY;
+	int    beaconBear;           // World bearing (in degrees)
+
+	uint   state;
+	int    goal;                 // Block of the goal, -1 if none
+	int    goalX;
+	int    goalY;
+	bool   newGoal;              // Goal changed on the last update
+	uint   cycles;               // Since the last ranking
+	int    stuckX;               // Where the robot was EXPLORE_REACH away
+	int    stuckY;               //  from, and cycles since
+	uint   stuck;
+} exploreCtx;
+
+/**
+ *  \brief Initialize an instance of the module, working on the given map.
+ */
+void explore_init_r   ( exploreCtx* ctx, const mapCtx* map );
+
+/**
+ *  \brief Same as explore_update() for the given instance, robot pose and
+ *   beacon reading. The goal is provided by explore_goal_r().
+ *
+ *  \param x, y    The robot position in mm.
+ *  \param degree  The robot heading, anticlockwise.
+ *  \param beacon  Is the beacon seen, on a valid reading.
+ *  \param bearing Its world bearing (in degrees), when seen.
+ */
+uint explore_update_r ( exploreCtx* ctx, int x, int y, int degree, bool beacon, int bearing );
+void explore_reject_r ( exploreCtx* ctx );
+
+/**
+ *  \brief Current goal, and whether it changed on the last update.
+ */
+bool explore_goal_r      ( const exploreCtx* ctx, int* x, int* y, bool* changed );
+uint explore_frontiers_r ( const exploreCtx* ctx );
+
+
+/* ========================================================================== */
+#endif /* __MOUSE_EXPLORE_H__ */
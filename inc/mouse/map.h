@@ -0,0 +1,286 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/mouse/map.h
+ *  \brief Occupancy grid of the arena built from the obstacle sensors.
+ *
+ *  The arena is divided in square cells of MAP_CELL mm, centered on the
+ *   position where the map was cleared, with the same axes as
+ *   sensors_position(). Each cell keeps the log-odds of being occupied in
+ *   MAP_CELL_BITS bits, packed in words, so the default 128 x 128 cells
+ *   (6.4 x 6.4 m) take 8 KB.
+ *
+ *  Each call to map_update() casts the rays of the three obstacle sensors
+ *   from the robot pose: the cells the ray goes through become more
+ *   likely free, the one where the obstacle was seen more likely occupied.
+ *   Rays are traversed with integer Bresenham steps and are at most
+ *   OBST_RANGE long, so an update touches at most MAP_UPDATE_MAX cells.
+ *
+ *  \code
+ *  mouse_waitStep10ms();
+ *  sensors_update();
+ *  map_update();
+ *  \endcode
+ *
+ *  Positions outside the map are reported as MAP_UNKNOWN and never
+ *   updated.
+ *
+ *  The cells that become occupied, or stop being so, are kept in a change
+ *   log, so planners only have to look at what changed (see
+ *   map_changes()). Every change of the state of a cell, free and unknown
+ *   included, is kept in a second, longer, log (see map_stateChanges()).
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __MOUSE_MAP_H__
+#define __MOUSE_MAP_H__
+
+
+#include <base.h>
+#include <conf.h>
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Bits per cell, either 2 or 4.
+ *
+ *  With 2 bits the map takes half the memory, but a single reading
+ *   changes the state of a cell.
+ */
+#define MAP_CELL_BITS    4
+
+/**
+ *  \brief Size of the cells (in mm) and number of cells on each side of the
+ *   map. MAP_SIZE must be a multiple of 32 / MAP_CELL_BITS.
+ */
+#define MAP_CELL        50
+#define MAP_SIZE       128
+
+/**
+ *  \brief Number of the last cell changes kept for map_changes(), and of
+ *   the last state changes kept for map_stateChanges().
+ *
+ *  An update changes the state of at most MAP_UPDATE_MAX cells.
+ */
+#define MAP_CHANGES     64
+#define MAP_STATES     256
+
+
+/* ==========================================================================
+ * Constants
+ */
+
+/**
+ *  \brief Cell states.
+ */
+#define MAP_FREE         0
+#define MAP_UNKNOWN      1
+#define MAP_OCCUPIED     2
+
+/**
+ *  \brief Log-odds steps of an hit and of a miss, and log-odds beyond
+ *   which a cell is free or occupied.
+ *
+ *  With 4 bits a cell is occupied after a single hit, and free after two
+ *   misses. The log-odds saturate at the range of the cell bits.
+ */
+#if MAP_CELL_BITS == 4
+#define MAP_HIT          3
+#define MAP_MISS         1
+#define MAP_OCC_LEVEL    3
+#define MAP_FREE_LEVEL  -2
+#elif MAP_CELL_BITS == 2
+#define MAP_HIT          1
+#define MAP_MISS         1
+#define MAP_OCC_LEVEL    1
+#define MAP_FREE_LEVEL  -1
+#else
+#error "MAP_CELL_BITS must be 2 or 4"
+#endif
+
+/**
+ *  \brief Maximum number of cells touched by map_update().
+ */
+#define MAP_UPDATE_MAX   (3 * ((OBST_RANGE * 10 + OBST_OFFSET) / MAP_CELL + 2))
+
+#define MAP_CELL_WORD    (32 / MAP_CELL_BITS)
+#define MAP_WORDS        (MAP_SIZE * MAP_SIZE / MAP_CELL_WORD)
+
+
+/* ==========================================================================
+ * Management
+ */
+
+/**
+ *  \brief Initialize the map module, all the cells are unknown and the map
+ *   is centered on the start position.
+ *
+ *  Like the other functions without the _r suffix, only built with
+ *   MAP_DEFAULT (see conf.h).
+ */
+void map_init   ( void );
+
+/**
+ *  \brief Forget every cell, the map is centered on the current position
+ *   reported by sensors_position().
+ */
+void map_clear  ( void );
+
+/**
+ *  \brief Add the last obstacle sensors readings to the map.
+ *
+ *  The pose is the one of sensors_position() and sensors_compass(), so this
+ *   MUST be called after sensors_update().
+ */
+void map_update ( void );
+
+
+/* ==========================================================================
+ * Queries
+ */
+
+/**
+ *  \brief State of the cell containing a position.
+ *
+ *  \param x, y The position in mm, in the frame of sensors_position().
+ *
+ *  \returns MAP_FREE, MAP_OCCUPIED or MAP_UNKNOWN.
+ */
+int  map_state      ( int x, int y );
+
+/**
+ *  \brief State of a cell, same as map_state().
+ */
+int  map_cellState  ( int cx, int cy );
+
+/**
+ *  \brief Log-odds of a cell being occupied, in MAP_HIT and MAP_MISS
+ *   steps. Zero when unknown or outside the map.
+ */
+int  map_logOdds    ( int cx, int cy );
+
+/**
+ *  \brief Cell containing a position.
+ *
+ *  \returns false if the position is outside the map, in which case the
+ *            cell isn't changed.
+ */
+bool map_toCell     ( int x, int y, int* cx, int* cy );
+
+/**
+ *  \brief Position (in mm) of the center of a cell.
+ */
+void map_cellCenter ( int cx, int cy, int* x, int* y );
+
+/**
+ *  \brief Distance to the nearest occupied cell in a direction.
+ *
+ *  The cells are traversed like the sensor rays.
+ *
+ *  \param x, y    Start position in mm.
+ *  \param degree  Direction, anticlockwise like sensors_compass().
+ *  \param maxDist Maximum distance to look at, in mm.
+ *
+ *  \returns The distance in mm, or -1 if there's no occupied cell up to
+ *            maxDist.
+ */
+int  map_nearest    ( int x, int y, int degree, int maxDist );
+
+/**
+ *  \brief Next cell that became occupied, or stopped being so.
+ *
+ *  Each reader keeps its own position in the change log, start it with
+ *   the value returned by map_changeSeq().
+ *
+ *  \param seq    Position of the reader, advanced on each change.
+ *  \param cx, cy The cell that changed.
+ *
+ *  \returns 1 if a cell is provided, 0 if there are no more changes, or
+ *            -1 if some were lost (more than MAP_CHANGES since the last
+ *            call, or the map was cleared), in which case seq is moved to
+ *            the end of the log and the whole map must be read again.
+ */
+int  map_changes    ( uint* seq, int* cx, int* cy );
+
+/**
+ *  \brief Position of the end of the change log.
+ */
+uint map_changeSeq  ( void );
+
+/**
+ *  \brief Next cell that changed state, same as map_changes() on the log
+ *   of every state change (MAP_STATES long).
+ */
+int  map_stateChanges ( uint* seq, int* cx, int* cy );
+
+/**
+ *  \brief Position of the end of the state change log.
+ */
+uint map_stateSeq     ( void );
+
+
+/* ==========================================================================
+ * Reentrant interface
+ */
+
+/**
+ *  \brief State of one instance of the module.
+ *
+ *  The fields are internal to the module, use the functions to access them.
+ */
+typedef struct {
+	int  originX;                // Position of the map center (in mm)
+	int  originY;
+
+	uint cells[MAP_WORDS];
+
+	ushort changes[MAP_CHANGES]; // Change log, cell indexes
+	uint   changeSeq;            // Number of changes logged
+
+	ushort states[MAP_STATES];   // State change log, cell indexes
+	uint   stateSeq;
+} mapCtx;
+
+/**
+ *  \brief Get the instance used by the functions without the _r suffix.
+ */
+mapCtx* map_default ( void );
+
+/**
+ *  \brief Same as map_clear() for the given instance, centered on (x, y).
+ */
+void map_clear_r  ( mapCtx* ctx, int x, int y );
+
+/**
+ *  \brief Same as map_update() for the given instance and robot pose.
+ *
+ *  The obstacle sensors are read directly from the robot.
+ *
+ *  \param x, y   The robot position in mm.
+ *  \param degree The robot heading, anticlockwise.
+ */
+void map_update_r ( mapCtx* ctx, int x, int y, int degree );
+
+int  map_state_r      ( const mapCtx* ctx, int x, int y );
+int  map_cellState_r  ( const mapCtx* ctx, int cx, int cy );
+int  map_logOdds_r    ( const mapCtx* ctx, int cx, int cy );
+bool map_toCell_r     ( const mapCtx* ctx, int x, int y, int* cx, int* cy );
+void map_cellCenter_r ( const mapCtx* ctx, int cx, int cy, int* x, int* y );
+int  map_nearest_r    ( const mapCtx* ctx, int x, int y, int degree, int maxDist );
+int  map_changes_r    ( const mapCtx* ctx, uint* seq, int* cx, int* cy );
+uint map_changeSeq_r  ( const mapCtx* ctx );
+int  map_stateChanges_r ( const mapCtx* ctx, uint* seq, int* cx, int* cy );
+uint map_stateSeq_r     ( const mapCtx* ctx );
+
+
+/* ========================================================================== */
+#endif /* __MOUSE_MAP_H__ */
@@ -0,0 +1,257 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/mouse/mcl.h
+ *  \brief Monte Carlo localization on a known arena.
+ *
+ *  When the walls of the arena are known in advance, the pose of the robot
+ *   in it can be recovered from the obstacle sensors, beyond the drift of
+ *   the odometry. The pose is tracked by a fixed pool of particles, each a
+ *   guess of the pose in the arena, with a weight.
+ *
+ *  The particles move by the odometry from one update to the next, with
+ *   some noise (more while bumping, the wheels slip). They are then
+ *   weighted by how well the readings fit the walls from where they are:
+ *   the end point of each reading should be on a wall, and the distance to
+ *   the nearest one is looked up in a grid computed with the arena (the
+ *   readings out of range are not used). When the weights are concentrated
+ *   on few particles, they are drawn again in proportion to them.
+ *
+ *  The weights are unsigned, scaled together after each update so that the
+ *   largest one is in [MCL_ONE, 2 * MCL_ONE[. The filter only updates once
+ *   the robot moved MCL_STEP_DIST or turned MCL_STEP_ANGLE, and its cost
+ *   goes with the number of particles, which can be changed at any time to
+ *   trade accuracy against cycle time.
+ *
+ *  \code
+ *  mcl_init();
+ *  mcl_setArena(4000, 3000);
+ *  mcl_addWall(1000, 0, 1000, 1800);
+ *  mcl_setPose(400, 400, 90, 100, 10);
+ *
+ *  mouse_waitStep10ms();
+ *  sensors_update();
+ *  mcl_update();
+ *  \endcode
+ *
+ *  The arena frame is the one of the walls, not the one of the odometry.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __MOUSE_MCL_H__
+#define __MOUSE_MCL_H__
+
+
+#include <base.h>
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Number of particles of the pool, the most that can be used (up
+ *   to 256, the sums of the weights are 32 bits).
+ */
+#define MCL_PARTICLES   200
+
+/**
+ *  \brief Side (in mm) of the cells of the distance grid, and number of
+ *   cells on each side of it. Arenas up to (MCL_GRID - 1) * MCL_CELL mm are
+ *   supported.
+ */
+#define MCL_CELL         50
+#define MCL_GRID        100
+
+/**
+ *  \brief Distance (in mm) to the walls under which a particle is dropped,
+ *   some less than the robot radius (the grid is coarse).
+ */
+#define MCL_RADIUS       60
+
+/**
+ *  \brief Distance (in cm) of the end of a reading to a wall at which its
+ *   weight is halved, and weight (out of 255) of a reading far from any
+ *   wall (an obstacle that isn't in the arena).
+ */
+#define MCL_SIGMA         5
+#define MCL_FLOOR        16
+
+/**
+ *  \brief Largest error of the odometry: of the distance and of the turn
+ *   (in %), and of the heading (in degrees) for each 100 mm. While bumping
+ *   they are MCL_K_BUMP times larger.
+ */
+#define MCL_NOISE_DIST   10
+#define MCL_NOISE_TURN   10
+#define MCL_NOISE_DRIFT   2
+#define MCL_K_BUMP        5
+
+/**
+ *  \brief Distance (in mm) or turn (in degrees) between two updates.
+ */
+#define MCL_STEP_DIST    20
+#define MCL_STEP_ANGLE    5
+
+/**
+ *  \brief Effective number of particles (in % of them) under which they are
+ *   drawn again.
+ */
+#define MCL_RESAMPLE     50
+
+
+/* ==========================================================================
+ * Constants
+ */
+
+/**
+ *  \brief Weight of the particles after they are drawn.
+ */
+#define MCL_ONE         (1 << 15)
+
+
+/* ==========================================================================
+ * Management
+ */
+
+/**
+ *  \brief Initialize the localization module, with an empty arena and the
+ *   particles at the origin.
+ *
+ *  Like the other functions without the _r suffix, only built with
+ *   MCL_DEFAULT (see conf.h).
+ */
+void mcl_init      ( void );
+
+/**
+ *  \brief Start a new arena, of the given size (in mm), with its walls
+ *   around.
+ */
+void mcl_setArena  ( int width, int height );
+
+/**
+ *  \brief Add a wall of the arena, the segment between the given points
+ *   (in mm).
+ */
+void mcl_addWall   ( int x0, int y0, int x1, int y1 );
+
+/**
+ *  \brief Spread the particles around a pose of the arena.
+ *
+ *  The distance grid of the walls added since the last call is computed
+ *   here, so this MUST be called after them and before the updates.
+ *
+ *  \param x, y     The position in mm.
+ *  \param degree   The heading, anticlockwise.
+ *  \param errDist  Largest error (in mm) of the position.
+ *  \param errAngle Largest error (in degrees) of the heading.
+ */
+void mcl_setPose   ( int x, int y, int degree, int errDist, int errAngle );
+
+/**
+ *  \brief Move the particles by the odometry and weight them by the
+ *   obstacle sensors.
+ *
+ *  The pose is the one of sensors_position() and sensors_compass(), so this
+ *   MUST be called after sensors_update().
+ *
+ *  \returns true if the estimate was updated (see MCL_STEP_DIST).
+ */
+bool mcl_update    ( void );
+
+/**
+ *  \brief Change the number of particles used, up to MCL_PARTICLES.
+ *
+ *  They are drawn again from the current ones.
+ */
+void mcl_setParticles ( uint n );
+
+
+/* ==========================================================================
+ * Queries
+ */
+
+/**
+ *  \brief Estimate of the pose in the arena, the weighted mean of the
+ *   particles.
+ *
+ *  Any of the arguments can be `NULL` if you're not interested in the value.
+ *
+ *  \returns The mean distance (in mm) of the particles to it.
+ */
+uint mcl_pose      ( int* x, int* y, int* degree );
+
+/**
+ *  \brief Number of particles used.
+ */
+uint mcl_particles ( void );
+
+
+/* ==========================================================================
+ * Reentrant interface
+ */
+
+/**
+ *  \brief State of one instance of the module.
+ *
+ *  The fields are internal to the module, use the functions to access them.
+ */
+typedef struct {
+	uchar dist[MCL_GRID * MCL_GRID];   // Distance (in cm) to the nearest wall
+	uchar weight[256];           // Weight of a reading for each distance
+	int   width;                 // Arena size (in mm)
+	int   height;
+	bool  built;                 // Distances of all the walls computed
+
+	int   pX[MCL_PARTICLES];     // Particles (in mm and millidegrees)
+	int   pY[MCL_PARTICLES];
+	int   pA[MCL_PARTICLES];
+	uint  pW[MCL_PARTICLES];
+	int   tX[MCL_PARTICLES];     // Drawn particles
+	int   tY[MCL_PARTICLES];
+	int   tA[MCL_PARTICLES];
+	uint  n;
+	uint  seed;
+
+	bool  odoOn;                 // Odometry at the last update
+	int   odoX;
+	int   odoY;
+	int   odoDeg;
+	bool  bumped;                // Since the last update
+
+	int   estX;                  // Estimate
+	int   estY;
+	int   estDeg;
+	uint  spread;
+} mclCtx;
+
+/**
+ *  \brief Initialize an instance of the module.
+ */
+void mcl_init_r     ( mclCtx* ctx );
+void mcl_setArena_r ( mclCtx* ctx, int width, int height );
+void mcl_addWall_r  ( mclCtx* ctx, int x0, int y0, int x1, int y1 );
+void mcl_setPose_r  ( mclCtx* ctx, int x, int y, int degree, int errDist, int errAngle );
+
+/**
+ *  \brief Same as mcl_update() for the given instance and odometry pose.
+ *   The obstacle and bump sensors are read from mouse/sensors.h.
+ *
+ *  \param x, y   The odometry position in mm.
+ *  \param degree The odometry heading, anticlockwise.
+ */
+bool mcl_update_r   ( mclCtx* ctx, int x, int y, int degree );
+void mcl_setParticles_r ( mclCtx* ctx, uint n );
+
+uint mcl_pose_r      ( const mclCtx* ctx, int* x, int* y, int* degree );
+uint mcl_particles_r ( const mclCtx* ctx );
+
+
+/* ========================================================================== */
+#endif /* __MOUSE_MCL_H__ */
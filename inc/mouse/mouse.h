@@ -22,6 +22,31 @@
 #include <base.h>
 
 
+/* ========================================================================== */
+
+/**
+ *  \brief Operating modes, entered as the control loop overruns its cycle
+ *   time (see mouse_mode()).
+ */
+#define MOUSE_NORMAL   0           ///< Cycles on time
+#define MOUSE_SHED     1           ///< Low priority tasks (telemetry) skipped
+#define MOUSE_SLOW     2           ///< Velocity reduced to OVERRUN_SLOW_VEL
+#define MOUSE_SAFE     3           ///< Motors stopped, the watchdog resets the robot
+
+/**
+ *  \brief Cycle timing statistics.
+ */
+typedef struct {
+	uint cycles;
+	uint overruns;                 ///< Cycles that ended after their deadline
+	uint missed;                   ///< Ticks skipped by the overruns
+	uint late;                     ///< Lateness of the last cycle, in us
+	uint maxLate;                  ///< Worst lateness, in us
+	uint ticks;                    ///< Length of the last cycle, in ticks
+	uint level;                    ///< Overrun level (see OVERRUN_COST)
+} mouseCycleStats;
+
+
 /* ========================================================================== */
 
 /**
@@ -40,31 +65,84 @@ void mouse_init ( void );
 /**
  *  \brief Wait for the next 10ms tick
  *
- *  The wait is done by pooling.
+ *  The wait is done by pooling. The time left is given to the background
+ *   jobs (see util/jobs.h), which send the pending log records. Marks the
+ *   cycle boundary of a recording (see util/rec.h).
+ *
+ *  The deadline is the previous one plus the period. If it has already
+ *   passed (the cycle overran) this returns at once, the ticks missed are
+ *   accounted and the next deadline is one period from now.
  */
 inline void mouse_waitStep10ms ( void );
 
 /**
  *  \brief Wait for the next 20ms tick
  *
- *  The wait is done by pooling.
+ *  The wait is done by pooling, running the background jobs. Marks the
+ *   cycle boundary of a recording (see util/rec.h).
  */
 inline void mouse_waitStep20ms ( void );
 
 /**
  *  \brief Wait for the next 40ms tick
  *
- *  The wait is done by pooling.
+ *  The wait is done by pooling, running the background jobs. Marks the
+ *   cycle boundary of a recording (see util/rec.h).
  */
 inline void mouse_waitStep40ms ( void );
 
 /**
  *  \brief Wait for the next 80ms tick
  *
- *  The wait is done by pooling.
+ *  The wait is done by pooling, running the background jobs. Marks the
+ *   cycle boundary of a recording (see util/rec.h).
  */
 inline void mouse_waitStep80ms ( void );
 
 
+/* ==========================================================================
+ * Overruns
+ */
+
+/**
+ *  \brief Current operating mode, MOUSE_NORMAL to MOUSE_SAFE.
+ *
+ *  The mode changes with the overrun level: each late cycle adds
+ *   OVERRUN_COST, each cycle on time subtracts 1. The application should
+ *   skip its own low priority work from MOUSE_SHED on. The library skips
+ *   the telemetry, reduces the velocity on MOUSE_SLOW and stops the
+ *   motors on MOUSE_SAFE, where the watchdog is left to reset the robot.
+ */
+uint mouse_mode       ( void );
+
+/**
+ *  \brief Force an operating mode, the overrun level is set to match it.
+ *
+ *  The watchdog started by MOUSE_SAFE can't be stopped, but it is cleared
+ *   again on every cycle once the mode is left.
+ */
+void mouse_setMode    ( uint mode );
+
+/**
+ *  \brief Get the cycle timing statistics.
+ */
+void mouse_cycleStats ( mouseCycleStats* stats );
+
+/**
+ *  \brief Reset the statistics and the deadline, the mode and the overrun
+ *   level are kept.
+ *
+ *  The next wait starts a new period without accounting an overrun. Use it
+ *   after blocking the control loop on purpose (e.g. waiting for a button).
+ */
+void mouse_cycleReset ( void );
+
+/**
+ *  \brief Scale a value measured over the last cycle (e.g. encoder ticks)
+ *   to a single 10ms tick, rounded to the nearest.
+ */
+int  mouse_perTick    ( int value );
+
+
 /* ========================================================================== */
 #endif /* __MOUSE_MOUSE_H__ */
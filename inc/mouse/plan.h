@@ -0,0 +1,241 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/mouse/plan.h
+ *  \brief Path planning over the occupancy grid.
+ *
+ *  The planner searches the map (see mouse/map.h) with D* Lite: the search
+ *   goes from the goal to the robot, so when the robot moves or cells
+ *   become occupied only the nodes whose distance to the goal changed are
+ *   updated, instead of searching again.
+ *
+ *  The planner works on a coarser grid than the map, each node being
+ *   PLAN_SCALE x PLAN_SCALE map cells. A node is blocked when an occupied
+ *   cell is within PLAN_MARGIN cells of it, unknown cells are taken as free.
+ *   Paths go from node to node in 8 directions, without cutting the
+ *   corners of blocked nodes.
+ *
+ *  The work is time sliced: each call to plan_update() takes the map
+ *   changes and the robot position, and searches for at most
+ *   PLAN_BUDGET_US, resuming on the next call. The search can also go on
+ *   in the idle time of the loop, as a background job (see util/jobs.h):
+ *
+ *  \code
+ *  jobs_add("plan", plan_job, NULL);
+ *  \endcode
+ *
+ *  \code
+ *  mouse_waitStep10ms();
+ *  sensors_update();
+ *  map_update();
+ *
+ *  if (plan_update() == PLAN_READY && plan_next(&x, &y)) {
+ *      // Go to (x, y)
+ *  }
+ *  \endcode
+ *
+ *  The nodes, the heap and the blocked nodes are statically allocated,
+ *   about 33 KB with the defaults.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __MOUSE_PLAN_H__
+#define __MOUSE_PLAN_H__
+
+
+#include <base.h>
+#include <mouse/map.h>
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Map cells on each side of a node, and map cells around an
+ *   occupied one where the robot can't go.
+ */
+#define PLAN_SCALE       2
+#define PLAN_MARGIN      1
+
+/**
+ *  \brief Capacity of the open list. When it's exceeded the search is
+ *   started again.
+ */
+#define PLAN_HEAP     1024
+
+/**
+ *  \brief Time (in microseconds) spent by plan_update() on each call.
+ */
+#define PLAN_BUDGET_US 1000
+
+
+/* ==========================================================================
+ * Constants
+ */
+
+/**
+ *  \brief Planner states.
+ */
+#define PLAN_IDLE        0       ///< No goal
+#define PLAN_BUSY        1       ///< Searching, the path isn't known yet
+#define PLAN_READY       2       ///< Shortest path known
+#define PLAN_NO_PATH     3       ///< The goal can't be reached
+
+#define PLAN_SIZE        (MAP_SIZE / PLAN_SCALE)
+#define PLAN_NODES       (PLAN_SIZE * PLAN_SIZE)
+#define PLAN_CELL        (MAP_CELL * PLAN_SCALE)
+
+
+/* ==========================================================================
+ * Management
+ */
+
+/**
+ *  \brief Initialize the planner module, on the map of map_init().
+ *
+ *  Like the other functions without the _r suffix, only built with
+ *   PLAN_DEFAULT (see conf.h).
+ */
+void plan_init    ( void );
+
+/**
+ *  \brief Set the goal, in mm in the frame of sensors_position().
+ *
+ *  The search starts from scratch.
+ *
+ *  \returns false if the goal is outside the map, the planner is idle then.
+ */
+bool plan_setGoal ( int x, int y );
+
+/**
+ *  \brief Forget the goal.
+ */
+void plan_stop    ( void );
+
+/**
+ *  \brief Update the plan.
+ *
+ *  Takes the changes of the map and the position of sensors_position(),
+ *   and searches for at most PLAN_BUDGET_US. MUST be called after
+ *   sensors_update() and map_update(). Off the map, the path starts at the
+ *   closest node on it.
+ *
+ *  \returns The planner state.
+ */
+uint plan_update  ( void );
+
+/**
+ *  \brief Background job (see util/jobs.h) that goes on with the search.
+ *
+ *  \param ctx      The instance, NULL for the one of the functions without
+ *          the _r suffix (PLAN_DEFAULT, see conf.h).
+ *  \param budgetUs Time it may take.
+ *
+ *  \returns Nodes expanded and map rows scanned, 0 if there's nothing to
+ *            search.
+ */
+uint plan_job     ( void* ctx, uint budgetUs );
+
+
+/* ==========================================================================
+ * Path
+ */
+
+/**
+ *  \brief Planner state of the last plan_update().
+ */
+uint plan_state   ( void );
+
+/**
+ *  \brief Next waypoint, the center of the next node of the path (in mm).
+ *
+ *  \returns false if the path isn't known (the planner isn't PLAN_READY)
+ *            or the robot is on the goal node.
+ */
+bool plan_next    ( int* x, int* y );
+
+/**
+ *  \brief Waypoints of the path, from the next one to the goal.
+ *
+ *  \returns The number of waypoints, at most max.
+ */
+uint plan_path    ( int* xs, int* ys, uint max );
+
+/**
+ *  \brief Length of the path (in mm), -1 if it isn't known.
+ */
+int  plan_length  ( void );
+
+/**
+ *  \brief Nodes expanded since plan_init().
+ */
+uint plan_expanded ( void );
+
+
+/* ==========================================================================
+ * Reentrant interface
+ */
+
+typedef struct {
+	uint   k1;                   // Key, lexicographic
+	ushort k2;
+	ushort node;
+} planItem;
+
+/**
+ *  \brief State of one instance of the module.
+ *
+ *  The fields are internal to the module, use the functions to access them.
+ */
+typedef struct {
+	const mapCtx* map;
+	uint   mapSeq;               // Position in the map change log
+
+	uint   state;
+	bool   restart;              // Search from scratch on the next update
+	int    goal;
+	int    start;
+	int    last;                 // Start when km was last updated
+	uint   km;
+
+	uint   expanded;
+	uint   scan;                 // Next map row to scan for blocked nodes
+
+	ushort g[PLAN_NODES];        // Cost to the goal (PLAN_CELL / 10 units)
+	ushort rhs[PLAN_NODES];
+	ushort heapIdx[PLAN_NODES];  // Position in the heap + 1, 0 if not in it
+	uint   blocked[PLAN_NODES / 32];
+
+	planItem heap[PLAN_HEAP];
+	uint     heapLen;
+} planCtx;
+
+/**
+ *  \brief Initialize an instance of the module, working on the given map.
+ */
+void plan_init_r    ( planCtx* ctx, const mapCtx* map );
+
+/**
+ *  \brief Same as plan_update() for the given instance, robot position and
+ *   time budget.
+ */
+uint plan_update_r  ( planCtx* ctx, int x, int y, uint budgetUs );
+
+bool plan_setGoal_r ( planCtx* ctx, int x, int y );
+void plan_stop_r    ( planCtx* ctx );
+uint plan_state_r   ( const planCtx* ctx );
+bool plan_next_r    ( const planCtx* ctx, int* x, int* y );
+uint plan_path_r    ( const planCtx* ctx, int* xs, int* ys, uint max );
+int  plan_length_r  ( const planCtx* ctx );
+uint plan_expanded_r ( const planCtx* ctx );
+
+
+/* ========================================================================== */
+#endif /* __MOUSE_PLAN_H__ */
@@ -59,6 +59,7 @@
 
 
 #include <base.h>
+#include <mouse/state.h>
 
 
 /* ==========================================================================
@@ -88,7 +89,7 @@
  *  This function *MUST* be called before using this module. It is also
  *   usefull for reseting the module in case you want to restart the robot.
  */
-void sensors_init   ( void );
+static inline void sensors_init   ( void );
 
 /**
  *  \brief Update the sensory information.
@@ -106,7 +107,7 @@ void sensors_init   ( void );
  *   blocking, meaning only when all the information is collected (sensors
  *   are read) and calculations made this function returns.
  */
-void sensors_update ( void );
+static inline void sensors_update ( void );
 
 /**
  *  \brief Stop the sensors module.
@@ -115,6 +116,27 @@ void sensors_update ( void );
  */
 void sensors_stop   ( void );
 
+/**
+ *  \brief Change the filtering thresholds.
+ *
+ *  The thresholds default to the values in the configuration section of
+ *   sensors.c, and are reset by sensors_init().
+ *
+ *  \param groundSt Cycles for the ground sensors to change state.
+ *  \param beaconSt Cycles for the beacon sensor to change state.
+ *  \param bumpSt   Cycles for the bump detection to change state.
+ *  \param bumpThr  Difference (in encoder ticks per cycle) between the
+ *          motors set-point and the encoders for the robot to be stuck.
+ */
+static inline void sensors_setThresholds ( uint groundSt, uint beaconSt, uint bumpSt, int bumpThr );
+
+/**
+ *  \brief Provides the filtering thresholds in use.
+ *
+ *  Any of the arguments can be `NULL` if you're not interested in the value.
+ */
+static inline void sensors_getThresholds ( uint* groundSt, uint* beaconSt, uint* bumpSt, int* bumpThr );
+
 
 /* ==========================================================================
  * Obstacles detection
@@ -189,16 +211,65 @@ int  sensors_obstR ( void );
  *
  *  \returns true if the beacon is visible and false otherwise.
  */
-bool sensors_beacon    ( void );
+static inline bool sensors_beacon    ( void );
 
 /**
  *  \brief Provide the beacon direction.
  *
  *  The direction is given in degrees using the robot as the referencial.
  *
+ *  Only readings taken while the beacon sensor was stopped are used, so
+ *   the direction isn't affected by the servo lag. When the beacon isn't
+ *   visible the last known direction is returned.
+ *
  *  \returns The beacon direction.
  */
-int  sensors_beaconDir ( void );
+static inline int  sensors_beaconDir ( void );
+
+/**
+ *  \brief Provide the beacon bearing in the world frame.
+ *
+ *  The bearing is the beacon direction combined with the robot heading
+ *   when it was measured, using the same reference as sensors_compass()
+ *   (anticlockwise degrees). Unlike sensors_beaconDir() it stays valid
+ *   while the robot rotates.
+ *
+ *  \returns The beacon bearing in degrees, in the range ]-180, 180].
+ */
+static inline int  sensors_beaconBearing ( void );
+
+/**
+ *  \brief Indicate whether the last beacon reading is valid.
+ *
+ *  A reading is invalid when it was taken while the beacon sensor was
+ *   rotating or settling, in which case it isn't used for the beacon
+ *   direction.
+ *
+ *  \returns true if the beacon sensor was settled during the last reading.
+ */
+static inline bool sensors_beaconValid ( void );
+
+/**
+ *  \brief Provide the beacon beam width.
+ *
+ *  The width is only measured in sweep mode (see actuators_beaconSweep()),
+ *   otherwise zero is returned.
+ *
+ *  \returns The angular width of the beacon beam in degrees.
+ */
+static inline int  sensors_beaconWidth ( void );
+
+/**
+ *  \brief Provide the confidence on the beacon direction.
+ *
+ *  The confidence is only computed in sweep mode (see
+ *   actuators_beaconSweep()), otherwise zero is returned. It is based on the
+ *   agreement between consecutive sweep passes and decays when the beacon
+ *   isn't seen.
+ *
+ *  \returns The confidence in percentage.
+ */
+static inline int  sensors_beaconConf  ( void );
 
 
 /* ==========================================================================
@@ -213,7 +284,7 @@ int  sensors_beaconDir ( void );
  *
  *  \returns true if the sensor is on and false otherwise.
  */
-bool sensors_groundL  ( void );
+static inline bool sensors_groundL  ( void );
 
 /**
  *  \brief Provide the *center left* ground sensor state.
@@ -223,7 +294,7 @@ bool sensors_groundL  ( void );
  *
  *  \returns true if the sensor is on and false otherwise.
  */
-bool sensors_groundCL ( void );
+static inline bool sensors_groundCL ( void );
 
 /**
  *  \brief Provide the *center front* ground sensor state.
@@ -233,7 +304,7 @@ bool sensors_groundCL ( void );
  *
  *  \return true if the sensor is on and false otherwise.
  */
-bool sensors_groundCF ( void );
+static inline bool sensors_groundCF ( void );
 
 /**
  *  \brief Provide the *center right* ground sensor state.
@@ -243,7 +314,7 @@ bool sensors_groundCF ( void );
  *
  *  \returns true if the sensor is on and false otherwise.
  */
-bool sensors_groundCR ( void );
+static inline bool sensors_groundCR ( void );
 
 /**
  *  \brief Provide the *right most* ground sensor state.
@@ -253,7 +324,7 @@ bool sensors_groundCR ( void );
  *
  *  \returns true if the sensor is on and false otherwise.
  */
-bool sensors_groundR  ( void );
+static inline bool sensors_groundR  ( void );
 
 /**
  *  \brief Get the state of the center ground sesnsor.
@@ -268,7 +339,7 @@ bool sensors_groundR  ( void );
  *  \returns true if the sensor is on and false otherwise. This basically
  *           indicates the state of the majority of the three sensors.
  */
-bool sensors_groundC  ( void );
+static inline bool sensors_groundC  ( void );
 
 
 /* ==========================================================================
@@ -285,9 +356,13 @@ bool sensors_groundC  ( void );
  *   the sensors available on the specific robot. The position can (and
  *   probably is) an estimations so it can have a lot of error.
  *
- *  \returns The robot position relative to the start position.
+ *  Without other sensors the position is integrated from the odometry and
+ *   sensors_compass(), and the start position is the one where
+ *   sensors_init() was called. Any of the arguments can be `NULL`.
+ *
+ *  \returns The robot position relative to the start position, in mm.
  */
-void sensors_position ( int* posX, int* posY );
+static inline void sensors_position ( int* posX, int* posY );
 
 /**
  *  \brief Provides the position of the robot relative to last reading.
@@ -303,9 +378,25 @@ void sensors_position ( int* posX, int* posY );
  *   the sensors available on the specific robot. The position can (and
  *   probably is) an estimations so it can have a lot of error.
  *
- *  \returns The robot position relative to the last reading.
+ *  \returns The robot position relative to the last reading, in mm.
+ */
+static inline void sensors_movement ( int* posX, int* posY );
+
+/**
+ *  \brief Provides the distance traveled by each wheel in the last cycle.
+ *
+ *  The distance is given in cm. Any of the arguments can be `NULL` if
+ *   you're not interested in the value.
+ */
+static inline void sensors_odoPart  ( int* odoL, int* odoR );
+
+/**
+ *  \brief Provides the distance traveled by each wheel since the start.
+ *
+ *  The distance is given in cm. Any of the arguments can be `NULL` if
+ *   you're not interested in the value.
  */
-void sensors_movement ( int* posX, int* posY );
+static inline void sensors_odoInt   ( int* odoL, int* odoR );
 
 /**
  *  \brief Provides the direction of the robot.
@@ -313,9 +404,13 @@ void sensors_movement ( int* posX, int* posY );
  *  The reference depends upon the robot. It is usually North but can also
  *   be the robot start orientation or any other.
  *
- *  \returns The direction of the robot in degrees.
+ *  Without a compass the direction is estimated by odometry, relatively to
+ *   the orientation when sensors_init() was called, increasing
+ *   anticlockwise.
+ *
+ *  \returns The direction of the robot in degrees, in the range ]-180, 180].
  */
-int  sensors_compass  ( void );
+static inline int  sensors_compass  ( void );
 
 
 /* ==========================================================================
@@ -329,7 +424,7 @@ int  sensors_compass  ( void );
  *
  *  \returns The level of the battery in percentage.
  */
-uint sensors_battery ( void );
+static inline uint sensors_battery ( void );
 
 
 /* ==========================================================================
@@ -344,7 +439,7 @@ uint sensors_battery ( void );
  *
  *  \returns True if the robot is hitting something and false otherwise.
  */
-bool sensors_bump ( void );
+static inline bool sensors_bump ( void );
 
 
 /* ==========================================================================
@@ -372,5 +467,231 @@ bool sensors_startBtn ( void );
 bool sensors_stopBtn  ( void );
 
 
+/* ==========================================================================
+ * Reentrant interface
+ */
+
+/**
+ *  \brief State of one instance of the module.
+ *
+ *  The fields are internal to the module, use the functions to access them.
+ */
+typedef struct {
+	stateCtx* state;
+
+	bool beaconOn;
+	uint beaconCount;
+	int  beaconDir;
+	bool beaconValid;
+	int  beaconWidth;
+	int  beaconConf;
+	int  beaconBear;             // World frame bearing (millidegrees)
+
+	uint groundCount[5];
+	bool groundOn[5];
+
+	int  odoPartLeft;            // Odometry (in micrometers)
+	int  odoPartRight;
+	int  odoIntLeft;
+	int  odoIntRight;
+
+	int  heading;                // Millidegrees, anticlockwise
+	int  headingRem;
+
+	int  posX;                   // Position (in micrometers)
+	int  posY;
+	int  lastX;                  // Position on the last sensors_movement()
+	int  lastY;
+
+	int  battery;
+	int  batteryArray[32];
+	int  batteryIdx;
+	int  batterySum;
+
+	bool bumpOn;
+	uint bumpCount;
+	int  bumpDir;
+
+	uint groundSt;               // Filtering thresholds
+	uint beaconSt;
+	uint bumpSt;
+	int  bumpThr;
+} sensorsCtx;
+
+/**
+ *  \brief Initialize an instance of the module.
+ *
+ *  The functions without the _r suffix operate on sensorsDefault,
+ *   bound to state_default() by sensors_init(). The functions that only
+ *   read the robot directly (obstacle sensors and buttons) have no _r
+ *   variant.
+ *
+ *  \param ctx   The instance.
+ *  \param state The state exchange area shared with the actuators instance
+ *         driving the same robot.
+ */
+void sensors_init_r   ( sensorsCtx* ctx, stateCtx* state );
+
+/**
+ *  \brief Same as sensors_update() for the given instance.
+ */
+void sensors_update_r ( sensorsCtx* ctx );
+
+void sensors_setThresholds_r ( sensorsCtx* ctx, uint groundSt, uint beaconSt, uint bumpSt, int bumpThr );
+void sensors_getThresholds_r ( const sensorsCtx* ctx, uint* groundSt, uint* beaconSt, uint* bumpSt, int* bumpThr );
+
+bool sensors_beacon_r        ( const sensorsCtx* ctx );
+int  sensors_beaconDir_r     ( const sensorsCtx* ctx );
+int  sensors_beaconBearing_r ( const sensorsCtx* ctx );
+bool sensors_beaconValid_r   ( const sensorsCtx* ctx );
+int  sensors_beaconWidth_r   ( const sensorsCtx* ctx );
+int  sensors_beaconConf_r    ( const sensorsCtx* ctx );
+
+bool sensors_groundL_r  ( const sensorsCtx* ctx );
+bool sensors_groundCL_r ( const sensorsCtx* ctx );
+bool sensors_groundCF_r ( const sensorsCtx* ctx );
+bool sensors_groundCR_r ( const sensorsCtx* ctx );
+bool sensors_groundR_r  ( const sensorsCtx* ctx );
+bool sensors_groundC_r  ( const sensorsCtx* ctx );
+
+void sensors_odoPart_r  ( const sensorsCtx* ctx, int* odoL, int* odoR );
+void sensors_odoInt_r   ( const sensorsCtx* ctx, int* odoL, int* odoR );
+int  sensors_compass_r  ( const sensorsCtx* ctx );
+void sensors_position_r ( const sensorsCtx* ctx, int* posX, int* posY );
+void sensors_movement_r ( sensorsCtx* ctx, int* posX, int* posY );
+
+uint sensors_battery_r  ( const sensorsCtx* ctx );
+
+bool sensors_bump_r     ( const sensorsCtx* ctx );
+
+
+/* ==========================================================================
+ * Non reentrant interface
+ *
+ * Defined here so that reading a sensor costs a single call, to the
+ *  function with the _r suffix.
+ */
+
+/**
+ *  \brief Instance used by the functions without the _r suffix.
+ */
+extern MR_TLS sensorsCtx sensorsDefault;
+
+static inline void sensors_init ( void )
+{
+	sensors_init_r(&sensorsDefault, state_default());
+}
+
+static inline void sensors_update ( void )
+{
+	sensors_update_r(&sensorsDefault);
+}
+
+static inline void sensors_setThresholds ( uint groundSt, uint beaconSt, uint bumpSt, int bumpThr )
+{
+	sensors_setThresholds_r(&sensorsDefault, groundSt, beaconSt, bumpSt, bumpThr);
+}
+
+static inline void sensors_getThresholds ( uint* groundSt, uint* beaconSt, uint* bumpSt, int* bumpThr )
+{
+	sensors_getThresholds_r(&sensorsDefault, groundSt, beaconSt, bumpSt, bumpThr);
+}
+
+static inline bool sensors_beacon ( void )
+{
+	return sensors_beacon_r(&sensorsDefault);
+}
+
+static inline int sensors_beaconDir ( void )
+{
+	return sensors_beaconDir_r(&sensorsDefault);
+}
+
+static inline bool sensors_beaconValid ( void )
+{
+	return sensors_beaconValid_r(&sensorsDefault);
+}
+
+static inline int sensors_beaconBearing ( void )
+{
+	return sensors_beaconBearing_r(&sensorsDefault);
+}
+
+static inline int sensors_beaconWidth ( void )
+{
+	return sensors_beaconWidth_r(&sensorsDefault);
+}
+
+static inline int sensors_beaconConf ( void )
+{
+	return sensors_beaconConf_r(&sensorsDefault);
+}
+
+static inline bool sensors_groundL ( void )
+{
+	return sensors_groundL_r(&sensorsDefault);
+}
+
+static inline bool sensors_groundCL ( void )
+{
+	return sensors_groundCL_r(&sensorsDefault);
+}
+
+static inline bool sensors_groundCF ( void )
+{
+	return sensors_groundCF_r(&sensorsDefault);
+}
+
+static inline bool sensors_groundCR ( void )
+{
+	return sensors_groundCR_r(&sensorsDefault);
+}
+
+static inline bool sensors_groundR ( void )
+{
+	return sensors_groundR_r(&sensorsDefault);
+}
+
+static inline bool sensors_groundC ( void )
+{
+	return sensors_groundC_r(&sensorsDefault);
+}
+
+static inline void sensors_odoPart ( int* odoL, int* odoR )
+{
+	sensors_odoPart_r(&sensorsDefault, odoL, odoR);
+}
+
+static inline void sensors_odoInt ( int* odoL, int* odoR )
+{
+	sensors_odoInt_r(&sensorsDefault, odoL, odoR);
+}
+
+static inline int sensors_compass ( void )
+{
+	return sensors_compass_r(&sensorsDefault);
+}
+
+static inline void sensors_position ( int* posX, int* posY )
+{
+	sensors_position_r(&sensorsDefault, posX, posY);
+}
+
+static inline void sensors_movement ( int* posX, int* posY )
+{
+	sensors_movement_r(&sensorsDefault, posX, posY);
+}
+
+static inline uint sensors_battery ( void )
+{
+	return sensors_battery_r(&sensorsDefault);
+}
+
+static inline bool sensors_bump ( void )
+{
+	return sensors_bump_r(&sensorsDefault);
+}
+
+
 /* ========================================================================== */
 #endif /* __MOUSE_SENSORS_H__ */
@@ -21,6 +21,39 @@
 #include <base.h>
 
 
+/* ==========================================================================
+ * Instances
+ */
+
+/**
+ * \brief State of one instance of the module.
+ *
+ * The fields are internal to the module, use the functions to access them.
+ */
+typedef struct {
+	int  servoDegree;
+	bool servoSettled;
+
+	bool sweepActive;
+	int  sweepCenter;
+	int  sweepWidth;
+	int  sweepConf;
+
+	int  yaw;
+
+	int  spLeft;
+	int  spRight;
+} stateCtx;
+
+/**
+ * \brief Get the instance used by the functions without the _r suffix.
+ *
+ * This is the instance the sensors and actuators modules are bound to
+ *  by sensors_init() and actuators_init().
+ */
+static inline stateCtx* state_default ( void );
+
+
 /* ========================================================================== */
 
 /**
@@ -31,14 +64,72 @@
  *
  * \param degree The efective servo degree.
  */
-inline void state_setServoDegree ( int degree );
+static inline void state_setServoDegree ( int degree );
 
 /**
  * \brief Get the last announced servo degree.
  *
  * \returns The servo degreee.
  */
-inline int  state_getServoDegree ( void );
+static inline int  state_getServoDegree ( void );
+
+/**
+ * \brief Define whether the servo is settled at the announced degree.
+ *
+ * The servo is not settled while it is rotating or still settling
+ *  after reaching the requested position.
+ *
+ * \param settled True if the servo is settled and false otherwise.
+ */
+static inline void state_setServoSettled ( bool settled );
+
+/**
+ * \brief Indicate whether the servo is settled at the announced degree.
+ *
+ * \returns True if the servo is settled and false otherwise.
+ */
+static inline bool state_getServoSettled ( void );
+
+/**
+ * \brief Define the beacon sweep (or tracking) results.
+ *
+ * This is used by the actuators module when it is controlling the beacon
+ *  sensor by itself, either in sweep or in tracking mode.
+ *
+ * \param active     Whether the sweep mode is active.
+ * \param center     The beam center in degrees.
+ * \param width      The beam width in degrees.
+ * \param confidence The confidence in the results (0 to 100).
+ */
+static inline void state_setBeaconSweep ( bool active, int center, int width, int confidence );
+
+/**
+ * \brief Get the beacon sweep results.
+ *
+ * Any of the arguments can be NULL, in which case the value is not returned.
+ *
+ * \param center     Pointer to the location where the center is to be stored.
+ * \param width      Pointer to the location where the width is to be stored.
+ * \param confidence Pointer to the location where the confidence
+ *         is to be stored.
+ *
+ * \returns True if the sweep mode is active and false otherwise.
+ */
+static inline bool state_getBeaconSweep ( int* center, int* width, int* confidence );
+
+/**
+ * \brief Define the robot rotation in the last cycle.
+ *
+ * \param yaw The rotation in millidegrees (positive is anticlockwise).
+ */
+static inline void state_setYaw ( int yaw );
+
+/**
+ * \brief Get the robot rotation in the last cycle.
+ *
+ * \returns The rotation in millidegrees (positive is anticlockwise).
+ */
+static inline int  state_getYaw ( void );
 
 /**
  * \brief Define the last setpoints applied to the motors.
@@ -46,7 +137,7 @@ inline int  state_getServoDegree ( void );
  * \param left  The SP applied to the left motor.
  * \param right The SP applied to the right motor.
  */
-inline void state_setSP ( int left, int right );
+static inline void state_setSP ( int left, int right );
 
 /**
  * \brief Get the last setpoints applied to the motors.
@@ -59,7 +150,100 @@ inline void state_setSP ( int left, int right );
  * \param right Pointer to the location
  *         where the left SP is to be stored, or NULL.
  */
-inline void state_getSP ( int* left, int* right );
+static inline void state_getSP ( int* left, int* right );
+
+
+/* ==========================================================================
+ * Reentrant interface
+ *
+ * Each function operates on the given instance, and otherwise behaves as
+ *  the one with the same name without the _r suffix, which operate on the
+ *  instance returned by state_default().
+ */
+
+/**
+ * \brief Initialize an instance.
+ */
+void state_init_r ( stateCtx* ctx );
+
+inline void state_setServoDegree_r  ( stateCtx* ctx, int degree );
+inline int  state_getServoDegree_r  ( const stateCtx* ctx );
+inline void state_setServoSettled_r ( stateCtx* ctx, bool settled );
+inline bool state_getServoSettled_r ( const stateCtx* ctx );
+inline void state_setBeaconSweep_r  ( stateCtx* ctx, bool active, int center, int width, int confidence );
+inline bool state_getBeaconSweep_r  ( const stateCtx* ctx, int* center, int* width, int* confidence );
+inline void state_setYaw_r          ( stateCtx* ctx, int yaw );
+inline int  state_getYaw_r          ( const stateCtx* ctx );
+inline void state_setSP_r           ( stateCtx* ctx, int left, int right );
+inline void state_getSP_r           ( const stateCtx* ctx, int* left, int* right );
+
+
+/* ==========================================================================
+ * Non reentrant interface
+ *
+ * Defined here so that they are inlined in the sensors and actuators
+ *  modules, which call them every cycle.
+ */
+
+/**
+ * \brief Instance used by the functions without the _r suffix.
+ */
+extern MR_TLS stateCtx stateDefault;
+
+static inline stateCtx* state_default ( void )
+{
+	return &stateDefault;
+}
+
+static inline void state_setServoDegree ( int degree )
+{
+	state_setServoDegree_r(&stateDefault, degree);
+}
+
+static inline int state_getServoDegree ( void )
+{
+	return state_getServoDegree_r(&stateDefault);
+}
+
+static inline void state_setServoSettled ( bool settled )
+{
+	state_setServoSettled_r(&stateDefault, settled);
+}
+
+static inline bool state_getServoSettled ( void )
+{
+	return state_getServoSettled_r(&stateDefault);
+}
+
+static inline void state_setBeaconSweep ( bool active, int center, int width, int confidence )
+{
+	state_setBeaconSweep_r(&stateDefault, active, center, width, confidence);
+}
+
+static inline bool state_getBeaconSweep ( int* center, int* width, int* confidence )
+{
+	return state_getBeaconSweep_r(&stateDefault, center, width, confidence);
+}
+
+static inline void state_setYaw ( int value )
+{
+	state_setYaw_r(&stateDefault, value);
+}
+
+static inline int state_getYaw ( void )
+{
+	return state_getYaw_r(&stateDefault);
+}
+
+static inline void state_setSP ( int left, int right )
+{
+	state_setSP_r(&stateDefault, left, right);
+}
+
+static inline void state_getSP ( int* left, int* right )
+{
+	state_getSP_r(&stateDefault, left, right);
+}
 
 
 /* ========================================================================== */
@@ -0,0 +1,194 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/mouse/trail.h
+ *  \brief Breadcrumb trail of the odometry, and return to the start along it.
+ *
+ *  While recording, the positions of the robot are simplified on the fly
+ *   into a few keyframes: a new one is only kept when the way since the
+ *   last one no longer fits in a straight line, within TRAIL_TOL mm. So a
+ *   straight run takes two points whatever its length, and a turn a few.
+ *
+ *  When the robot comes back close to where it already went, the loop in
+ *   between is cut out of the trail. When the trail is full, the keyframe
+ *   that changes it the least is dropped, so memory is bounded however long
+ *   the run is, at the cost of a coarser trail that can cut the corners the
+ *   robot went round.
+ *
+ *  Returning drives the trail backwards, at TRAIL_VEL, following a point
+ *   TRAIL_BLEND mm ahead on it, so the corners are taken as arcs. Both the
+ *   keyframes and the arcs cut the corners a little, so the way out must
+ *   keep some more than TRAIL_TOL mm clear of the obstacles.
+ *
+ *  \code
+ *  mouse_waitStep10ms();
+ *  sensors_update();
+ *  trail_update();
+ *  actuators_update();
+ *  \endcode
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __MOUSE_TRAIL_H__
+#define __MOUSE_TRAIL_H__
+
+
+#include <base.h>
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Number of keyframes kept.
+ */
+#define TRAIL_POINTS     64
+
+/**
+ *  \brief Largest distance (in mm) from the way the robot went to the trail
+ *   kept, and distance from the last keyframe under which positions are
+ *   ignored.
+ */
+#define TRAIL_TOL        20
+#define TRAIL_STEP       50
+
+/**
+ *  \brief Distance (in mm) to an older part of the trail under which the
+ *   loop in between is cut out.
+ *
+ *  Less than the robot width, so there can't be a wall in between.
+ */
+#define TRAIL_LOOP      120
+
+/**
+ *  \brief Velocity (in cm/s) of the return, distance (in mm) ahead on the
+ *   trail of the point followed, and distance (in mm) to the start at which
+ *   it's reached.
+ */
+#define TRAIL_VEL        40
+#define TRAIL_BLEND     100
+#define TRAIL_HOME_DIST  50
+
+
+/* ==========================================================================
+ * Constants
+ */
+
+/**
+ *  \brief Trail states.
+ */
+#define TRAIL_RECORD      0       ///< Recording the way the robot goes
+#define TRAIL_RETURN      1       ///< Driving back to the start
+#define TRAIL_HOME        2       ///< On the start, stopped
+
+
+/* ==========================================================================
+ * Management
+ */
+
+/**
+ *  \brief Initialize the trail module, starting to record from the current
+ *   position.
+ *
+ *  Like the other functions without the _r suffix, only built with
+ *   TRAIL_DEFAULT (see conf.h).
+ */
+void trail_init   ( void );
+
+/**
+ *  \brief Record the current position, or drive back to the start.
+ *
+ *  The pose is the one of sensors_position() and sensors_compass(), so this
+ *   MUST be called after sensors_update(). While returning, the wheels
+ *   velocities are set with actuators_setVel().
+ *
+ *  \returns The trail state.
+ */
+uint trail_update ( void );
+
+/**
+ *  \brief Start returning to the start, from the next update.
+ */
+void trail_return ( void );
+
+
+/* ==========================================================================
+ * Queries
+ */
+
+/**
+ *  \brief Get the keyframes of the trail, from the start.
+ *
+ *  \param xs, ys Locations where up to max keyframes (in mm) are stored.
+ *  \param max    Size of the arrays.
+ *
+ *  \returns The number of keyframes of the trail.
+ */
+uint trail_points ( int* xs, int* ys, uint max );
+
+
+/* ==========================================================================
+ * Reentrant interface
+ */
+
+/**
+ *  \brief State of one instance of the module.
+ *
+ *  The fields are internal to the module, use the functions to access them.
+ */
+typedef struct {
+	int  ptX[TRAIL_POINTS];      // Keyframes (in mm)
+	int  ptY[TRAIL_POINTS];
+	uint n;
+
+	uint state;
+
+	bool coneOn;                 // Directions from the last keyframe that
+	int  coneRef;                //  pass close enough to the positions since
+	int  coneLo;                 //  (in millidegrees, relative to coneRef)
+	int  coneHi;
+	int  lastX;                  // Last position inside the cone
+	int  lastY;
+	int  farX;                   // Farthest position from the keyframe
+	int  farY;
+	int  farD;
+
+	uint seg;                    // Returning along the segment seg to seg - 1
+	int  left;                   // Wheels velocities (in cm/s)
+	int  right;
+} trailCtx;
+
+/**
+ *  \brief Initialize an instance of the module, starting at the given
+ *   position (in mm).
+ */
+void trail_init_r   ( trailCtx* ctx, int x, int y );
+
+/**
+ *  \brief Same as trail_update() for the given instance and robot pose. The
+ *   velocities are provided by trail_getVel_r().
+ *
+ *  \param x, y   The robot position in mm.
+ *  \param degree The robot heading, anticlockwise.
+ */
+uint trail_update_r ( trailCtx* ctx, int x, int y, int degree );
+void trail_return_r ( trailCtx* ctx );
+
+/**
+ *  \brief Wheels velocities (in cm/s) computed by the last update while
+ *   returning.
+ */
+void trail_getVel_r ( const trailCtx* ctx, int* left, int* right );
+
+uint trail_points_r ( const trailCtx* ctx, int* xs, int* ys, uint max );
+
+
+/* ========================================================================== */
+#endif /* __MOUSE_TRAIL_H__ */
@@ -0,0 +1,132 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/util/jobs.h
+ *  \brief Background jobs run in the idle time of the control loop.
+ *
+ *  While mouse_waitStep10ms() (and friends) wait for the next cycle, the
+ *   time left to the tick (TMR2 against PR2) is handed to the registered
+ *   jobs, in turns. Each call gives a job a budget in microseconds, at
+ *   most JOBS_SLICE_US and never closer than JOBS_GUARD_US to the tick.
+ *   The job does some work within the budget, keeping its own state so it
+ *   resumes on the next call, and returns how much it did (in units of its
+ *   own, e.g. bytes sent or nodes expanded), 0 when there's nothing to do.
+ *
+ *  \code
+ *  jobs_add("plan", plan_job, NULL);
+ *  \endcode
+ *
+ *  The binary logger is drained by the "mlog" job, registered by
+ *   mouse_init(). The work and time of each job on the last cycle and
+ *   in total are kept, see jobs_report().
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __UTIL_JOBS_H__
+#define __UTIL_JOBS_H__
+
+
+#include <base.h>
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Maximum number of jobs.
+ */
+#define JOBS_MAX         8
+
+/**
+ *  \brief Time (in microseconds) kept free before the next tick, and
+ *   longest budget given to a job on each call.
+ */
+#define JOBS_GUARD_US  500
+#define JOBS_SLICE_US 2000
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief A job, does some work within budgetUs microseconds.
+ *
+ *  \returns The work done, 0 if there was nothing to do.
+ */
+typedef uint (*jobFunc) ( void* arg, uint budgetUs );
+
+typedef struct {
+	const char* name;
+	jobFunc func;
+	void*   arg;
+
+	uint units;                  // Work and time (in us) on this cycle
+	uint time;
+
+	uint lastUnits;              // Work and time on the last cycle
+	uint lastTime;
+
+	uint totalUnits;
+	uint totalTime;
+	uint cycles;                 // Cycles with some work done
+	uint maxOver;                // Longest run beyond the budget (us)
+} job;
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Remove all the jobs. Called by mouse_init().
+ */
+void jobs_init    ( void );
+
+/**
+ *  \brief Register a job.
+ *
+ *  \returns false if there are already JOBS_MAX jobs.
+ */
+bool jobs_add     ( const char* name, jobFunc func, void* arg );
+
+/**
+ *  \brief Unregister a job.
+ */
+void jobs_remove  ( jobFunc func, void* arg );
+
+/**
+ *  \brief Run the jobs, in turns, for at most slackUs microseconds minus
+ *   JOBS_GUARD_US. Returns when that time is over or all the jobs had
+ *   nothing to do.
+ *
+ *  Called by the mouse module while waiting for the next cycle.
+ *
+ *  \returns The work done by all the jobs.
+ */
+uint jobs_run     ( uint slackUs );
+
+/**
+ *  \brief Close the accounting of a cycle. Called by the mouse module.
+ */
+void jobs_cycle   ( void );
+
+/**
+ *  \brief Registered job number i, NULL if there's no such job.
+ */
+const job* jobs_get ( uint i );
+
+/**
+ *  \brief Print the work and time of each job, on the last cycle and per
+ *   cycle on average.
+ *
+ *  This uses printf, it MUST NOT be called inside the control loop.
+ */
+void jobs_report  ( void );
+
+
+/* ========================================================================== */
+#endif /* __UTIL_JOBS_H__ */
@@ -0,0 +1,167 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/util/mlog.h
+ *  \brief Binary logger.
+ *
+ *  Log calls don't format anything. Each call stores a record with the
+ *   current tick, the message id from inc/mlogfmt.h and its integer
+ *   arguments on a RAM ring buffer, and returns. The buffer is sent to the
+ *   serial port by mlog_drain(), which runs as a background job while
+ *   waiting for the next cycle (see util/jobs.h), and the host decoder
+ *   (tools/mlogdump) turns the records back into text.
+ *
+ *  When the buffer is full the record is dropped and counted. The count is
+ *   logged as MLOG_DROPPED before the next record that fits. Logging never
+ *   blocks.
+ *
+ *  Usage:
+ *
+ *  \code
+ *  mlogInfo(LOG_BORN);
+ *  mlogDebug(LOG_ODO, odoL, odoR);
+ *  \endcode
+ *
+ *  The log functions are not reentrant and MUST NOT be called from
+ *   interrupts.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __UTIL_MLOG_H__
+#define __UTIL_MLOG_H__
+
+
+#include <base.h>
+#include <mlogfmt.h>
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Minimum level logged. Calls below this level are removed at
+ *   compile time.
+ */
+#define MLOG_LEVEL       MLOG_DEBUG
+
+/**
+ *  \brief Size of the ring buffer in words. MUST be a power of 2.
+ */
+#define MLOG_BUF_WORDS   256
+
+
+/* ========================================================================== */
+
+#define MLOG_DEBUG       0
+#define MLOG_INFO        1
+#define MLOG_WARN        2
+#define MLOG_ERROR       3
+
+/**
+ *  \brief Maximum number of arguments of a message.
+ */
+#define MLOG_MAX_ARGS    31
+
+/**
+ *  \brief Byte sent before each record, the decoder uses it to find the
+ *   record boundaries. It is never a valid ASCII character, so text
+ *   printed on the same port can be told apart.
+ */
+#define MLOG_SYNC        0xA5
+
+/*
+ * Record header word:
+ *
+ *  31      16 15 14 13    9 8      0
+ * +----------+-----+-------+--------+
+ * |   tick   |level| nargs | msg id |
+ * +----------+-----+-------+--------+
+ *
+ * Followed by nargs argument words. Words are sent least significant byte
+ *  first.
+ */
+#define MLOG_HDR(tick, level, nargs, id) \
+	(((uint) (tick) << 16) | ((uint) (level) << 14) | ((uint) (nargs) << 9) | (uint) (id))
+
+#define MLOG_HDR_TICK(hdr)   (((hdr) >> 16) & 0xFFFF)
+#define MLOG_HDR_LEVEL(hdr)  (((hdr) >> 14) & 0x3)
+#define MLOG_HDR_NARGS(hdr)  (((hdr) >> 9) & 0x1F)
+#define MLOG_HDR_ID(hdr)     ((hdr) & 0x1FF)
+
+
+/* ========================================================================== */
+
+#define MLOG_FMT(id, fmt) id,
+
+enum {
+	MLOG_FORMATS
+	MLOG_N_FORMATS
+};
+
+#undef MLOG_FMT
+
+
+/* ==========================================================================
+ * Logging
+ */
+
+#define MLOG(level, id, ...)                                                 \
+	do {                                                                     \
+		if ((level) >= MLOG_LEVEL) {                                         \
+			const int mlogArgs_[] = { 0, ##__VA_ARGS__ };                    \
+			mlog_write((level), (id),                                        \
+				sizeof(mlogArgs_) / sizeof(int) - 1, mlogArgs_ + 1);         \
+		}                                                                    \
+	} while (0)
+
+#define mlogDebug(id, ...)   MLOG(MLOG_DEBUG, id, ##__VA_ARGS__)
+#define mlogInfo(id, ...)    MLOG(MLOG_INFO,  id, ##__VA_ARGS__)
+#define mlogWarn(id, ...)    MLOG(MLOG_WARN,  id, ##__VA_ARGS__)
+#define mlogError(id, ...)   MLOG(MLOG_ERROR, id, ##__VA_ARGS__)
+
+/**
+ *  \brief Empty the buffer and reset the dropped records count.
+ */
+void mlog_init    ( void );
+
+/**
+ *  \brief Store a record on the buffer. Use the mlog macros instead.
+ */
+void mlog_write   ( uint level, uint id, uint nargs, const int* args );
+
+/**
+ *  \brief Send buffered bytes while the serial port accepts them.
+ *
+ *  Returns as soon as the port is busy or the buffer is empty.
+ *
+ *  \returns The number of bytes sent.
+ */
+uint mlog_drain   ( void );
+
+/**
+ *  \brief Send the whole buffer, waiting for the serial port. To be used
+ *   before stopping or reseting, never inside the control loop.
+ */
+void mlog_flush   ( void );
+
+/**
+ *  \brief Number of records dropped and not yet reported.
+ */
+uint mlog_dropped ( void );
+
+/**
+ *  \brief Check if a record is partially sent. Other writers of the serial
+ *   port MUST wait for the end of the record.
+ */
+bool mlog_sending ( void );
+
+
+/* ========================================================================== */
+#endif /* __UTIL_MLOG_H__ */
@@ -0,0 +1,128 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/util/prof.h
+ *  \brief Execution time of code regions.
+ *
+ *  A region is delimited by PROF_BEGIN() and PROF_END(), in the same block,
+ *   and is measured with the core timer (20 MHz, 50 ns per count). Each
+ *   region keeps the number of runs, the minimum, average and maximum
+ *   duration, and a histogram with one bucket per power of 2.
+ *
+ *  \code
+ *  PROF_BEGIN(sensors_update);
+ *  sensors_update();
+ *  PROF_END(sensors_update);
+ *  \endcode
+ *
+ *  Regions are listed by prof_regions() after their first run. When PROF
+ *   isn't defined the macros compile to nothing.
+ *
+ *  On the host simulation every run is also written as a Chrome trace event
+ *   to the file in MR_SIM_PROF_TRACE (load it in chrome://tracing or
+ *   Perfetto).
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __UTIL_PROF_H__
+#define __UTIL_PROF_H__
+
+
+#include <base.h>
+#include <detpic32.h>
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Enable the profiling.
+ *
+ *  To active simply remove the #undef directive that follows the #define.
+ */
+#define PROF
+#undef PROF
+
+/**
+ *  \brief Number of histogram buckets, and core timer counts (as a power
+ *   of 2) of the upper limit of the first bucket.
+ *
+ *  With the defaults the first bucket is below 32 counts (1.6 us) and the
+ *   last one is 6.5 ms and above.
+ */
+#define PROF_BUCKETS      12
+#define PROF_FIRST_SHIFT   5
+
+
+/* ========================================================================== */
+
+typedef struct profRegion {
+	const char* name;
+
+	uint  count;
+	uint  min;
+	uint  max;
+	unsigned long long sum;
+
+	uint  hist[PROF_BUCKETS];
+
+	uint  start;
+	struct profRegion* next;
+} profRegion;
+
+
+/* ========================================================================== */
+
+#ifdef PROF
+
+#define PROF_BEGIN(region) \
+	static MR_TLS profRegion prof_##region = { #region }; \
+	prof_##region.start = readCoreTimer()
+
+#define PROF_END(region) \
+	prof_end(&prof_##region, readCoreTimer())
+
+#else
+
+#define PROF_BEGIN(region)
+#define PROF_END(region)
+
+#endif /* PROF */
+
+/**
+ *  \brief Account a run of a region. Use PROF_END() instead.
+ */
+void prof_end ( profRegion* region, uint end );
+
+/**
+ *  \brief First of the regions already run, the others follow on next.
+ */
+const profRegion* prof_regions ( void );
+
+/**
+ *  \brief Average duration of a region, in core timer counts.
+ */
+uint prof_avg    ( const profRegion* region );
+
+/**
+ *  \brief Reset the statistics of all the regions.
+ */
+void prof_reset  ( void );
+
+/**
+ *  \brief Print the statistics of all the regions, in microseconds.
+ *
+ *  This uses printf, it MUST NOT be called inside the control loop.
+ */
+void prof_report ( void );
+
+
+/* ========================================================================== */
+#endif /* __UTIL_PROF_H__ */
@@ -0,0 +1,127 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/util/rec.h
+ *  \brief Record and replay of the robot inputs.
+ *
+ *  While recording, every value read from the hardware by the robot library
+ *   (obstacle and battery ADC, ground bitmap, encoder ticks, beacon and
+ *   buttons) is stored on a journal, in the order it was read, together
+ *   with the cycle boundaries and the velocities set by the application.
+ *   The journal is sent with the log (inc/util/mlog.h) as MLOG_REC records,
+ *   and extracted from the serial port capture with `mlogdump -r`.
+ *
+ *  While replaying, the same reads return the values from the journal
+ *   instead of the hardware, so the sensors and actuators modules go
+ *   through exactly the same states as in the recorded run. The replay is
+ *   done on the host (see sim/replay.c and MR_SIM_REPLAY in sim/inc/sim.h).
+ *
+ *  If the program reads something different from what the journal holds
+ *   (e.g. the code changed the order of the reads), the replay stops and
+ *   the cycle where it diverged is kept.
+ *
+ *  Journal format, one entry per read:
+ *
+ *  \verbatim
+ *  +-----+---+------+
+ *  | bit | 0 | kind |  followed by the values of the kind as zig-zag varints
+ *  +-----+---+------+
+ *     7  6 5  4    0
+ *  \endverbatim
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __UTIL_REC_H__
+#define __UTIL_REC_H__
+
+
+#include <base.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Journal entry kinds.
+ */
+#define REC_CYCLE      0           ///< Cycle boundary, lateness of the cycle in us (1 value)
+#define REC_SENSORS    1           ///< Obstacle, battery ADC and ground (5 values)
+#define REC_ENCODERS   2           ///< Encoder ticks, left and right (2 values)
+#define REC_BEACON     3           ///< Beacon sensor (bit)
+#define REC_START      4           ///< Start button (bit)
+#define REC_STOP       5           ///< Stop button (bit)
+#define REC_VEL        6           ///< actuators_setVel(), left and right (2 values)
+#define REC_END        0x1F        ///< End of the journal (returned by rec_next())
+
+#define REC_TAG(kind, bit)  ((kind) | ((bit) ? 0x80 : 0))
+#define REC_TAG_KIND(tag)   ((tag) & 0x1F)
+#define REC_TAG_BIT(tag)    (((tag) >> 7) & 0x1)
+
+
+/* ==========================================================================
+ * Control
+ */
+
+/**
+ *  \brief Start recording.
+ */
+void rec_record    ( void );
+
+/**
+ *  \brief Start replaying a journal.
+ *
+ *  The journal MUST NOT be changed until the replay is finished.
+ */
+void rec_replay    ( const uchar* journal, uint len );
+
+/**
+ *  \brief Stop recording or replaying.
+ */
+void rec_stop      ( void );
+
+bool rec_replaying ( void );
+
+/**
+ *  \brief Check if the whole journal was replayed.
+ */
+bool rec_done      ( void );
+
+/**
+ *  \brief Check if the replay diverged from the journal.
+ *
+ *  \param cycle Cycle where it diverged, can be NULL.
+ */
+bool rec_diverged  ( uint* cycle );
+
+/**
+ *  \brief Number of cycles recorded or replayed.
+ */
+uint rec_cycles    ( void );
+
+/**
+ *  \brief Kind of the next journal entry to be replayed, or REC_END.
+ */
+uint rec_next      ( void );
+
+
+/* ==========================================================================
+ * Hooks
+ *
+ * Called by the robot library with the values read from the hardware.
+ *  When replaying, the values are replaced by the ones on the journal.
+ */
+
+uint rec_cycle     ( uint late );
+void rec_sensors   ( volatile int* adc );
+void rec_encoders  ( volatile int* left, volatile int* right );
+uint rec_bit       ( uint kind, uint bit );
+void rec_vel       ( int* left, int* right );
+
+
+/* ========================================================================== */
+#endif /* __UTIL_REC_H__ */
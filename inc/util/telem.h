@@ -0,0 +1,143 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/util/telem.h
+ *  \brief Telemetry stream.
+ *
+ *  telem_send() takes a snapshot of the selected fields (raw HAL values,
+ *   actuators, set-points and the filtered sensor values) and sends it as
+ *   one frame. The frame is sent by DMA, so the call only encodes it. If
+ *   the previous frame is still being sent the snapshot is skipped, as it
+ *   is while the control loop overruns (from MOUSE_SHED on, see
+ *   mouse_mode()).
+ *
+ *  Frames are only started between log records, so the telemetry and the
+ *   log (inc/util/mlog.h) can share the serial port.
+ *
+ *  To fit 100 frames per second on 115200 baud, the values are sent as
+ *   variable length integers, and all frames but one every
+ *   TELEM_KEY_PERIOD only carry the difference to the previous frame.
+ *
+ *  Frame (before COBS encoding):
+ *
+ *  \verbatim
+ *  +-----+-------+------+-----------+-------------+---------+
+ *  | seq | flags | tick | mask (*)  | values      | CRC16   |
+ *  | 1   | 1     | 2    | 4         | 1 to 5 each | 2       |
+ *  +-----+-------+------+-----------+-------------+---------+
+ *  (*) only on key frames
+ *  \endverbatim
+ *
+ *  Values are zig-zag varints, in field order, of the value on key frames
+ *   and of the difference to the previous frame otherwise. Multi-byte
+ *   values are little endian, the CRC is CRC-16/CCITT of everything before
+ *   it. The frame is COBS encoded and sent between two 0x00 bytes.
+ *
+ *  The host decoder is tools/telemdump.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __UTIL_TELEM_H__
+#define __UTIL_TELEM_H__
+
+
+#include <base.h>
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Frames between two key frames.
+ */
+#define TELEM_KEY_PERIOD   50
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Fields that can be sent, in frame order, with the column name
+ *   used by the decoder.
+ */
+#define TELEM_FIELDS \
+	TELEM_FIELD(TELEM_RAW_OBST_L,  "raw_obst_l") \
+	TELEM_FIELD(TELEM_RAW_OBST_F,  "raw_obst_f") \
+	TELEM_FIELD(TELEM_RAW_OBST_R,  "raw_obst_r") \
+	TELEM_FIELD(TELEM_RAW_BATTERY, "raw_battery") \
+	TELEM_FIELD(TELEM_RAW_GROUND,  "raw_ground") \
+	TELEM_FIELD(TELEM_RAW_ENC_L,   "raw_enc_l") \
+	TELEM_FIELD(TELEM_RAW_ENC_R,   "raw_enc_r") \
+	TELEM_FIELD(TELEM_VEL_L,       "vel_l") \
+	TELEM_FIELD(TELEM_VEL_R,       "vel_r") \
+	TELEM_FIELD(TELEM_SERVO,       "servo") \
+	TELEM_FIELD(TELEM_LEDS,        "leds") \
+	TELEM_FIELD(TELEM_SP_L,        "sp_l") \
+	TELEM_FIELD(TELEM_SP_R,        "sp_r") \
+	TELEM_FIELD(TELEM_YAW,         "yaw") \
+	TELEM_FIELD(TELEM_OBST_L,      "obst_l") \
+	TELEM_FIELD(TELEM_OBST_F,      "obst_f") \
+	TELEM_FIELD(TELEM_OBST_R,      "obst_r") \
+	TELEM_FIELD(TELEM_GROUND,      "ground") \
+	TELEM_FIELD(TELEM_BEACON,      "beacon") \
+	TELEM_FIELD(TELEM_BEACON_DIR,  "beacon_dir") \
+	TELEM_FIELD(TELEM_ODO_L,       "odo_l") \
+	TELEM_FIELD(TELEM_ODO_R,       "odo_r") \
+	TELEM_FIELD(TELEM_COMPASS,     "compass") \
+	TELEM_FIELD(TELEM_BATTERY,     "battery") \
+	TELEM_FIELD(TELEM_BUMP,        "bump")
+
+#define TELEM_FIELD(id, name) id,
+
+enum {
+	TELEM_FIELDS
+	TELEM_N_FIELDS
+};
+
+#undef TELEM_FIELD
+
+#define TELEM_ALL        ((1u << TELEM_N_FIELDS) - 1)
+
+/**
+ *  \brief Frame flags.
+ */
+#define TELEM_KEY        0x01
+
+/**
+ *  \brief Maximum size of a frame before and after encoding.
+ */
+#define TELEM_FRAME_MAX  (8 + 5 * TELEM_N_FIELDS + 2)
+#define TELEM_WIRE_MAX   (TELEM_FRAME_MAX + TELEM_FRAME_MAX / 254 + 3)
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Select the fields sent and restart the stream with a key frame.
+ *
+ *  \param mask Bitmap of the fields, (1 << TELEM_xxx) or TELEM_ALL.
+ */
+void telem_init    ( uint mask );
+
+/**
+ *  \brief Send a frame with the current values.
+ *
+ *  Call once per cycle, after sensors_update() and actuators_update().
+ */
+void telem_send    ( void );
+
+/**
+ *  \brief Number of frames skipped because the serial port was busy or the
+ *   control loop was overrunning.
+ */
+uint telem_skipped ( void );
+
+
+/* ========================================================================== */
+#endif /* __UTIL_TELEM_H__ */
@@ -0,0 +1,68 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  inc/util/trig.h
+ *  \brief Integer trigonometry.
+ *
+ *  Angles are in millidegrees, anticlockwise, as the rest of the library.
+ *   Sines and cosines are fixed point values scaled by TRIG_ONE, taken
+ *   from a table with one entry per degree and linearly interpolated
+ *   (the error is below 2 / TRIG_ONE).
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __UTIL_TRIG_H__
+#define __UTIL_TRIG_H__
+
+
+#include <base.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Fixed point scale of trig_sin() and trig_cos().
+ */
+#define TRIG_SHIFT  14
+#define TRIG_ONE    (1 << TRIG_SHIFT)
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Sine of an angle (any value), scaled by TRIG_ONE.
+ */
+int trig_sin   ( int mdegree );
+
+/**
+ *  \brief Cosine of an angle (any value), scaled by TRIG_ONE.
+ */
+int trig_cos   ( int mdegree );
+
+/**
+ *  \brief The same angle (any value) in ]-180000, 180000] millidegrees.
+ */
+int trig_norm  ( int mdegree );
+
+/**
+ *  \brief Direction of the vector (x, y), in ]-180000, 180000]
+ *   millidegrees. 0 for the null vector.
+ *
+ *  The error is below 10 millidegrees.
+ */
+int trig_atan2 ( int y, int x );
+
+/**
+ *  \brief Square root, rounded down.
+ */
+uint trig_sqrt ( uint value );
+
+
+/* ========================================================================== */
+#endif /* __UTIL_TRIG_H__ */
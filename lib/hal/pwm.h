@@ -0,0 +1,77 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/hal/pwm.h
+ *  \brief Mapping of the motors velocity and of the servo position to the
+ *   output compare registers.
+ *
+ *  Kept apart from the HAL so the mapping can also be built on the host
+ *   (see bench/).
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __HAL_PWM_H__
+#define __HAL_PWM_H__
+
+
+#include <base.h>
+#include <conf.h>
+#include <hal/robot.h>
+
+
+/* ========================================================================== */
+
+#define T2_FREQ       625 // fin_t2 = 625 kHz
+#define SERVO_LEVELS  (SERVO_POS_RIGHT - SERVO_POS_LEFT)
+#define SERVO_K       ((((SERVO_WIDTH_MAX - SERVO_WIDTH_MIN) * T2_FREQ) / 1000) / SERVO_LEVELS)
+#define SERVO_MIN_PWM_IS_RIGHT
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Duty cycle of a motor, for a velocity in [-100, 100] % and the
+ *   PWM timer period. reverse is set to the direction.
+ */
+static inline uint pwm_motor ( int vel, uint period, bool* reverse )
+{
+	(*reverse) = (vel < 0);
+
+	vel = vel < 0 ? -vel : vel;
+
+	return (period * vel) / 100;
+}
+
+/**
+ *  \brief Servo PWM level (0 at the minimum pulse width) of a servo
+ *   position.
+ */
+static inline int pwm_servoLevel ( int pos )
+{
+	pos = pos < SERVO_POS_LEFT ? SERVO_POS_LEFT : pos;
+	pos = pos > SERVO_POS_RIGHT ? SERVO_POS_RIGHT : pos;
+
+#ifdef SERVO_MIN_PWM_IS_LEFT
+	return pos - SERVO_POS_LEFT;    // PWM is minimum @ left position
+#else
+	return SERVO_POS_RIGHT - pos;   // PWM is minimum @ right position
+#endif
+}
+
+/**
+ *  \brief Servo output compare value (timer 2 counts) of a PWM level.
+ */
+static inline uint pwm_servo ( int level )
+{
+	return ((SERVO_WIDTH_MIN * T2_FREQ) / 1000 + level * SERVO_K) + 1;
+}
+
+
+/* ========================================================================== */
+#endif /* __HAL_PWM_H__ */
@@ -17,8 +17,11 @@
 #include <base.h>
 #include <hal/robot.h>
 #include <conf.h>
+#include <util/rec.h>
 #include <detpic32.h>
 
+#include "pwm.h"
+
 
 /* ========================================================================== */
 
@@ -28,6 +31,11 @@
 #define IN  1
 #define OUT 0
 
+/* ===================
+ * Serial port
+ */
+#define KVA_TO_PA(addr) ((uint) (addr) & 0x1FFFFFFF)  // DMA uses physical addresses
+
 /* ===================
  * Motors
  */
@@ -51,36 +59,62 @@
 #define LED5   LATBbits.LATB15
 
 /* ===================
- * Servo
+ * Interrupts profiling
  */
-#define T2_FREQ       625 // fin_t2 = 625 kHz
-#define SERVO_LEVELS  (SERVO_POS_RIGHT - SERVO_POS_LEFT)
-#define SERVO_K       ((((SERVO_WIDTH_MAX - SERVO_WIDTH_MIN) * T2_FREQ) / 1000) / SERVO_LEVELS)
-#define SERVO_MIN_PWM_IS_RIGHT
+#define T2_TO_CORE    32  // Core timer counts per timer 2 count (20 MHz / 625 kHz)
+
+#ifdef ISR_PROF
+#define ISR_ENTER(isr, latency)  uint isrStart_ = isrEnter(isr, latency)
+#define ISR_EXIT(isr)            isrExit(isr, isrStart_)
+#define CRITICAL_BEGIN()         DisableInterrupts(); uint maskStart_ = readCoreTimer()
+#define CRITICAL_END()           isrMasked(readCoreTimer() - maskStart_); EnableInterrupts()
+#else
+#define ISR_ENTER(isr, latency)
+#define ISR_EXIT(isr)
+#define CRITICAL_BEGIN()         DisableInterrupts()
+#define CRITICAL_END()           EnableInterrupts()
+#endif
 
 
 /* ========================================================================== */
 
-volatile mrSens  sensors;
-volatile mrActs  actuators;
-volatile mrClock ticker;
+volatile MR_TLS mrSens  sensors;
+volatile MR_TLS mrActs  actuators;
+volatile MR_TLS mrClock ticker;
 
 static int counter_m1 = 0;
 static int counter_m2 = 0;
 
+static volatile uint cntT2Ticks = 0;
+
+/* ===================
+ * Interrupts profiling
+ */
+#ifdef ISR_PROF
+static volatile mrIsrStats isrStats[N_ISRS];
+static volatile uint isrPreempted[N_ISRS + 1];  // Time taken by preempting ISRs,
+                                                //  per nesting level (0 = main)
+static volatile uint isrDepth     = 0;
+static volatile uint isrMaxMasked = 0;
+static uint          isrResetTime = 0;
+#endif
+
 
 /* ========================================================================== */
 
 uint getGroundSensors ( void );
 
-int  avfilter_mleft   ( int vel );
-int  avfilter_mright  ( int vel );
-
 void stopMotors       ( void );
 
 void delay ( uint tenth_ms);
 void wait  ( uint tenth_seconds );
 
+#ifdef ISR_PROF
+uint isrEnter  ( uint isr, uint latency );
+void isrExit   ( uint isr, uint start );
+void isrMasked ( uint cycles );
+#endif
+
 
 
 /* ==========================================================================
@@ -205,11 +239,22 @@ void robot_init(void)
 	IEC0bits.INT1IE = 1;        // Enable INT1 interrupts
 	IEC0bits.INT4IE = 1;        // Enable INT4 interrupts
 
+	/* Serial port TX DMA */
+	U1STAbits.UTXISEL = 0;      // UART1 TX event while the buffer has room
+	DMACONbits.ON = 1;          // Enable the DMA controller
+	DCH0CON = 0;                // Channel 0, priority 0, no auto-enable
+	DCH0ECONbits.CHSIRQ = _UART1_TX_IRQ;  // One cell per UART1 TX event
+	DCH0ECONbits.SIRQEN = 1;
+	DCH0DSA  = KVA_TO_PA(&U1TXREG);
+	DCH0DSIZ = 1;               // Destination is a single byte register
+	DCH0CSIZ = 1;               // One byte per event
+
 	/* Reset variables */
 	counter_m1 = 0;             // Reset counters
 	counter_m2 = 0;             //
 
-	ticker.ticks = 0;           // Reset 10ms ticker
+	cntT2Ticks   = 0;           // Reset 10ms ticker
+	ticker.ticks = 0;           //
 }
 
 void inline robot_enableObstSens ( void )
@@ -232,6 +277,46 @@ void inline robot_disableGroundSens ( void )
 	LATEbits.LATE5 = 0;
 }
 
+void inline robot_idle ( void )
+{
+}
+
+
+/* ==========================================================================
+ * Timer and watchdog
+ */
+
+uint robot_ticks ( void )
+{
+	return cntT2Ticks;
+}
+
+uint robot_tickTime ( void )
+{
+	return (TMR2 * 1000) / T2_FREQ;     // TMR2 restarted at the tick
+}
+
+uint robot_tickLeft ( void )
+{
+	return ((PR2 + 1 - TMR2) * 1000) / T2_FREQ;
+}
+
+void robot_wdtEnable ( void )
+{
+	WDTCONbits.WDTCLR = 1;
+	WDTCONbits.ON = 1;          // The period is set by the WDTPS config bits
+}
+
+void robot_wdtClear ( void )
+{
+	WDTCONbits.WDTCLR = 1;
+}
+
+bool robot_wdtReset ( void )
+{
+	return RCONbits.WDTO;
+}
+
 
 /* ==========================================================================
  * Sensors
@@ -254,31 +339,35 @@ void robot_readSensors ( void )
 	}
 
 	sensors.array[4] = getGroundSensors();
+
+	rec_sensors(sensors.array);
 }
 
 void robot_readEncoders ( void )
 {
-	DisableInterrupts();
-	sensors.enc_left  = counter_m1;
-	sensors.enc_right = counter_m2;
+	CRITICAL_BEGIN();
+	sensors.enc_left  = ENC_LEFT_DIR  * counter_m1;
+	sensors.enc_right = ENC_RIGHT_DIR * counter_m2;
 	counter_m1 = 0;
 	counter_m2 = 0;
-	EnableInterrupts();
+	CRITICAL_END();
+
+	rec_encoders(&sensors.enc_left, &sensors.enc_right);
 }
 
 uint inline robot_readBeaconSens ( void )
 {
-	return PORTBbits.RB9;
+	return rec_bit(REC_BEACON, PORTBbits.RB9);
 }
 
 uint inline robot_startBtn ( void )
 {
-	return (!PORTBbits.RB3);
+	return rec_bit(REC_START, !PORTBbits.RB3);
 }
 
 uint inline robot_stopBtn ( void )
 {
-	return (!PORTBbits.RB4);
+	return rec_bit(REC_STOP, !PORTBbits.RB4);
 }
 
 
@@ -288,29 +377,20 @@ uint inline robot_stopBtn ( void )
 
 void robot_setVel2 ( int velL, int velR )
 {
-	DisableInterrupts();
+	CRITICAL_BEGIN();
 
 	actuators.vel_left  = velL > 100 ? 100 : (velL < -100 ? -100 : velL);
 	actuators.vel_right = velR > 100 ? 100 : (velR < -100 ? -100 : velR);
 
-	EnableInterrupts();
+	CRITICAL_END();
 }
 
 void robot_setServo ( int pos )
 {
-#ifdef SERVO_MIN_PWM_IS_LEFT
-	pos = pos < SERVO_POS_LEFT ? SERVO_POS_LEFT : pos;
-	pos = pos > SERVO_POS_RIGHT ? SERVO_POS_RIGHT : pos;
-	pos += -SERVO_POS_LEFT; // PWM is minimum @ left position
-#else
-	pos = pos < SERVO_POS_LEFT ? SERVO_POS_LEFT : pos;
-	pos = pos > SERVO_POS_RIGHT ? SERVO_POS_RIGHT : pos;
-	pos = -pos;
-	pos += SERVO_POS_RIGHT; // PWM is minimum @ right position
-#endif
+	pos = pwm_servoLevel(pos);
 
 	actuators.servo_pos = pos;
-	OC5RS = ((SERVO_WIDTH_MIN * T2_FREQ) / 1000  + pos * SERVO_K) + 1;
+	OC5RS = pwm_servo(pos);
 }
 
 void robot_setLed ( int ledNr )
@@ -332,6 +412,157 @@ void robot_resetLed ( int ledNr )
 }
 
 
+/* ==========================================================================
+ * Serial port
+ */
+
+uint robot_serialPut ( uchar c )
+{
+	if (DCH0CONbits.CHEN || U1STAbits.UTXBF)   // Block being sent or buffer full
+		return 0;
+
+	U1TXREG = c;
+
+	return 1;
+}
+
+uint robot_serialSend ( const uchar* buf, uint len )
+{
+	if (DCH0CONbits.CHEN || len == 0 || len > SERIAL_BLOCK_MAX)
+		return 0;
+
+	DCH0SSA  = KVA_TO_PA(buf);
+	DCH0SSIZ = len;             // 256 is written as 0
+
+	DCH0INTCLR = 0xFF;          // Clear the channel event flags
+	DCH0CONbits.CHEN = 1;       // Disabled by hardware at the end of the block
+	DCH0ECONbits.CFORCE = 1;    // Send the first byte, the UART events do the rest
+
+	return 1;
+}
+
+uint robot_serialBusy ( void )
+{
+	return DCH0CONbits.CHEN;
+}
+
+
+/* ==========================================================================
+ * Interrupts profiling
+ */
+
+#ifdef ISR_PROF
+
+void robot_isrReset ( void )
+{
+	int i;
+
+	DisableInterrupts();
+
+	for (i = 0; i < N_ISRS; i++) {
+		isrStats[i].count       = 0;
+		isrStats[i].maxLatency  = 0;
+		isrStats[i].maxDuration = 0;
+		isrStats[i].preemptions = 0;
+		isrStats[i].busy        = 0;
+	}
+
+	isrMaxMasked = 0;
+	isrResetTime = readCoreTimer();
+
+	EnableInterrupts();
+}
+
+void robot_isrStats ( uint isr, mrIsrStats* stats )
+{
+	if (isr >= N_ISRS || stats == NULL)
+		return;
+
+	DisableInterrupts();
+	(*stats) = isrStats[isr];
+	EnableInterrupts();
+}
+
+uint robot_isrLoad ( void )
+{
+	unsigned long long busy = 0;
+	uint elapsed;
+	int  i;
+
+	DisableInterrupts();
+
+	for (i = 0; i < N_ISRS; i++) {
+		busy += isrStats[i].busy;
+	}
+
+	elapsed = readCoreTimer() - isrResetTime; // Wraps after 214 s
+
+	EnableInterrupts();
+
+	return elapsed ? (uint) (busy * 10000 / elapsed) : 0;
+}
+
+uint robot_isrMaxMasked ( void )
+{
+	return isrMaxMasked;
+}
+
+void robot_isrReport ( void )
+{
+	static const char* names[N_ISRS] = { "isr_t2", "isr_enc_m1", "isr_enc_m2" };
+
+	mrIsrStats stats;
+	uint load = robot_isrLoad();
+	int  i;
+
+	printf("ISR          count  max latency us  max duration us  preemptions\n");
+
+	for (i = 0; i < N_ISRS; i++) {
+		robot_isrStats(i, &stats);
+
+		printf("%-10s %7u  %11u.%02u  %12u.%02u  %11u\n", names[i], stats.count,
+			stats.maxLatency / CORE_US, (stats.maxLatency % CORE_US) * (100 / CORE_US),
+			stats.maxDuration / CORE_US, (stats.maxDuration % CORE_US) * (100 / CORE_US),
+			stats.preemptions);
+	}
+
+	printf("Interrupts disabled for up to %u.%02u us\n", isrMaxMasked / CORE_US, (isrMaxMasked % CORE_US) * (100 / CORE_US));
+	printf("Interrupt load %u.%02u %%\n", load / 100, load % 100);
+}
+
+#else
+
+void robot_isrReset ( void )
+{
+}
+
+void robot_isrStats ( uint isr, mrIsrStats* stats )
+{
+	static const mrIsrStats none;
+
+	if (stats != NULL) {
+		(*stats) = none;
+	}
+}
+
+uint robot_isrLoad ( void )
+{
+	return 0;
+}
+
+uint robot_isrMaxMasked ( void )
+{
+	return 0;
+}
+
+void robot_isrReport ( void )
+{
+	printf("ISR profiling is disabled (ISR_PROF)\n");
+}
+
+#endif /* ISR_PROF */
+
+
 /* ==========================================================================
  * Helper functions
  */
@@ -367,61 +598,71 @@ uint getGroundSensors ( void )
 	return sensValue;
 }
 
-int avfilter_mleft ( int vel )
+/* ===================
+ * delay() - input: value in 1/10 ms
+ */
+void delay ( uint tenth_ms )
 {
-	static int i   = 0;
-	static int sum = 0;
-	static int buf[4] = {0, 0, 0, 0};
+	uint start = readCoreTimer();               // The core timer isn't reset,
+	                                            //  it's used for profiling
+	tenth_ms = tenth_ms > 500000 ? 500000 : tenth_ms;
 
-	sum = sum - buf[i] + vel;
-	buf[i++] = vel;
+	while((readCoreTimer() - start) <= (2000 * tenth_ms));
+}
 
-#ifndef SOFT_SLOPE
-	i &= 0x01;
-	return sum / 2;
-#else
-	i &= 0x03;
-	return sum / 4;
-#endif
+/* ===================
+ * wait() - input: value in 1/10 s
+ */
+void wait ( uint tenth_seconds )
+{
+	while (tenth_seconds--)
+		delay(1000);
 }
 
-int avfilter_mright(int vel)
+
+/* ===================
+ * Interrupts profiling: called on the ISRs entry and exit and at the end
+ *  of each critical section
+ */
+#ifdef ISR_PROF
+uint isrEnter ( uint isr, uint latency )
 {
-	static int i   = 0;
-	static int sum = 0;
-	static int buf[4] = {0, 0, 0, 0};
+	uint now = readCoreTimer();
 
-	sum = sum - buf[i] + vel;
-	buf[i++] = vel;
+	if (isrDepth > 0) {
+		isrStats[isr].preemptions++;
+	}
 
-#ifndef SOFT_SLOPE
-	i &= 0x01;
-	return sum / 2;
-#else
-	i &= 0x03;
-	return sum / 4;
-#endif
+	isrPreempted[++isrDepth] = 0;
+
+	if (latency > isrStats[isr].maxLatency) {
+		isrStats[isr].maxLatency = latency;
+	}
+
+	return now;
 }
 
-/* ===================
- * delay() - input: value in 1/10 ms
- */
-void delay ( uint tenth_ms )
+void isrExit ( uint isr, uint start )
 {
-	tenth_ms = tenth_ms > 500000 ? 500000 : tenth_ms;
+	uint duration = readCoreTimer() - start;
+
+	isrStats[isr].count++;
+	isrStats[isr].busy += duration - isrPreempted[isrDepth];
 
-	resetCoreTimer();
-	while(readCoreTimer() <= (2000 * tenth_ms));
+	if (duration > isrStats[isr].maxDuration) {
+		isrStats[isr].maxDuration = duration;
+	}
+
+	isrPreempted[--isrDepth] += duration;       // Charged to the preempted one
 }
 
-/* ===================
- * wait() - input: value in 1/10 s
- */
-void wait ( uint tenth_seconds )
+void isrMasked ( uint cycles )
 {
-	resetCoreTimer();
-	while(readCoreTimer() <= (2000000 * tenth_seconds ));
+	if (cycles > isrMaxMasked) {
+		isrMaxMasked = cycles;
+	}
 }
+#endif
 
 
 /* ==========================================================================
@@ -433,42 +674,45 @@ void wait ( uint tenth_seconds )
  */
 void _int_(_TIMER_2_VECTOR) isr_t2(void)
 {
-	static int cntT2Ticks = 0;
+	int  velL, velR;
+	bool reverseL, reverseR;
 
-	int velL, velR;
+	ISR_ENTER(ISR_T2, TMR2 * T2_TO_CORE);     // TMR2 restarted at the event
 
 	cntT2Ticks++;
-	ticker.ticks = cntT2Ticks;
+	ticker.ticks |= (cntT2Ticks ^ (cntT2Ticks - 1)) & 0xFF;  // Flags of the periods
+	                                                        //  that divide it
 
 #ifdef SOFT_SLOPE
 	if((cntT2Ticks % 2) == 0)
 #endif
 	{
 		velL = actuators.vel_left;
-//		velL = avfilter_mleft(actuators.vel_left);
 
 		velR = actuators.vel_right;
-//		velR = avfilter_mright(actuators.vel_right);
 
-		if(velL < 0) {
-			velL = -velL;
+		velL = pwm_motor(velL, PR3 + 1, &reverseL);
+		velR = pwm_motor(velR, PR3 + 1, &reverseR);
+
+		if(reverseL) {
 			M1_REVERSE;
 		} else {
 			M1_FORWARD;
 		}
 
-		if(velR < 0) {
-			velR = -velR;
+		if(reverseR) {
 			M2_REVERSE;
 		} else {
 			M2_FORWARD;
 		}
 
-		OC1RS = ((PR3+1)*velL) / 100;
-		OC2RS = ((PR3+1)*velR) / 100;
+		OC1RS = velL;
+		OC2RS = velR;
 	}
 
 	IFS0bits.T2IF = 0;
+
+	ISR_EXIT(ISR_T2);
 }
 
 /* ===================
@@ -476,6 +720,8 @@ void _int_(_TIMER_2_VECTOR) isr_t2(void)
  */
 void _int_(_EXTERNAL_1_VECTOR) isr_enc_m1(void)
 {
+	ISR_ENTER(ISR_ENC_M1, 0);                 // The edge time is unknown
+
 	if(PORTEbits.RE6 == 1)
 		counter_m1++;
 	else
@@ -483,6 +729,7 @@ void _int_(_EXTERNAL_1_VECTOR) isr_enc_m1(void)
 
 	IFS0bits.INT1IF = 0;
 
+	ISR_EXIT(ISR_ENC_M1);
 }
 
 /* ===================
@@ -490,12 +737,16 @@ void _int_(_EXTERNAL_1_VECTOR) isr_enc_m1(void)
  */
 void _int_(_EXTERNAL_4_VECTOR) isr_enc_m2(void)
 {
+	ISR_ENTER(ISR_ENC_M2, 0);                 // The edge time is unknown
+
 	if(PORTEbits.RE7 == 1)
 		counter_m2++;
 	else
 		counter_m2--;
 
 	IFS0bits.INT4IF = 0;
+
+	ISR_EXIT(ISR_ENC_M2);
 }
 
 
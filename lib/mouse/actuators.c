@@ -18,23 +18,78 @@
 #include <conf.h>
 #include <hal/robot.h>
 #include <mouse/state.h>
+#include <mouse/mouse.h>
+#include <util/rec.h>
+#include <util/prof.h>
+#include <util/trig.h>
 
 
-/* ========================================================================== */
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
 
-/* ===================
- * Motors
+/**
+ *  \brief Margin (in degrees) added to each side of the beam when the
+ *   beacon sweep is narrowed around the last known bearing.
+ */
+#define SWEEP_MARGIN       10
+
+/**
+ *  \brief Minimum confidence (in %) for the beacon sweep to be narrowed.
+ */
+#define SWEEP_LOCK_CONF    50
+
+/**
+ *  \brief Disagreement (in degrees) between two consecutive sweep passes
+ *   at which the confidence drops to zero.
+ */
+#define SWEEP_CONF_SPAN    10
+
+/**
+ *  \brief Amplitude (in degrees) of the beacon tracking dithering.
+ *
+ *  Should be at least one servo position wide.
  */
-static int spLeft   = 0;
-static int spRight  = 0;
-static int velLeft  = 0;
-static int velRight = 0;
+#define TRACK_DITHER        6
+
+/**
+ *  \brief Correction (in degrees) applied to the tracked direction when the
+ *   beacon is only seen on one side of the dithering.
+ */
+#define TRACK_STEP          2
+
+/**
+ *  \brief Number of consecutive dithering periods without seeing the beacon
+ *   before tracking falls back to sweeping.
+ */
+#define TRACK_LOST          3
+
+/**
+ *  \brief Gains of the wall following PD controller.
+ *
+ *  The robot turns at (WALL_KP x error + WALL_KD x rate) / vel rad/s, with
+ *   the error to the distance set in mm, its rate of change and the
+ *   velocity in mm/s. The distance then settles as a spring and damper of
+ *   stiffness WALL_KP (1/s^2) and damping WALL_KD (1/s), at any velocity.
+ */
+#define WALL_KP             4
+#define WALL_KD             4
+
+/**
+ *  \brief Distance (in mm from the robot center) of a wall ahead at which the
+ *   robot spins in place, and time (in ms) before getting there at which it
+ *   starts turning away from it, slowing down.
+ */
+#define WALL_STOP         150
+#define WALL_AHEAD        500
+
+
+/* ========================================================================== */
 
 /* ===================
- * Beacon servo
+ * Instance used by the non reentrant interface
  */
-static int servoDegree    = 0;
-static int newServoDegree = 0;
+MR_TLS actuatorsCtx actuatorsDefault;
 
 
 /* ========================================================================== */
@@ -55,38 +110,93 @@ static int newServoDegree = 0;
 #define SERVO_POS_RANGE    (SERVO_POS_RIGHT - SERVO_POS_LEFT)
 
 /**
- *  \brief Convert servo degree to servo position.
+ *  \brief Convert servo degree to servo position (rounded to the nearest).
  */
 #define SERVO_DEGREE_TO_POS(degree) \
-		(int) ((1.0 * SERVO_POS_RANGE / SERVO_DEGREE_RANGE) * degree)
+		(((degree) * SERVO_POS_RANGE + ((degree) < 0 ? -SERVO_DEGREE_RANGE : SERVO_DEGREE_RANGE) / 2) \
+		 / SERVO_DEGREE_RANGE)
 
 /**
- *  \brief Convert servo position to servo degree.
+ *  \brief Convert servo position to servo degree (rounded to the nearest).
  */
 #define SERVO_POS_TO_DEGREE(pos) \
-		(int) (pos / (1.0 * SERVO_POS_RANGE / SERVO_DEGREE_RANGE))
+		(((pos) * SERVO_DEGREE_RANGE + ((pos) < 0 ? -SERVO_POS_RANGE : SERVO_POS_RANGE) / 2) \
+		 / SERVO_POS_RANGE)
+
+/**
+ *  \brief Convert servo position to servo millidegree.
+ */
+#define SERVO_POS_TO_MDEGREE(pos) \
+		(((pos) * SERVO_DEGREE_RANGE * 1000) / SERVO_POS_RANGE)
+
+/**
+ *  \brief Maximum servo rotation per cycle, in millidegrees.
+ */
+#define SERVO_STEP_MDEGREE (SERVO_MAX_SPEED * CICLE_T)
+
+/**
+ *  \brief Number of cycles the servo takes to settle.
+ */
+#define SERVO_SETTLE_CYCLES ((SERVO_SETTLE_T + CICLE_T - 1) / CICLE_T)
 
 
 /* ========================================================================== */
 
-static void motorsUpdate ( void );
-static void servoUpdate  ( void );
-static void motorsPI     ( void );
+static void motorsUpdate ( actuatorsCtx* ctx );
+static void motorsSetVel ( actuatorsCtx* ctx, int left, int right );
+static void wallUpdate   ( actuatorsCtx* ctx );
+static void servoUpdate  ( actuatorsCtx* ctx );
+static void trackUpdate  ( actuatorsCtx* ctx );
+static void sweepUpdate  ( actuatorsCtx* ctx );
+static void sweepStart   ( actuatorsCtx* ctx );
+static void sweepPass    ( actuatorsCtx* ctx, int rise, int fall );
+static void sweepLimits  ( actuatorsCtx* ctx );
+static void motorsPI     ( actuatorsCtx* ctx, int spL, int spR );
+
+static inline int wallRange ( int adc );
 
 
 /* ==========================================================================
  * Management
  */
 
-void actuators_init ( void )
+void actuators_init_r ( actuatorsCtx* ctx, stateCtx* state )
 {
-	spLeft   = 0;
-	spRight  = 0;
-	velLeft  = 0;
-	velRight = 0;
-
-	servoDegree    = 0;
-	newServoDegree = 0;
+	ctx->state = state;
+
+	ctx->spLeft   = 0;
+	ctx->spRight  = 0;
+	ctx->velLeft  = 0;
+	ctx->velRight = 0;
+
+#ifdef PI_SYNC
+	ctx->syncErr  = 0;
+#endif
+
+	ctx->servoDegree    = 0;
+	ctx->newServoDegree = 0;
+	ctx->servoPos       = 0;
+	ctx->servoEstimate  = 0;
+	ctx->servoSettle    = 0;
+
+	ctx->piIntLeft  = 0;
+	ctx->piIntRight = 0;
+
+	ctx->kpLeft  = PI_KP_LEFT;
+	ctx->kiLeft  = PI_KI_LEFT;
+	ctx->kpRight = PI_KP_RIGHT;
+	ctx->kiRight = PI_KI_RIGHT;
+
+	ctx->sweepOn    = false;
+	ctx->sweepWidth = 0;
+	ctx->trackOn    = false;
+	ctx->wallSide   = ACTUATORS_WALL_OFF;
+	ctx->wallState  = ACTUATORS_WALL_LOST;
+	ctx->wallDist   = -1;
+	ctx->wallRate   = 0;
+	ctx->wallLost   = 0;
+
+	actuators_beaconTrack_r(ctx, false);
 
 	robot_setVel2(0, 0);
 
@@ -95,19 +205,31 @@ void actuators_init ( void )
 	actuators_setLeds(0);
 }
 
-void actuators_update ( void )
+void actuators_update_r ( actuatorsCtx* ctx )
 {
 	/// \todo Check if the module was previously initialized.
 
-	motorsUpdate();
-	servoUpdate();
+	PROF_BEGIN(actuators_update);
+
+	wallUpdate(ctx);
+
+	PROF_BEGIN(motorsUpdate);
+	motorsUpdate(ctx);
+	PROF_END(motorsUpdate);
+
+	trackUpdate(ctx);
+	sweepUpdate(ctx);
+	servoUpdate(ctx);
+
+	PROF_END(actuators_update);
 }
 
-void actuators_stop ( void )
+void actuators_stop_r ( actuatorsCtx* ctx )
 {
 	robot_setVel2(0, 0);
 
 	robot_setServo(0);
+	ctx->servoPos = 0;
 
 	actuators_setLeds(0);
 }
@@ -117,51 +239,141 @@ void actuators_stop ( void )
  * Motors
  */
 
-void actuators_setVel ( int left, int right )
+void actuators_setVel_r ( actuatorsCtx* ctx, int left, int right )
 {
-	/* See! You don't even have to think:
-	 *
-	 * vel (cm / s), DPT (um), T (ms)
-	 *
-	 * vel  cm ----- 1 s
-	 * dist mm ----- T ms
-	 *
-	 * dist = ((T x (vel x 10)) / 1000) mm
-	 *
-	 *
-	 * DPT  um ----- 1  tick
-	 * dist mm ----- sp ticks
-	 *
-	 * sp = ((T x vel x 10) / DPT)
-	 *
-	 */
-
-	velLeft  = left;
-	velRight = right;
+	if (ctx->wallSide != ACTUATORS_WALL_OFF)
+		return;
 
-	spLeft   = (CICLE_T * left  * 10) / ENC_DIST_PER_TICK;
-	spRight  = (CICLE_T * right * 10) / ENC_DIST_PER_TICK;
+	motorsSetVel(ctx, left, right);
 }
 
-void actuators_getVel ( int* left, int* right )
+void actuators_getVel_r ( const actuatorsCtx* ctx, int* left, int* right )
 {
 	if (left != NULL) {
-		(*left) = velLeft;
+		(*left) = ctx->velLeft;
 	}
 
 	if (right != NULL) {
-		(*right) = velRight;
+		(*right) = ctx->velRight;
+	}
+}
+
+void actuators_setPIGains_r ( actuatorsCtx* ctx, int kpL, int kiL, int kpR, int kiR )
+{
+	ctx->kpLeft  = kpL;
+	ctx->kiLeft  = kiL;
+	ctx->kpRight = kpR;
+	ctx->kiRight = kiR;
+}
+
+void actuators_getPIGains_r ( const actuatorsCtx* ctx, int* kpL, int* kiL, int* kpR, int* kiR )
+{
+	if (kpL != NULL) {
+		(*kpL) = ctx->kpLeft;
+	}
+
+	if (kiL != NULL) {
+		(*kiL) = ctx->kiLeft;
+	}
+
+	if (kpR != NULL) {
+		(*kpR) = ctx->kpRight;
+	}
+
+	if (kiR != NULL) {
+		(*kiR) = ctx->kiRight;
+	}
+}
+
+void actuators_setBeaconSens_r ( actuatorsCtx* ctx, int degree )
+{
+	if (ctx->sweepOn || ctx->trackOn)
+		return;
+
+	ctx->newServoDegree = degree;
+}
+
+void actuators_rotateBeaconSens_r ( actuatorsCtx* ctx, int degree )
+{
+	actuators_setBeaconSens_r(ctx, ctx->servoDegree + degree);
+}
+
+void actuators_beaconSweep_r ( actuatorsCtx* ctx, bool enable )
+{
+	ctx->trackOn = false;
+
+	if (enable && !ctx->sweepOn) {
+		sweepStart(ctx);
+	}
+
+	ctx->sweepOn = enable;
+
+	state_setBeaconSweep_r(ctx->state, ctx->sweepOn, 0, 0, 0);
+}
+
+void actuators_beaconTrack_r ( actuatorsCtx* ctx, bool enable )
+{
+	if (enable && !ctx->trackOn) {
+		if (ctx->sweepOn && ctx->sweepConf >= SWEEP_LOCK_CONF) {
+			ctx->trackAngle = ctx->sweepCenter;
+			ctx->trackConf  = ctx->sweepConf;
+		} else {
+			ctx->trackAngle = SERVO_POS_TO_MDEGREE(ctx->servoPos);
+			ctx->trackConf  = SWEEP_LOCK_CONF;
+		}
+
+		ctx->trackSide = -1;
+		ctx->trackHits = 0;
+		ctx->trackMiss = 0;
 	}
+
+	ctx->trackOn = enable;
+	ctx->sweepOn = false;
+
+	state_setBeaconSweep_r(ctx->state, ctx->trackOn,
+			(ctx->trackAngle + (ctx->trackAngle < 0 ? -500 : 500)) / 1000,
+			(ctx->sweepWidth + 500) / 1000,
+			ctx->trackConf);
 }
 
-void actuators_setBeaconSens ( int degree )
+void actuators_wallFollow_r ( actuatorsCtx* ctx, uint side, int dist, int vel )
 {
-	newServoDegree = degree;
+	if (side != ctx->wallSide) {
+		ctx->wallState = ACTUATORS_WALL_LOST;
+		ctx->wallDist  = -1;
+		ctx->wallRate  = 0;
+		ctx->wallLost  = 0;
+	}
+
+	ctx->wallSide = side;
+	ctx->wallSP   = dist * 10;
+	ctx->wallVel  = vel;
+
+	if (side == ACTUATORS_WALL_OFF) {
+		motorsSetVel(ctx, 0, 0);
+	}
 }
 
-void actuators_rotateBeaconSens ( int degree )
+uint actuators_wallState_r ( const actuatorsCtx* ctx, int* dist )
 {
-	actuators_setBeaconSens(servoDegree + degree);
+	if (dist != NULL) {
+		(*dist) = ctx->wallDist;
+	}
+
+	return ctx->wallState;
+}
+
+void actuators_getBeaconSens_r ( const actuatorsCtx* ctx, int* degree )
+{
+	int pos;
+
+	pos = SERVO_DEGREE_TO_POS(ctx->newServoDegree);
+	pos = pos < SERVO_POS_LEFT  ? SERVO_POS_LEFT  : pos;
+	pos = pos > SERVO_POS_RIGHT ? SERVO_POS_RIGHT : pos;
+
+	if (degree != NULL) {
+		(*degree) = SERVO_POS_TO_DEGREE(pos);
+	}
 }
 
 bool actuators_setLed ( uint ledN, bool state )
@@ -195,47 +407,437 @@ void actuators_setLeds ( uint bitmap )
 
 /* ========================================================================== */
 
-static void motorsUpdate ( void )
+static void motorsUpdate ( actuatorsCtx* ctx )
 {
-	motorsPI();
-	state_setSP(spLeft, spRight);
+	int spL = ctx->spLeft;
+	int spR = ctx->spRight;
+
+	switch (mouse_mode()) {
+	case MOUSE_SAFE:
+		ctx->piIntLeft  = 0;
+		ctx->piIntRight = 0;
+
+		robot_setVel2(0, 0);
+		state_setSP_r(ctx->state, 0, 0);
+		return;
+
+	case MOUSE_SLOW:
+		spL = (spL * OVERRUN_SLOW_VEL) / 100;
+		spR = (spR * OVERRUN_SLOW_VEL) / 100;
+		break;
+	}
+
+	motorsPI(ctx, spL, spR);
+	state_setSP_r(ctx->state, spL, spR);
 }
 
-static void servoUpdate ( void )
+static void motorsSetVel ( actuatorsCtx* ctx, int left, int right )
 {
-	int pos;
-	int effectiveDegree;
+	/* See! You don't even have to think:
+	 *
+	 * vel (cm / s), DPT (um), T (ms)
+	 *
+	 * vel  cm ----- 1 s
+	 * dist mm ----- T ms
+	 *
+	 * dist = ((T x (vel x 10)) / 1000) mm
+	 *
+	 *
+	 * DPT  um ----- 1  tick
+	 * dist mm ----- sp ticks
+	 *
+	 * sp = ((T x vel x 10) / DPT)
+	 *
+	 */
+
+	ctx->velLeft  = left;
+	ctx->velRight = right;
+
+	ctx->spLeft   = (CICLE_T * left  * 10) / ENC_DIST_PER_TICK;
+	ctx->spRight  = (CICLE_T * right * 10) / ENC_DIST_PER_TICK;
+}
+
+/* ===================
+ * Wall following
+ *
+ * The side sensor sees the wall OBST_ANGLE degrees ahead, its reading
+ *  projected on the perpendicular is the distance to a wall parallel to the
+ *  robot. When the robot heads towards the wall the reading gets shorter
+ *  sooner, which the derivative term takes as the robot getting closer.
+ *
+ * A reading farther than twice the distance set is taken as no wall. The
+ *  beam left the end of the wall that far ahead of the robot, so it goes
+ *  straight that far and then turns on a circle of that radius, round the
+ *  end of the wall.
+ */
+static void wallUpdate ( actuatorsCtx* ctx )
+{
+	int range, front, dist, rate, vel, turn, away, ahead, outer;
+
+	if (ctx->wallSide == ACTUATORS_WALL_OFF)
+		return;
+
+	range = wallRange(ctx->wallSide == ACTUATORS_WALL_LEFT ? sensors.obst_sens_left : sensors.obst_sens_right);
+	front = wallRange(sensors.obst_sens_front);
+	dist  = range < 0 ? -1 : (range * trig_sin(OBST_ANGLE * 1000)) >> TRIG_SHIFT;
+	dist  = dist > 2 * ctx->wallSP ? -1 : dist;
+	vel   = ctx->wallVel;
+
+	if (dist < 0) {
+		ctx->wallState = ACTUATORS_WALL_LOST;
+		ctx->wallRate  = 0;
+		ctx->wallLost += (vel * 10 * CICLE_T) / 1000;
+
+		/* The end of the wall is still ahead, as far as the distance set */
+		if (ctx->wallLost < ctx->wallSP) {
+			turn = 0;
+		} else {
+			turn = (vel * WHEEL_BASE) / (ctx->wallSP > 0 ? ctx->wallSP : 1);
+		}
+	} else {
+		ctx->wallLost = 0;
+		rate = ctx->wallDist < 0 ? 0 : ((dist - ctx->wallDist) * 1000) / CICLE_T;
+
+		ctx->wallState = ACTUATORS_WALL_TRACK;
+		ctx->wallRate += (rate - ctx->wallRate) / 4;
+		turn = ((WALL_KP * (dist - ctx->wallSP) + WALL_KD * ctx->wallRate) * WHEEL_BASE) /
+			(100 * (vel > 0 ? vel : 1));
+	}
+
+	ctx->wallDist = dist;
+
+	/* Wall ahead: slow down and turn away, spinning at the closest, unless
+	 *  the side one already turns away more */
+	ahead = WALL_STOP + (vel * 10 * WALL_AHEAD) / 1000;
+
+	if (front >= 0 && front < ahead) {
+		away = (vel * (ahead - front)) / (ahead - WALL_STOP);
+		away = away > vel ? vel : away;
+
+		ctx->wallState = ACTUATORS_WALL_CORNER;
+		vel  -= away;
+		turn  = turn < -2 * away ? turn : -2 * away;
+	}
 
-	pos = SERVO_DEGREE_TO_POS(newServoDegree);
-	effectiveDegree = SERVO_POS_TO_DEGREE(pos);
+	turn = turn >  2 * ctx->wallVel ?  2 * ctx->wallVel : turn;
+	turn = turn < -2 * ctx->wallVel ? -2 * ctx->wallVel : turn;
 
-	servoDegree = newServoDegree;
+	/* Slow down on the same curve so the outer wheel doesn't go faster than
+	 *  the velocity set, which may be the fastest the robot goes */
+	outer = vel + abs(turn) / 2;
 
-	robot_setServo(pos);
-	state_setServoDegree(effectiveDegree);
+	if (outer > ctx->wallVel) {
+		vel  = (vel  * ctx->wallVel) / outer;
+		turn = (turn * ctx->wallVel) / outer;
+	}
+
+	/* Positive turns towards the wall */
+	if (ctx->wallSide == ACTUATORS_WALL_LEFT) {
+		motorsSetVel(ctx, vel - turn / 2, vel + turn / 2);
+	} else {
+		motorsSetVel(ctx, vel + turn / 2, vel - turn / 2);
+	}
+}
+
+/* ===================
+ * Distance (in mm) from the robot center to what an obstacle sensor sees,
+ *  -1 if out of range. Same model as the sensors module, adc = OBST_K / (d + 1)
+ *  with d in cm, at mm resolution.
+ */
+static inline int wallRange ( int adc )
+{
+	if (adc <= OBST_K / (OBST_RANGE + 1))
+		return -1;
+
+	return OBST_OFFSET + (OBST_K * 10 + adc / 2) / adc - 10;
 }
 
-static void motorsPI ( void )
+/* ===================
+ * Beacon tracking
+ *
+ * The tracked direction is compensated every cycle by the robot rotation
+ *  measured by odometry, and the servo dithers around it. When the beacon is
+ *  only seen on one side the direction is corrected towards it. If the
+ *  beacon is lost the sweep is used to find it again.
+ */
+static void trackUpdate ( actuatorsCtx* ctx )
 {
-	static int intL = 0;
-	static int intR = 0;
+	int target;
+
+	if (!ctx->trackOn)
+		return;
+
+	/* The robot rotating anticlockwise moves the beacon clockwise */
+	ctx->trackAngle += state_getYaw_r(ctx->state);
+
+	if (ctx->sweepOn) {
+		if (ctx->sweepConf < SWEEP_LOCK_CONF)
+			return;
 
+		ctx->sweepOn    = false;
+		ctx->trackAngle = ctx->sweepCenter;
+		ctx->trackConf  = ctx->sweepConf;
+		ctx->trackSide  = -1;
+		ctx->trackHits  = 0;
+		ctx->trackMiss  = 0;
+	}
+
+	target = SERVO_DEGREE_TO_POS((ctx->trackAngle + ctx->trackSide * TRACK_DITHER * 1000) / 1000);
+	target = target < SERVO_POS_LEFT  ? SERVO_POS_LEFT  : target;
+	target = target > SERVO_POS_RIGHT ? SERVO_POS_RIGHT : target;
+
+	if (ctx->servoPos == target && ctx->servoSettle >= SERVO_SETTLE_CYCLES) {
+		if (robot_readBeaconSens()) {
+			ctx->trackHits |= (ctx->trackSide > 0 ? 2 : 1);
+		}
+
+		/* Both sides visited */
+		if (ctx->trackSide > 0) {
+			if (ctx->trackHits == 0) {
+				ctx->trackConf = (ctx->trackConf * 2) / 3;
+
+				if (++ctx->trackMiss >= TRACK_LOST) {
+					sweepStart(ctx);
+					ctx->sweepOn = true;
+					return;
+				}
+			} else {
+				ctx->trackMiss = 0;
+				ctx->trackConf = 100;
+
+				if (ctx->trackHits == 1) {
+					ctx->trackAngle -= TRACK_STEP * 1000;
+				} else if (ctx->trackHits == 2) {
+					ctx->trackAngle += TRACK_STEP * 1000;
+				}
+			}
+
+			ctx->trackHits = 0;
+		}
+
+		ctx->trackSide = -ctx->trackSide;
+	}
+
+	ctx->trackAngle = ctx->trackAngle < SERVO_DEGREE_MIN * 1000 ? SERVO_DEGREE_MIN * 1000 : ctx->trackAngle;
+	ctx->trackAngle = ctx->trackAngle > SERVO_DEGREE_MAX * 1000 ? SERVO_DEGREE_MAX * 1000 : ctx->trackAngle;
+
+	ctx->newServoDegree = (ctx->trackAngle + ctx->trackSide * TRACK_DITHER * 1000) / 1000;
+
+	state_setBeaconSweep_r(ctx->state, true,
+			(ctx->trackAngle + (ctx->trackAngle < 0 ? -500 : 500)) / 1000,
+			(ctx->sweepWidth + 500) / 1000,
+			ctx->trackConf);
+}
+
+/* ===================
+ * Beacon sweep
+ *
+ * The servo is moved from one limit to the other at full speed. The beacon
+ *  sensor is sampled every cycle together with the estimated servo angle,
+ *  and each edge is placed half way between the angles of the samples
+ *  before and after it. The beam center and width of one pass are biased in
+ *  the direction of the rotation (sensor and servo lag), so the reported
+ *  values are the average of two consecutive passes, in opposite directions.
+ */
+static void sweepUpdate ( actuatorsCtx* ctx )
+{
+	bool beacon;
+	int  angle;
+	int  end;
+
+	if (!ctx->sweepOn)
+		return;
+
+	beacon = robot_readBeaconSens();
+	angle  = ctx->servoEstimate;
+
+	if (beacon && !ctx->sweepBeacon) {
+		ctx->sweepRise   = (ctx->sweepAngle + angle) / 2;
+		ctx->sweepInBeam = true;
+	} else if (!beacon && ctx->sweepBeacon && ctx->sweepInBeam) {
+		sweepPass(ctx, ctx->sweepRise, (ctx->sweepAngle + angle) / 2);
+		ctx->sweepInBeam = false;
+	}
+
+	ctx->sweepBeacon = beacon;
+	ctx->sweepAngle  = angle;
+
+	/* Reverse at the end of the pass */
+	end = (ctx->sweepDir > 0 ? ctx->sweepRight : ctx->sweepLeft);
+
+	if (ctx->servoPos == end && ctx->servoEstimate == SERVO_POS_TO_MDEGREE(end)) {
+		if (!ctx->sweepSeen) {
+			ctx->sweepLast   = false;
+			ctx->sweepConf  /= 2;
+		}
+
+		ctx->sweepInBeam = false;
+		ctx->sweepSeen   = false;
+		ctx->sweepDir    = -ctx->sweepDir;
+
+		sweepLimits(ctx);
+
+		ctx->newServoDegree = SERVO_POS_TO_DEGREE(ctx->sweepDir > 0 ? ctx->sweepRight : ctx->sweepLeft);
+
+		state_setBeaconSweep_r(ctx->state, true,
+				(ctx->sweepCenter + (ctx->sweepCenter < 0 ? -500 : 500)) / 1000,
+				(ctx->sweepWidth + 500) / 1000,
+				ctx->sweepConf);
+	}
+}
+
+static void sweepStart ( actuatorsCtx* ctx )
+{
+	ctx->sweepDir    = 1;
+	ctx->sweepLeft   = SERVO_POS_LEFT;
+	ctx->sweepRight  = SERVO_POS_RIGHT;
+	ctx->sweepBeacon = false;
+	ctx->sweepAngle  = ctx->servoEstimate;
+	ctx->sweepInBeam = false;
+	ctx->sweepSeen   = false;
+	ctx->sweepLast   = false;
+	ctx->sweepCenter = 0;
+	ctx->sweepWidth  = 0;
+	ctx->sweepConf   = 0;
+
+	ctx->newServoDegree = SERVO_POS_TO_DEGREE(ctx->sweepRight);
+}
+
+static void sweepPass ( actuatorsCtx* ctx, int rise, int fall )
+{
+	int center;
+	int width;
+	int diff;
+
+	center = (rise + fall) / 2;
+	width  = abs(fall - rise);
+
+	if (ctx->sweepLast) {
+		diff = abs(center - ctx->sweepLastC);
+
+		ctx->sweepCenter = (center + ctx->sweepLastC) / 2;
+		ctx->sweepWidth  = (width + ctx->sweepLastW) / 2;
+		ctx->sweepConf   = 100 - (diff * 100) / (SWEEP_CONF_SPAN * 1000);
+		ctx->sweepConf   = ctx->sweepConf < 0 ? 0 : ctx->sweepConf;
+	} else {
+		ctx->sweepCenter = center;
+		ctx->sweepWidth  = width;
+		ctx->sweepConf   = SWEEP_LOCK_CONF / 2;   // Not enough to lock yet
+	}
+
+	ctx->sweepLast  = true;
+	ctx->sweepLastC = center;
+	ctx->sweepLastW = width;
+	ctx->sweepSeen  = true;
+
+	state_setBeaconSweep_r(ctx->state, true,
+			(ctx->sweepCenter + (ctx->sweepCenter < 0 ? -500 : 500)) / 1000,
+			(ctx->sweepWidth + 500) / 1000,
+			ctx->sweepConf);
+}
+
+/* ===================
+ * Narrow the sweep around the beam once locked, widen it when lost.
+ */
+static void sweepLimits ( actuatorsCtx* ctx )
+{
+	int half;
+
+	if (ctx->sweepConf < SWEEP_LOCK_CONF) {
+		ctx->sweepLeft  = SERVO_POS_LEFT;
+		ctx->sweepRight = SERVO_POS_RIGHT;
+		return;
+	}
+
+	half = (ctx->sweepWidth / 2 + SWEEP_MARGIN * 1000) / 1000;
+
+	ctx->sweepLeft  = SERVO_DEGREE_TO_POS((ctx->sweepCenter / 1000) - half) - 1;
+	ctx->sweepRight = SERVO_DEGREE_TO_POS((ctx->sweepCenter / 1000) + half) + 1;
+
+	ctx->sweepLeft  = ctx->sweepLeft  < SERVO_POS_LEFT  ? SERVO_POS_LEFT  : ctx->sweepLeft;
+	ctx->sweepRight = ctx->sweepRight > SERVO_POS_RIGHT ? SERVO_POS_RIGHT : ctx->sweepRight;
+}
+
+/* ===================
+ * The servo has no position feedback, so its true position is estimated
+ *  assuming it rotates at SERVO_MAX_SPEED towards the target and then needs
+ *  SERVO_SETTLE_T to settle. The estimate published is the one for the
+ *  next cycle, when the sensors depending on it will be read.
+ */
+static void servoUpdate ( actuatorsCtx* ctx )
+{
+	int pos;
+	int target;
+
+	pos = SERVO_DEGREE_TO_POS(ctx->newServoDegree);
+	pos = pos < SERVO_POS_LEFT  ? SERVO_POS_LEFT  : pos;
+	pos = pos > SERVO_POS_RIGHT ? SERVO_POS_RIGHT : pos;
+
+	ctx->servoDegree = ctx->newServoDegree;
+
+	if (pos != ctx->servoPos) {
+		ctx->servoPos = pos;
+		robot_setServo(pos);
+	}
+
+	target = SERVO_POS_TO_MDEGREE(pos);
+
+	if (ctx->servoEstimate < target - SERVO_STEP_MDEGREE) {
+		ctx->servoEstimate += SERVO_STEP_MDEGREE;
+		ctx->servoSettle    = 0;
+	} else if (ctx->servoEstimate > target + SERVO_STEP_MDEGREE) {
+		ctx->servoEstimate -= SERVO_STEP_MDEGREE;
+		ctx->servoSettle    = 0;
+	} else {
+		if (ctx->servoEstimate != target) {
+			ctx->servoEstimate = target;
+			ctx->servoSettle   = 0;
+		}
+
+		if (ctx->servoSettle < SERVO_SETTLE_CYCLES) {
+			ctx->servoSettle++;
+		}
+	}
+
+	state_setServoDegree_r(ctx->state, (ctx->servoEstimate + (ctx->servoEstimate < 0 ? -500 : 500)) / 1000);
+	state_setServoSettled_r(ctx->state, ctx->servoSettle >= SERVO_SETTLE_CYCLES);
+}
+
+static void motorsPI ( actuatorsCtx* ctx, int spL, int spR )
+{
 	int encL, encR;
 	int errL, errR;
+	int sync = 0;
+
+	/* The set-points are per tick, a late cycle counted more ticks */
+	encL = mouse_perTick(sensors.enc_left);
+	encR = mouse_perTick(sensors.enc_right);
+
+	errL = spL - encL;
+	errR = spR - encR;
 
-	encL = sensors.enc_left;
-	encR = sensors.enc_right;
+	ctx->piIntLeft += errL;
+	ctx->piIntRight += errR;
 
-	errL = spLeft  - encL;
-	errR = spRight - encR;
+	ctx->piIntLeft = (ctx->piIntLeft > PI_LIMIT ? PI_LIMIT : (ctx->piIntLeft < -PI_LIMIT ? -PI_LIMIT : ctx->piIntLeft));
+	ctx->piIntRight = (ctx->piIntRight > PI_LIMIT ? PI_LIMIT : (ctx->piIntRight < -PI_LIMIT ? -PI_LIMIT : ctx->piIntRight));
 
-	intL += errL;
-	intR += errR;
+#ifdef PI_SYNC
+	/* Integrated error between the distance traveled by the left wheel
+	 * relatively to the right one and the commanded difference.
+	 * Positive means the left wheel is ahead.
+	 */
+	if (spL == 0 && spR == 0) {
+		ctx->syncErr = 0;
+	} else {
+		ctx->syncErr += (encL - encR) - (spL - spR);
+		ctx->syncErr  = (ctx->syncErr > PI_SYNC_LIMIT ? PI_SYNC_LIMIT : (ctx->syncErr < -PI_SYNC_LIMIT ? -PI_SYNC_LIMIT : ctx->syncErr));
+	}
 
-	intL = (intL > PI_LIMIT ? PI_LIMIT : (intL < -PI_LIMIT ? -PI_LIMIT : intL));
-	intR = (intR > PI_LIMIT ? PI_LIMIT : (intR < -PI_LIMIT ? -PI_LIMIT : intR));
+	sync = PI_SYNC_K * ctx->syncErr;
+#endif
 
-	robot_setVel2((PI_KP * errL) + (PI_KI * intL), (PI_KP * errR) + (PI_KP * intR));
+	robot_setVel2((ctx->kpLeft * errL) + (ctx->kiLeft * ctx->piIntLeft) - sync, (ctx->kpRight * errR) + (ctx->kiRight * ctx->piIntRight) + sync);
 }
 
 
@@ -0,0 +1,429 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/mouse/avoid.c
+ *  \brief Implement the reactive obstacle avoidance.
+ *
+ *  The obstacles are kept as points in the frame of sensors_position(), so
+ *   the ones of past places stay where they were while the robot moves or
+ *   turns. The histogram is built again, relative to the heading, on each
+ *   update.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/avoid.h>
+#include <conf.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <util/trig.h>
+
+
+/* ========================================================================== */
+
+#define DENSITY_MAX  0xFFFF
+
+/**
+ *  \brief Weights of the distance of a direction to the goal, to the
+ *   heading and to the last direction taken.
+ */
+#define COST_GOAL    5
+#define COST_HEADING 2
+#define COST_LAST    2
+
+/**
+ *  \brief Distance (in mm) between the entries of the widths table.
+ */
+#define WIDTH_STEP   10
+#define WIDTH_LEN    ((AVOID_RANGE - AVOID_RADIUS) / WIDTH_STEP + 1)
+
+
+/* ===================
+ * Instance used by the non reentrant interface
+ */
+#ifdef AVOID_DEFAULT
+static MR_TLS avoidCtx avoidDefault;
+#endif
+
+/* ===================
+ * Angle (in millidegrees) the robot takes at AVOID_RADIUS + i * WIDTH_STEP
+ *  mm, asin(radius / dist). Built by avoid_init_r().
+ */
+static MR_TLS int widths[WIDTH_LEN];
+
+
+/* ========================================================================== */
+
+static void addReadings ( avoidCtx* ctx, int x, int y, int degree );
+static void buildHist   ( avoidCtx* ctx, int x, int y, int degree );
+static int  choose      ( avoidCtx* ctx, int goal, int last );
+static void setVel      ( avoidCtx* ctx, int dir );
+
+static inline int sector     ( int mdegree );
+static inline int sectorDist ( int a, int b );
+
+
+/* ==========================================================================
+ * Management
+ */
+
+void avoid_init_r ( avoidCtx* ctx )
+{
+	int i, d;
+
+	for (i = 0; i < AVOID_POINTS; i++) {
+		ctx->ptValid[i] = false;
+	}
+
+	for (i = 0; i < WIDTH_LEN; i++) {
+		d = AVOID_RADIUS + i * WIDTH_STEP;
+		widths[i] = trig_atan2(AVOID_RADIUS, trig_sqrt(d * d - AVOID_RADIUS * AVOID_RADIUS));
+	}
+	widths[0] = 90000;
+
+	for (i = 0; i < AVOID_SECTORS; i++) {
+		ctx->density[i] = 0;
+		ctx->blocked[i] = false;
+	}
+
+	ctx->place    = 0;
+	ctx->placeX   = 0;
+	ctx->placeY   = 0;
+	ctx->placeDeg = 0;
+
+	ctx->state     = AVOID_GOAL;
+	ctx->direction = 0;
+	ctx->vel       = AVOID_VEL;
+	ctx->left      = 0;
+	ctx->right     = 0;
+}
+
+void avoid_setVel_r ( avoidCtx* ctx, int vel )
+{
+	ctx->vel = vel;
+}
+
+uint avoid_update_r ( avoidCtx* ctx, int x, int y, int degree, int goal )
+{
+	int dir;
+
+	addReadings(ctx, x, y, degree);
+	buildHist(ctx, x, y, degree);
+
+	dir = choose(ctx, trig_norm((goal - degree) * 1000) / 1000,
+		trig_norm((ctx->direction - degree) * 1000) / 1000);
+
+	setVel(ctx, dir);
+
+	ctx->direction = trig_norm((degree + dir) * 1000) / 1000;
+
+	return ctx->state;
+}
+
+#ifdef AVOID_DEFAULT
+
+void avoid_init ( void )
+{
+	avoid_init_r(&avoidDefault);
+}
+
+void avoid_setVel ( int vel )
+{
+	avoid_setVel_r(&avoidDefault, vel);
+}
+
+uint avoid_update ( int goal )
+{
+	int  x, y, left, right;
+	uint state;
+
+	sensors_position(&x, &y);
+
+	state = avoid_update_r(&avoidDefault, x, y, sensors_compass(), goal);
+
+	avoid_getVel_r(&avoidDefault, &left, &right);
+	actuators_setVel(left, right);
+
+	return state;
+}
+
+#endif /* AVOID_DEFAULT */
+
+
+/* ==========================================================================
+ * Queries
+ */
+
+void avoid_getVel_r ( const avoidCtx* ctx, int* left, int* right )
+{
+	if (left != NULL) {
+		(*left) = ctx->left;
+	}
+
+	if (right != NULL) {
+		(*right) = ctx->right;
+	}
+}
+
+int avoid_direction_r ( const avoidCtx* ctx )
+{
+	return ctx->direction;
+}
+
+uint avoid_density_r ( const avoidCtx* ctx, int degree )
+{
+	return ctx->density[sector(degree * 1000)];
+}
+
+bool avoid_blocked_r ( const avoidCtx* ctx, int degree )
+{
+	return ctx->blocked[sector(degree * 1000)];
+}
+
+#ifdef AVOID_DEFAULT
+
+int avoid_direction ( void )
+{
+	return avoid_direction_r(&avoidDefault);
+}
+
+uint avoid_density ( int degree )
+{
+	return avoid_density_r(&avoidDefault, degree);
+}
+
+bool avoid_blocked ( int degree )
+{
+	return avoid_blocked_r(&avoidDefault, degree);
+}
+
+#endif /* AVOID_DEFAULT */
+
+
+/* ==========================================================================
+ * Private functions
+ */
+
+/* ===================
+ * Keep the obstacles seen by the sensors on the current place, moving to
+ *  the next place when the robot went far enough.
+ */
+static void addReadings ( avoidCtx* ctx, int x, int y, int degree )
+{
+	int obst[3];
+	int i, j, dist, mdegree;
+
+	if (abs(x - ctx->placeX) + abs(y - ctx->placeY) >= AVOID_STEP ||
+	    abs(trig_norm((degree - ctx->placeDeg) * 1000)) / 1000 >= AVOID_STEP_DEG) {
+		ctx->place    = (ctx->place + 1) % AVOID_HISTORY;
+		ctx->placeX   = x;
+		ctx->placeY   = y;
+		ctx->placeDeg = degree;
+	}
+
+	obst[0] = sensors_obstR();
+	obst[1] = sensors_obstF();
+	obst[2] = sensors_obstL();
+
+	/* Sensors from right to left, anticlockwise */
+	for (i = 0; i < 3; i++) {
+		j = ctx->place * 3 + i;
+
+		ctx->ptValid[j] = (obst[i] != OBST_SENS_INFINITE);
+
+		if (!ctx->ptValid[j])
+			continue;
+
+		dist    = OBST_OFFSET + obst[i] * 10;
+		mdegree = (degree + (i - 1) * OBST_ANGLE) * 1000;
+
+		ctx->ptX[j] = x + (dist * trig_cos(mdegree)) / TRIG_ONE;
+		ctx->ptY[j] = y + (dist * trig_sin(mdegree)) / TRIG_ONE;
+	}
+}
+
+/* ===================
+ * Add each obstacle within range to the sectors it covers, widened by
+ *  the angle of the robot radius at its distance (taken from the table at
+ *  the closer step, so it's never narrower).
+ */
+static void buildHist ( avoidCtx* ctx, int x, int y, int degree )
+{
+	uint add, level;
+	int  i, k, n, dx, dy, dist, bearing, width;
+
+	for (i = 0; i < AVOID_SECTORS; i++) {
+		ctx->density[i] = 0;
+	}
+
+	for (i = 0; i < AVOID_POINTS; i++) {
+		if (!ctx->ptValid[i])
+			continue;
+
+		dx = ctx->ptX[i] - x;
+		dy = ctx->ptY[i] - y;
+
+		if (abs(dx) >= AVOID_RANGE || abs(dy) >= AVOID_RANGE)
+			continue;
+
+		/* Distance along the bearing, cheaper than a square root */
+		bearing = trig_atan2(dy, dx);
+		dist    = (dx * trig_cos(bearing) + dy * trig_sin(bearing)) >> TRIG_SHIFT;
+
+		if (dist >= AVOID_RANGE)
+			continue;
+
+		width    = dist > AVOID_RADIUS ? widths[(dist - AVOID_RADIUS) / WIDTH_STEP] : 90000;
+		bearing -= degree * 1000;
+		add      = AVOID_RANGE - dist;
+
+		k = sector(bearing - width);
+		n = (sector(bearing + width) - k + AVOID_SECTORS) % AVOID_SECTORS + 1;
+
+		while (n-- > 0) {
+			level = ctx->density[k] + add;
+			ctx->density[k] = level > DENSITY_MAX ? DENSITY_MAX : level;
+
+			if (++k == AVOID_SECTORS) {
+				k = 0;
+			}
+		}
+	}
+
+	/* Hysteresis, so sectors don't flicker around the threshold */
+	for (i = 0; i < AVOID_SECTORS; i++) {
+		if (ctx->density[i] > AVOID_HIGH) {
+			ctx->blocked[i] = true;
+		} else if (ctx->density[i] < AVOID_LOW) {
+			ctx->blocked[i] = false;
+		}
+	}
+}
+
+/* ===================
+ * Choose the direction (relative to the heading) among the openings
+ *  between blocked sectors. The goal and the last direction taken are
+ *  relative to the heading.
+ */
+static int choose ( avoidCtx* ctx, int goal, int last )
+{
+	int g    = sector(goal * 1000);
+	int l    = sector(last * 1000);
+	int best = -1;
+	int bestCost = 0;
+	bool toGoal  = false;
+	int cand[3];
+	int i, k, b, s, e, len, n, c, cost;
+
+	/* Some blocked sector, the openings are looked for after it */
+	for (b = 0; b < AVOID_SECTORS && !ctx->blocked[b]; b++);
+
+	if (b == AVOID_SECTORS) {
+		ctx->state = AVOID_GOAL;
+		return goal;
+	}
+
+	for (i = 1; i <= AVOID_SECTORS; ) {
+		if (ctx->blocked[(b + i) % AVOID_SECTORS]) {
+			i++;
+			continue;
+		}
+
+		/* Opening from sector b + s to b + e */
+		for (s = i; !ctx->blocked[(b + i) % AVOID_SECTORS]; i++);
+
+		e   = i - 1;
+		len = e - s + 1;
+		n   = 0;
+
+		if (len <= AVOID_WIDE) {
+			cand[n++] = b + s + len / 2;
+		} else {
+			cand[n++] = b + s + AVOID_WIDE / 2;
+			cand[n++] = b + e - AVOID_WIDE / 2;
+
+			k = (g - b - s + AVOID_SECTORS) % AVOID_SECTORS;
+
+			if (k >= AVOID_WIDE / 2 && k <= len - 1 - AVOID_WIDE / 2) {
+				cand[n++] = g;
+			}
+		}
+
+		for (k = 0; k < n; k++) {
+			c    = cand[k] % AVOID_SECTORS;
+			cost = COST_GOAL * sectorDist(c, g) + COST_HEADING * sectorDist(c, 0) +
+				COST_LAST * sectorDist(c, l);
+
+			if (best < 0 || cost < bestCost) {
+				best     = c;
+				bestCost = cost;
+				toGoal   = (k == 2);
+			}
+		}
+	}
+
+	if (best < 0) {
+		ctx->state = AVOID_BLOCKED;
+		return goal;
+	}
+
+	ctx->state = toGoal ? AVOID_GOAL : AVOID_STEER;
+
+	return toGoal ? goal : trig_norm(best * AVOID_SECTOR * 1000) / 1000;
+}
+
+/* ===================
+ * Wheels velocities to go towards dir (relative to the heading)
+ */
+static void setVel ( avoidCtx* ctx, int dir )
+{
+	int v, w, level;
+
+	if (ctx->state == AVOID_BLOCKED || abs(dir) > AVOID_SPIN) {
+		v = 0;
+		w = dir < 0 ? -ctx->vel / 2 : ctx->vel / 2;
+	} else {
+		/* Slower as the obstacles ahead, or where going, get closer */
+		level = ctx->density[0] > ctx->density[sector(dir * 1000)] ?
+			ctx->density[0] : ctx->density[sector(dir * 1000)];
+		level = level > AVOID_HIGH ? AVOID_HIGH : level;
+
+		v = (ctx->vel * (AVOID_HIGH - level)) / AVOID_HIGH;
+		v = (v * (AVOID_SPIN - abs(dir))) / AVOID_SPIN;
+		v = v < ctx->vel / 4 ? ctx->vel / 4 : v;
+		w = (dir * ctx->vel) / (2 * AVOID_SPIN);
+	}
+
+	ctx->left  = v - w;
+	ctx->right = v + w;
+}
+
+/* ===================
+ * Sector containing a direction (in millidegrees, relative to the
+ *  heading), sector 0 is centered on the heading.
+ */
+static inline int sector ( int mdegree )
+{
+	int k = (mdegree % 360000 + 360000 + AVOID_SECTOR * 500) / (AVOID_SECTOR * 1000);
+
+	return k % AVOID_SECTORS;
+}
+
+/* ===================
+ * Sectors between two sectors, either way round
+ */
+static inline int sectorDist ( int a, int b )
+{
+	int d = abs(a - b);
+
+	return d > AVOID_SECTORS / 2 ? AVOID_SECTORS - d : d;
+}
+
+
+/* = EOF ==================================================================== */
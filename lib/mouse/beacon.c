@@ -0,0 +1,345 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/mouse/beacon.c
+ *  \brief Implement the beacon triangulation.
+ *
+ *  The line of a bearing a from p is the points b with n . b = n . p, for
+ *   its normal n = (-sin a, cos a). The point closest to all of them solves
+ *   the normal equations A b = r, with A the sum of n n^T and r the sum of
+ *   n (n . p), and its covariance is s^2 A^-1, for s^2 the variance of the
+ *   distances of the lines to it. Everything is relative to the mean of the
+ *   positions, so the sums stay small, with the normals in Q10 (A too) and
+ *   the distances in mm.
+ *
+ *  The 2 x 2 system is solved by its adjugate over its determinant, which
+ *   can go well beyond 32 bits when multiplied, so the products over the
+ *   determinant are taken with 16 bits operands (mulDiv()).
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/beacon.h>
+#include <conf.h>
+#include <mouse/sensors.h>
+#include <util/trig.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Fixed point of the normals (bits), below the one of the trig
+ *   functions.
+ */
+#define NORM_SHIFT   10
+#define NORM_ONE     (1 << NORM_SHIFT)
+
+/**
+ *  \brief Farthest estimate (in mm), anything beyond is not one.
+ */
+#define FAR          20000
+
+/**
+ *  \brief Largest result of mulDiv(), the covariance is saturated at it.
+ */
+#define MULDIV_MAX   0x3FFFFFFF
+
+
+/* ===================
+ * Instance used by the non reentrant interface
+ */
+#ifdef BEACON_DEFAULT
+static MR_TLS beaconCtx beaconDefault;
+#endif
+
+
+/* ========================================================================== */
+
+static void solve  ( beaconCtx* ctx );
+static int  mulDiv ( int a, int b, int c );
+static uint length ( int a, int b );
+
+
+/* ==========================================================================
+ * Management
+ */
+
+void beacon_init_r ( beaconCtx* ctx )
+{
+	ctx->n     = 0;
+	ctx->next  = 0;
+	ctx->valid = false;
+	ctx->covXX = 0;
+	ctx->covXY = 0;
+	ctx->covYY = 0;
+	ctx->error = BEACON_NO_ERROR;
+}
+
+bool beacon_update_r ( beaconCtx* ctx, int x, int y, bool seen, int bearing )
+{
+	uint last = (ctx->next + BEACON_BEARINGS - 1) % BEACON_BEARINGS;
+	int  dx, dy;
+
+	if (!seen)
+		return false;
+
+	if (ctx->n > 0) {
+		dx = x - ctx->bX[last];
+		dy = y - ctx->bY[last];
+
+		if (dx * dx + dy * dy < BEACON_BASE * BEACON_BASE)
+			return false;
+	}
+
+	ctx->bX[ctx->next] = x;
+	ctx->bY[ctx->next] = y;
+	ctx->bA[ctx->next] = bearing;
+
+	ctx->next = (ctx->next + 1) % BEACON_BEARINGS;
+	ctx->n   += ctx->n < BEACON_BEARINGS ? 1 : 0;
+
+	solve(ctx);
+
+	return true;
+}
+
+#ifdef BEACON_DEFAULT
+
+void beacon_init ( void )
+{
+	beacon_init_r(&beaconDefault);
+}
+
+bool beacon_update ( void )
+{
+	int x, y;
+
+	sensors_position(&x, &y);
+
+	return beacon_update_r(&beaconDefault, x, y,
+		sensors_beacon() && sensors_beaconValid() && sensors_beaconConf() >= BEACON_CONF,
+		sensors_beaconBearing());
+}
+
+#endif /* BEACON_DEFAULT */
+
+
+/* ==========================================================================
+ * Queries
+ */
+
+bool beacon_position_r ( const beaconCtx* ctx, int* x, int* y )
+{
+	if (!ctx->valid)
+		return false;
+
+	if (x != NULL) {
+		(*x) = ctx->estX;
+	}
+
+	if (y != NULL) {
+		(*y) = ctx->estY;
+	}
+
+	return true;
+}
+
+uint beacon_error_r ( const beaconCtx* ctx, int* xx, int* xy, int* yy )
+{
+	if (xx != NULL) {
+		(*xx) = ctx->covXX;
+	}
+
+	if (xy != NULL) {
+		(*xy) = ctx->covXY;
+	}
+
+	if (yy != NULL) {
+		(*yy) = ctx->covYY;
+	}
+
+	return ctx->error;
+}
+
+uint beacon_bearings_r ( const beaconCtx* ctx )
+{
+	return ctx->n;
+}
+
+#ifdef BEACON_DEFAULT
+
+bool beacon_position ( int* x, int* y )
+{
+	return beacon_position_r(&beaconDefault, x, y);
+}
+
+uint beacon_error ( int* xx, int* xy, int* yy )
+{
+	return beacon_error_r(&beaconDefault, xx, xy, yy);
+}
+
+uint beacon_bearings ( void )
+{
+	return beacon_bearings_r(&beaconDefault);
+}
+
+#endif /* BEACON_DEFAULT */
+
+
+/* ==========================================================================
+ * Private functions
+ */
+
+/* ===================
+ * Least squares intersection of the lines of the bearings kept.
+ */
+static void solve ( beaconCtx* ctx )
+{
+	int  mx = 0, my = 0, a11 = 0, a12 = 0, a22 = 0, rx = 0, ry = 0;
+	int  nx, ny, px, py, c, s, bx, by, det, res, along = 0;
+	uint ss = 0, least = 0, var, i;
+
+	ctx->valid = false;
+	ctx->covXX = 0;
+	ctx->covXY = 0;
+	ctx->covYY = 0;
+	ctx->error = BEACON_NO_ERROR;
+
+	if (ctx->n < BEACON_MIN)
+		return;
+
+	for (i = 0; i < ctx->n; i++) {
+		mx += ctx->bX[i];
+		my += ctx->bY[i];
+	}
+
+	mx /= (int) ctx->n;
+	my /= (int) ctx->n;
+
+	/* Normal equations */
+	for (i = 0; i < ctx->n; i++) {
+		nx = -trig_sin(ctx->bA[i] * 1000) / (TRIG_ONE / NORM_ONE);
+		ny =  trig_cos(ctx->bA[i] * 1000) / (TRIG_ONE / NORM_ONE);
+		c  = (nx * (ctx->bX[i] - mx) + ny * (ctx->bY[i] - my)) / NORM_ONE;
+
+		a11 += nx * nx / NORM_ONE;
+		a12 += nx * ny / NORM_ONE;
+		a22 += ny * ny / NORM_ONE;
+		rx  += nx * c;
+		ry  += ny * c;
+	}
+
+	det = a11 * a22 - a12 * a12;
+
+	if (det <= 0)
+		return;
+
+	bx = mulDiv(a22, rx, det) - mulDiv(a12, ry, det);
+	by = mulDiv(a11, ry, det) - mulDiv(a12, rx, det);
+
+	if (abs(bx) > FAR || abs(by) > FAR)
+		return;
+
+	/* Spread of the lines around it, and the least from the bearings
+	 *  error at its distance (in mm, for BEACON_NOISE * pi / 180) */
+	for (i = 0; i < ctx->n; i++) {
+		s  = trig_sin(ctx->bA[i] * 1000);
+		c  = trig_cos(ctx->bA[i] * 1000);
+		px = bx - (ctx->bX[i] - mx);
+		py = by - (ctx->bY[i] - my);
+
+		res    = (-s * px + c * py) / TRIG_ONE;
+		res    = res > FAR ? FAR : (res < -FAR ? -FAR : res);
+		ss    += res * res / ctx->n;
+		along += (c * px + s * py) / TRIG_ONE;
+
+		res    = trig_sqrt(px * px + py * py) * BEACON_NOISE * 1745 / 100000;
+		least += res * res / ctx->n;
+	}
+
+	/* Behind the robot, the lines only cross backwards */
+	if (along <= 0)
+		return;
+
+	var = ss + ss * 2 / (ctx->n - 2);      // Mean over n - 2
+	var = var > least ? var : least;
+	var = var > MULDIV_MAX ? MULDIV_MAX : var;
+
+	ctx->valid = true;
+	ctx->estX  = mx + bx;
+	ctx->estY  = my + by;
+	ctx->covXX =  mulDiv(var, a22 * NORM_ONE, det);
+	ctx->covXY = -mulDiv(var, a12 * NORM_ONE, det);
+	ctx->covYY =  mulDiv(var, a11 * NORM_ONE, det);
+
+	/* Major axis of the error ellipse */
+	var = ctx->covXX / 2 + ctx->covYY / 2 + length((ctx->covXX - ctx->covYY) / 2, ctx->covXY);
+
+	ctx->error = trig_sqrt(var);
+}
+
+/* ===================
+ * a * b / c without overflowing, with the operands taken to 16 bits (the
+ *  divisor to 17) and the result saturated at MULDIV_MAX.
+ */
+static int mulDiv ( int a, int b, int c )
+{
+	uint ua  = abs(a);
+	uint ub  = abs(b);
+	uint uc  = abs(c);
+	bool neg = ((a < 0) != (b < 0)) != (c < 0);
+	uint r;
+	int  s = 0;
+
+	while (ua >= 0x10000) {
+		ua >>= 1;
+		s++;
+	}
+
+	while (ub >= 0x10000) {
+		ub >>= 1;
+		s++;
+	}
+
+	/* The divisor takes the shift back while it keeps its precision */
+	while (s > 0 && uc >= 0x20000) {
+		uc >>= 1;
+		s--;
+	}
+
+	if (uc == 0) {
+		r = MULDIV_MAX;
+	} else {
+		r = ua * ub / uc;
+		r = r > (MULDIV_MAX >> s) ? MULDIV_MAX : r << s;
+	}
+
+	return neg ? -(int) r : (int) r;
+}
+
+/* ===================
+ * Length of a vector, its components taken to 15 bits.
+ */
+static uint length ( int a, int b )
+{
+	uint ua = abs(a);
+	uint ub = abs(b);
+	int  s  = 0;
+
+	while (ua >= 0x8000 || ub >= 0x8000) {
+		ua >>= 1;
+		ub >>= 1;
+		s++;
+	}
+
+	return trig_sqrt(ua * ua + ub * ub) << s;
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,254 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/mouse/calib.c
+ *  \brief Implement calibration utilities.
+ *
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/calib.h>
+#include <conf.h>
+#include <hal/robot.h>
+#include <mouse/mouse.h>
+#include <mouse/actuators.h>
+#include <detpic32.h>
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Number of cycles running at the bias command before measuring
+ *   the operating point speed.
+ */
+#define CALIB_SETTLE_CYCLES    50
+
+/**
+ *  \brief Number of cycles averaged to find the operating point speed.
+ */
+#define CALIB_AVERAGE_CYCLES   50
+
+/**
+ *  \brief Number of relay periods discarded before measuring.
+ */
+#define CALIB_TRANSIENT_PERIODS 3
+
+/**
+ *  \brief Maximum number of relay cycles before giving up.
+ */
+#define CALIB_RELAY_TIMEOUT   400
+
+
+/* ==========================================================================
+ * Relay experiment
+ */
+
+void calib_relayInit ( calibRelay* relay, int bias, int amp )
+{
+	relay->phase = CALIB_RELAY_SETTLE;
+
+	relay->bias = bias;
+	relay->amp  = amp;
+	relay->sp   = 0;
+
+	relay->cycles = 0;
+	relay->acc    = 0;
+	relay->high   = false;
+
+	relay->periods   = 0;
+	relay->periodLen = 0;
+	relay->max       = 0;
+	relay->min       = 0;
+
+	relay->sumTu = 0;
+	relay->sumPP = 0;
+}
+
+int calib_relayStep ( calibRelay* relay, int ticks )
+{
+	int err;
+
+	switch (relay->phase) {
+	case CALIB_RELAY_SETTLE:
+		relay->cycles++;
+
+		if (relay->cycles > CALIB_SETTLE_CYCLES) {
+			relay->acc += ticks;
+		}
+
+		if (relay->cycles == CALIB_SETTLE_CYCLES + CALIB_AVERAGE_CYCLES) {
+			relay->sp = (relay->acc + CALIB_AVERAGE_CYCLES / 2) / CALIB_AVERAGE_CYCLES;
+
+			if (relay->sp <= CALIB_RELAY_HYST) {
+				relay->phase = CALIB_RELAY_FAILED;  // Wheel isn't moving
+				return 0;
+			}
+
+			relay->phase  = CALIB_RELAY_RUN;
+			relay->cycles = 0;
+			relay->high   = false;
+		}
+
+		return relay->bias;
+
+	case CALIB_RELAY_RUN:
+	case CALIB_RELAY_MEASURE:
+		break;
+
+	default:
+		return 0;
+	}
+
+	relay->cycles++;
+	relay->periodLen++;
+
+	relay->max = ticks > relay->max ? ticks : relay->max;
+	relay->min = ticks < relay->min ? ticks : relay->min;
+
+	err = relay->sp - ticks;
+
+	if (relay->high && err < -CALIB_RELAY_HYST) {
+		relay->high = false;
+
+	} else if (!relay->high && err > CALIB_RELAY_HYST) {
+		relay->high = true;
+
+		/* A rising switch marks the beginning of a new period */
+		if (relay->phase == CALIB_RELAY_RUN) {
+			if (++relay->periods >= CALIB_TRANSIENT_PERIODS) {
+				relay->phase   = CALIB_RELAY_MEASURE;
+				relay->periods = 0;
+			}
+		} else {
+			relay->sumTu += relay->periodLen;
+			relay->sumPP += relay->max - relay->min;
+
+			if (++relay->periods >= CALIB_RELAY_PERIODS) {
+				relay->phase = relay->sumPP > 0 ? CALIB_RELAY_DONE : CALIB_RELAY_FAILED;
+				return 0;
+			}
+		}
+
+		relay->periodLen = 0;
+		relay->max       = ticks;
+		relay->min       = ticks;
+	}
+
+	if (relay->cycles >= CALIB_RELAY_TIMEOUT) {
+		relay->phase = CALIB_RELAY_FAILED;
+		return 0;
+	}
+
+	return relay->high ? relay->bias + relay->amp : relay->bias - relay->amp;
+}
+
+bool calib_relayDone ( const calibRelay* relay )
+{
+	return (relay->phase == CALIB_RELAY_DONE || relay->phase == CALIB_RELAY_FAILED);
+}
+
+bool calib_relayUltimate ( const calibRelay* relay, int* ku100, int* tu10 )
+{
+	int periods = relay->periods;
+
+	if (relay->phase != CALIB_RELAY_DONE)
+		return false;
+
+	/* Ku = 4d / (PI a), with a = sumPP / (2 periods)
+	 *
+	 * Ku x 100 = (800 x d x periods) / (PI x sumPP)
+	 */
+	if (ku100 != NULL) {
+		(*ku100) = (80000 * relay->amp * periods + 157 * relay->sumPP) / (314 * relay->sumPP);
+	}
+
+	if (tu10 != NULL) {
+		(*tu10) = (relay->sumTu * 10 + periods / 2) / periods;
+	}
+
+	return true;
+}
+
+bool calib_relayGains ( const calibRelay* relay, int* kp, int* ki )
+{
+	int ku100, tu10;
+
+	if (!calib_relayUltimate(relay, &ku100, &tu10))
+		return false;
+
+	/* Kp = 0.45 Ku
+	 * Ki = 0.54 Ku / Tu
+	 */
+	(*kp) = (45 * ku100 + 5000) / 10000;
+	(*ki) = (54 * ku100 + 500 * tu10) / (1000 * tu10);
+
+	(*kp) = (*kp) < 1 ? 1 : (*kp);
+	(*ki) = (*ki) < 1 ? 1 : (*ki);
+
+	return true;
+}
+
+
+/* ==========================================================================
+ * On robot calibration
+ */
+
+bool calib_tunePI ( void )
+{
+	calibRelay left;
+	calibRelay right;
+
+	int cmdL, cmdR;
+	int kpL, kiL, kpR, kiR;
+	int kuL = 0, tuL = 0, kuR = 0, tuR = 0;
+
+	calib_relayInit(&left,  CALIB_RELAY_BIAS, CALIB_RELAY_AMP);
+	calib_relayInit(&right, CALIB_RELAY_BIAS, CALIB_RELAY_AMP);
+
+	robot_setVel2(0, 0);
+	robot_readEncoders();                       // Discard old ticks
+
+	while (!calib_relayDone(&left) || !calib_relayDone(&right)) {
+		mouse_waitStep10ms();
+
+		robot_readEncoders();
+
+		cmdL = calib_relayStep(&left,  sensors.enc_left);
+		cmdR = calib_relayStep(&right, sensors.enc_right);
+
+		robot_setVel2(cmdL, cmdR);
+	}
+
+	robot_setVel2(0, 0);
+
+	if (!calib_relayGains(&left, &kpL, &kiL) || !calib_relayGains(&right, &kpR, &kiR)) {
+		printf("PI tuning failed (left: %d, right: %d)\n", left.phase, right.phase);
+		return false;
+	}
+
+	calib_relayUltimate(&left,  &kuL, &tuL);
+	calib_relayUltimate(&right, &kuR, &tuR);
+
+	printf("/* Left:  Ku = %d/100, Tu = %d/10 cycles */\n", kuL, tuL);
+	printf("/* Right: Ku = %d/100, Tu = %d/10 cycles */\n", kuR, tuR);
+	printf("#define PI_KP_LEFT  %d\n", kpL);
+	printf("#define PI_KI_LEFT  %d\n", kiL);
+	printf("#define PI_KP_RIGHT %d\n", kpR);
+	printf("#define PI_KI_RIGHT %d\n", kiR);
+
+	actuators_setPIGains(kpL, kiL, kpR, kiR);
+
+	return true;
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,494 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/mouse/dwa.c
+ *  \brief Implement the dynamic window local planner.
+ *
+ *  The window is sampled on the wheels velocities, a square grid around
+ *   the last ones chosen, which is where the acceleration limits apply.
+ *   Trajectories are followed in the frame of the robot, where the
+ *   obstacles were moved to, starting from the origin facing +x.
+ *
+ *  An obstacle the robot is already too close to can't get any closer,
+ *   but doesn't stop the robot from moving away from it.
+ *
+ *  The time taken is measured with the core timer, except in the
+ *   simulation, where that's the host clock and the samples taken would
+ *   depend on the host load. There each sample is charged a fixed time
+ *   instead (see spent()).
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/dwa.h>
+#include <conf.h>
+#include <mouse/map.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <util/trig.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Acceleration in mm/s^2, and velocity change per cycle in mm/s.
+ */
+#define ACC_MM      (DWA_ACC * 10)
+#define ACC_CYCLE   ((ACC_MM * CICLE_T) / 1000)
+
+#define STEP_T      (DWA_HORIZON / DWA_STEPS)
+
+/**
+ *  \brief Distance (in um) traveled by a wheel per encoder tick, as in
+ *   mouse/actuators.c.
+ */
+#define TICK_UM     ((WHEEL_CIRC * 1000) / ENC_TPR)
+
+/**
+ *  \brief Smallest velocity (in mm/s, whole cm/s) that moves a wheel, the
+ *   window is never narrower so the robot can start from rest.
+ */
+#define VEL_RES     (((TICK_UM + CICLE_T * 10 - 1) / (CICLE_T * 10)) * 10)
+#define WINDOW      (ACC_CYCLE > VEL_RES ? ACC_CYCLE : VEL_RES)
+
+/**
+ *  \brief Distance (in mm) beyond which the goal is brought closer.
+ */
+#define DWA_FAR     16384
+
+/**
+ *  \brief Core timer counts charged for a sample in the simulation, about
+ *   what it takes on the host.
+ */
+#define SAMPLE_CORE 20
+
+
+/* ===================
+ * Instance used by the non reentrant interface
+ */
+#ifdef DWA_DEFAULT
+static MR_TLS dwaCtx dwaDefault;
+#endif
+
+
+/* ========================================================================== */
+
+static void findObstacles ( dwaCtx* ctx, int x, int y, int c, int s );
+static int  score         ( const dwaCtx* ctx, int left, int right, int goalX, int goalY, int dist );
+static void brake         ( dwaCtx* ctx );
+
+static inline int  applied ( int vel );
+static inline uint spent   ( uint t0, uint work );
+
+static inline void addObstacle ( dwaCtx* ctx, int cx, int cy, int x, int y, int c, int s );
+
+
+/* ==========================================================================
+ * Management
+ */
+
+void dwa_init_r ( dwaCtx* ctx, const mapCtx* map )
+{
+	ctx->map     = map;
+	ctx->velMax  = DWA_VEL * 10;
+	ctx->left    = 0;
+	ctx->right   = 0;
+	ctx->state   = DWA_ARRIVED;
+	ctx->samples = DWA_SAMPLES_MIN;
+	ctx->scored  = 0;
+	ctx->nObst   = 0;
+}
+
+void dwa_setVel_r ( dwaCtx* ctx, int vel )
+{
+	ctx->velMax = vel * 10;
+}
+
+uint dwa_update_r ( dwaCtx* ctx, int x, int y, int degree, int goalX, int goalY, uint budgetUs )
+{
+	uint t0     = readCoreTimer();
+	uint budget = budgetUs * CORE_US;
+	int  c      = trig_cos(degree * 1000);
+	int  s      = trig_sin(degree * 1000);
+	int  dx     = goalX - x;
+	int  dy     = goalY - y;
+	int  gx, gy, dist, vCap, vLow;
+	int  loL, hiL, loR, hiR, left, right, v, value;
+	int  best = -1, bestL = 0, bestR = 0;
+	uint n, k, next, elapsed;
+
+	/* Goal in the frame of the robot, and distance along its bearing */
+	gx   = (dx * c + dy * s) >> TRIG_SHIFT;
+	gy   = (dy * c - dx * s) >> TRIG_SHIFT;
+	dist = trig_atan2(dy, dx);
+	dist = (dx * trig_cos(dist) + dy * trig_sin(dist)) >> TRIG_SHIFT;
+
+	/* Only the direction of a far goal matters, keep the squares in range */
+	while (abs(gx) > DWA_FAR || abs(gy) > DWA_FAR) {
+		gx /= 2;
+		gy /= 2;
+	}
+
+	ctx->scored = 0;
+
+	if (dist < DWA_GOAL_DIST) {
+		ctx->state = DWA_ARRIVED;
+		brake(ctx);
+		return ctx->state;
+	}
+
+	findObstacles(ctx, x, y, c, s);
+
+	/* The window, and the velocity from which the robot stops at the goal */
+	loL = ctx->left  - WINDOW < -ctx->velMax ? -ctx->velMax : ctx->left  - WINDOW;
+	hiL = ctx->left  + WINDOW >  ctx->velMax ?  ctx->velMax : ctx->left  + WINDOW;
+	loR = ctx->right - WINDOW < -ctx->velMax ? -ctx->velMax : ctx->right - WINDOW;
+	hiR = ctx->right + WINDOW >  ctx->velMax ?  ctx->velMax : ctx->right + WINDOW;
+
+	vCap = trig_sqrt(2 * ACC_MM * dist);
+	vLow = (loL + loR) / 2;
+
+	n = trig_sqrt(ctx->samples);
+	n = n < 2 ? 2 : n;
+
+	/* The n x n grid, row by row */
+	for (k = 0; k < n * n; k++) {
+		if (ctx->scored >= DWA_SAMPLES_MIN && spent(t0, ctx->scored * SAMPLE_CORE) >= budget)
+			break;
+
+		left  = loL + ((hiL - loL) * (int) (k / n)) / (int) (n - 1);
+		right = loR + ((hiR - loR) * (int) (k % n)) / (int) (n - 1);
+
+		/* Velocities too slow to move a wheel are the same as 0 */
+		left  = abs(left)  < VEL_RES ? 0 : left;
+		right = abs(right) < VEL_RES ? 0 : right;
+		v     = (left + right) / 2;
+
+		/* Standing still is left for when nothing else is safe */
+		if (v < 0 || (v > vCap && v > vLow) || (left == 0 && right == 0))
+			continue;
+
+		value = score(ctx, left, right, gx, gy, dist);
+		ctx->scored++;
+
+		if (value > best) {
+			best  = value;
+			bestL = left;
+			bestR = right;
+		}
+	}
+
+	if (best < 0) {
+		ctx->state = DWA_BLOCKED;
+		brake(ctx);
+	} else {
+		ctx->state = DWA_GO;
+		ctx->left  = bestL;
+		ctx->right = bestR;
+	}
+
+	/* Samples that fit in the budget at the time each one took, smoothed */
+	elapsed = spent(t0, ctx->scored * SAMPLE_CORE);
+
+	if (ctx->scored > 0) {
+		next = budget / (elapsed / ctx->scored + 1);
+		next = (ctx->samples + next) / 2;
+
+		ctx->samples = next < DWA_SAMPLES_MIN ? DWA_SAMPLES_MIN :
+			(next > DWA_SAMPLES_MAX ? DWA_SAMPLES_MAX : next);
+	}
+
+	return ctx->state;
+}
+
+#ifdef DWA_DEFAULT
+
+void dwa_init ( void )
+{
+	dwa_init_r(&dwaDefault, map_default());
+}
+
+void dwa_setVel ( int vel )
+{
+	dwa_setVel_r(&dwaDefault, vel);
+}
+
+uint dwa_update ( int x, int y )
+{
+	int  posX, posY, left, right;
+	uint state;
+
+	sensors_position(&posX, &posY);
+
+	state = dwa_update_r(&dwaDefault, posX, posY, sensors_compass(), x, y, DWA_BUDGET_US);
+
+	dwa_getWheels_r(&dwaDefault, &left, &right);
+	actuators_setVel(left, right);
+
+	return state;
+}
+
+#endif /* DWA_DEFAULT */
+
+
+/* ==========================================================================
+ * Queries
+ */
+
+void dwa_getWheels_r ( const dwaCtx* ctx, int* left, int* right )
+{
+	if (left != NULL) {
+		(*left) = ctx->left / 10;
+	}
+
+	if (right != NULL) {
+		(*right) = ctx->right / 10;
+	}
+}
+
+void dwa_samples_r ( const dwaCtx* ctx, uint* last, uint* next )
+{
+	if (last != NULL) {
+		(*last) = ctx->scored;
+	}
+
+	if (next != NULL) {
+		(*next) = ctx->samples;
+	}
+}
+
+void dwa_getVel_r ( const dwaCtx* ctx, int* vel, int* angVel )
+{
+	if (vel != NULL) {
+		(*vel) = (ctx->left + ctx->right) / 2;
+	}
+
+	if (angVel != NULL) {
+		(*angVel) = ((ctx->right - ctx->left) * 57) / WHEEL_BASE;
+	}
+}
+
+#ifdef DWA_DEFAULT
+
+void dwa_samples ( uint* last, uint* next )
+{
+	dwa_samples_r(&dwaDefault, last, next);
+}
+
+void dwa_getVel ( int* vel, int* angVel )
+{
+	dwa_getVel_r(&dwaDefault, vel, angVel);
+}
+
+#endif /* DWA_DEFAULT */
+
+
+/* ==========================================================================
+ * Private functions
+ */
+
+/* ===================
+ * Keep the obstacles seen now by the sensors, and the occupied cells
+ *  around the robot, in rings from the robot cell out, so the closest ones
+ *  are kept when there are too many. c and s are the cosine and sine of
+ *  the heading.
+ *
+ *  The readings are added because the map may miss what was only seen
+ *  along its cells, like the end of a wall.
+ */
+static void findObstacles ( dwaCtx* ctx, int x, int y, int c, int s )
+{
+	int obst[3];
+	int rx, ry, ox, oy, r, i, dist;
+
+	obst[0] = sensors_obstR();
+	obst[1] = sensors_obstF();
+	obst[2] = sensors_obstL();
+
+	ctx->nObst = 0;
+
+	/* Sensors from right to left, anticlockwise */
+	for (i = 0; i < 3; i++) {
+		if (obst[i] == OBST_SENS_INFINITE)
+			continue;
+
+		dist = OBST_OFFSET + obst[i] * 10;
+		r    = (i - 1) * OBST_ANGLE * 1000;
+
+		ox = (dist * trig_cos(r)) >> TRIG_SHIFT;
+		oy = (dist * trig_sin(r)) >> TRIG_SHIFT;
+
+		ctx->obstX[ctx->nObst]  = ox;
+		ctx->obstY[ctx->nObst]  = oy;
+		ctx->obstD2[ctx->nObst] = ox * ox + oy * oy;
+		ctx->nObst++;
+	}
+
+	if (!map_toCell_r(ctx->map, x, y, &rx, &ry))
+		return;
+
+	addObstacle(ctx, rx, ry, x, y, c, s);
+
+	for (r = 1; r <= DWA_RANGE / MAP_CELL && ctx->nObst < DWA_OBST; r++) {
+		for (i = -r; i <= r; i++) {
+			addObstacle(ctx, rx + i, ry - r, x, y, c, s);
+			addObstacle(ctx, rx + i, ry + r, x, y, c, s);
+		}
+
+		for (i = -r + 1; i < r; i++) {
+			addObstacle(ctx, rx - r, ry + i, x, y, c, s);
+			addObstacle(ctx, rx + r, ry + i, x, y, c, s);
+		}
+	}
+}
+
+static inline void addObstacle ( dwaCtx* ctx, int cx, int cy, int x, int y, int c, int s )
+{
+	int dx, dy, ox, oy;
+
+	if (ctx->nObst >= DWA_OBST || map_cellState_r(ctx->map, cx, cy) != MAP_OCCUPIED)
+		return;
+
+	map_cellCenter_r(ctx->map, cx, cy, &dx, &dy);
+
+	dx -= x;
+	dy -= y;
+	ox  = (dx * c + dy * s) >> TRIG_SHIFT;
+	oy  = (dy * c - dx * s) >> TRIG_SHIFT;
+
+	ctx->obstX[ctx->nObst]  = ox;
+	ctx->obstY[ctx->nObst]  = oy;
+	ctx->obstD2[ctx->nObst] = ox * ox + oy * oy;
+	ctx->nObst++;
+}
+
+/* ===================
+ * Follow a pair of wheels velocities (in mm/s) for the horizon.
+ *
+ *  The velocities followed are the ones the wheels controllers will
+ *   actually keep, so a slow turn that doesn't move the wheels isn't taken
+ *   for one that would aim at the goal.
+ *
+ *  The direction to the goal is taken once the robot went half way to it
+ *   (or at the end), so fast trajectories that go past a close goal
+ *   aren't penalized.
+ *
+ *  Returns the score, or -1 if an obstacle is hit before the robot can stop.
+ */
+static int score ( const dwaCtx* ctx, int left, int right, int goalX, int goalY, int dist )
+{
+	int  v     = (applied(left) + applied(right)) / 2;
+	int  step  = v * STEP_T;                              // um per step
+	int  turn  = ((applied(right) - applied(left)) * 57296 / WHEEL_BASE) * STEP_T / 1000;  // mdegree per step
+	int  minD2 = DWA_REACH * DWA_REACH;
+	int  x = 0, y = 0, th = 0, px = 0, py = 0;
+	int  half  = dist * 500;                             // um
+	int  k, i, dx, dy, d2, clear, err = 0;
+	bool hit   = false;
+	bool aimed = false;
+
+	for (k = 1; k <= DWA_STEPS && !hit; k++) {
+		x  += (step * trig_cos(th + turn / 2)) >> TRIG_SHIFT;
+		y  += (step * trig_sin(th + turn / 2)) >> TRIG_SHIFT;
+		th += turn;
+		px  = x / 1000;
+		py  = y / 1000;
+
+		for (i = 0; i < ctx->nObst; i++) {
+			dx = ctx->obstX[i] - px;
+			dy = ctx->obstY[i] - py;
+
+			if (abs(dx) >= DWA_REACH || abs(dy) >= DWA_REACH)
+				continue;
+
+			d2 = dx * dx + dy * dy;
+
+			if (d2 < minD2) {
+				minD2 = d2;
+			}
+
+			if (d2 >= DWA_RADIUS * DWA_RADIUS)
+				continue;
+
+			/* Too close already, it can only get farther */
+			if (ctx->obstD2[i] < DWA_RADIUS * DWA_RADIUS) {
+				if (d2 < ctx->obstD2[i])
+					return -1;
+			} else {
+				hit = true;
+			}
+		}
+
+		if (!aimed && step * k >= half) {
+			err   = trig_atan2(goalY - py, goalX - px) - th;
+			aimed = true;
+		}
+	}
+
+	/* End of the horizon, or hit, before half way */
+	if (!aimed) {
+		err = trig_atan2(goalY - py, goalX - px) - th;
+	}
+
+	/* A hit is fine as long as the robot can stop before it */
+	if (hit && v * v > 2 * ACC_MM * ((step * (k - 1)) / 1000))
+		return -1;
+
+	/* Clearance: the time to the hit, or half and the distance to the
+	 *  obstacles when there's none */
+	if (hit) {
+		clear = ((k - 2) * 500) / DWA_STEPS;
+	} else {
+		clear = (int) trig_sqrt(minD2) - DWA_RADIUS;
+		clear = 500 + ((clear < 0 ? 0 : clear) * 500) / DWA_CLEAR;
+	}
+
+	err = trig_norm(err);
+
+	return DWA_K_HEADING * (1000 - abs(err) / 180) +
+		DWA_K_CLEAR * clear +
+		DWA_K_VEL * ((v * 1000) / ctx->velMax);
+}
+
+/* ===================
+ * Velocity (in mm/s) kept by a wheel controller given vel (in mm/s): it's
+ *  set in cm/s and rounded down to whole encoder ticks per cycle.
+ */
+static inline int applied ( int vel )
+{
+	return (((CICLE_T * (vel / 10) * 10) / TICK_UM) * TICK_UM) / CICLE_T;
+}
+
+/* ===================
+ * Core timer counts taken since t0, or in the simulation the ones charged
+ *  for the work done
+ */
+static inline uint spent ( uint t0, uint work )
+{
+#ifdef MR_SIM
+	return work;
+#else
+	return readCoreTimer() - t0;
+#endif
+}
+
+/* ===================
+ * Slow down both wheels as fast as possible
+ */
+static void brake ( dwaCtx* ctx )
+{
+	ctx->left  = ctx->left  > ACC_CYCLE ? ctx->left  - ACC_CYCLE :
+		(ctx->left  < -ACC_CYCLE ? ctx->left  + ACC_CYCLE : 0);
+	ctx->right = ctx->right > ACC_CYCLE ? ctx->right - ACC_CYCLE :
+		(ctx->right < -ACC_CYCLE ? ctx->right + ACC_CYCLE : 0);
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,498 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/mouse/explore.c
+ *  \brief Implement the frontier based exploration.
+ *
+ *  Whether a cell is a frontier depends on it and its four neighbours, so
+ *   a state change of a cell is followed by looking at it and at them
+ *   again. Flipping the bit of a cell updates the count and the sums of
+ *   its block, so ranking the candidates only goes through the blocks.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/explore.h>
+#include <conf.h>
+#include <mouse/map.h>
+#include <mouse/plan.h>
+#include <mouse/sensors.h>
+#include <util/trig.h>
+
+
+/* ===================
+ * Instance used by the non reentrant interface
+ */
+#ifdef EXPLORE_DEFAULT
+static MR_TLS exploreCtx exploreDefault;
+#endif
+
+
+/* ========================================================================== */
+
+static void refresh ( exploreCtx* ctx, int cx, int cy );
+static void rank    ( exploreCtx* ctx, int x, int y, int degree );
+static int  cost    ( const exploreCtx* ctx, int b, int x, int y, int degree );
+static void setGoal ( exploreCtx* ctx, int b );
+static void forget  ( exploreCtx* ctx );
+
+static inline bool isFrontier ( const exploreCtx* ctx, int cx, int cy );
+static inline bool getFront   ( const exploreCtx* ctx, int cx, int cy );
+static inline void setFront   ( exploreCtx* ctx, int cx, int cy, bool on );
+static inline bool near       ( int x0, int y0, int x1, int y1 );
+
+
+/* ==========================================================================
+ * Management
+ */
+
+void explore_init_r ( exploreCtx* ctx, const mapCtx* map )
+{
+	uint i;
+
+	ctx->map    = map;
+	ctx->mapSeq = map_stateSeq_r(map);
+	ctx->scan   = 0;
+
+	for (i = 0; i < MAP_SIZE * MAP_SIZE / 32; i++) {
+		ctx->front[i] = 0;
+	}
+
+	for (i = 0; i < EXPLORE_BLOCKS; i++) {
+		ctx->count[i] = 0;
+		ctx->sumX[i]  = 0;
+		ctx->sumY[i]  = 0;
+	}
+
+	forget(ctx);
+
+	ctx->nFront     = 0;
+	ctx->beaconOn   = false;
+	ctx->beaconX    = 0;
+	ctx->beaconY    = 0;
+	ctx->beaconBear = 0;
+	ctx->state      = EXPLORE_SCAN;
+	ctx->goal       = -1;
+	ctx->goalX      = 0;
+	ctx->goalY      = 0;
+	ctx->newGoal    = false;
+	ctx->cycles     = 0;
+	ctx->stuckX     = 0;
+	ctx->stuckY     = 0;
+	ctx->stuck      = 0;
+}
+
+uint explore_update_r ( exploreCtx* ctx, int x, int y, int degree, bool beacon, int bearing )
+{
+	int  cx, cy, changed, end;
+	bool hadGoal = (ctx->goal >= 0);
+
+	ctx->newGoal = false;
+
+	if (beacon) {
+		ctx->beaconOn   = true;
+		ctx->beaconX    = x;
+		ctx->beaconY    = y;
+		ctx->beaconBear = bearing;
+	}
+
+	while ((changed = map_stateChanges_r(ctx->map, &ctx->mapSeq, &cx, &cy)) != 0) {
+		if (changed < 0) {
+			/* Lost track of the map, it may have been cleared */
+			ctx->scan = 0;
+			ctx->goal = -1;
+			continue;
+		}
+
+		refresh(ctx, cx, cy);
+	}
+
+	if (ctx->scan < MAP_SIZE) {
+		end = ctx->scan + EXPLORE_SCAN_ROWS;
+
+		for (cy = ctx->scan; cy < end && cy < MAP_SIZE; cy++) {
+			for (cx = 0; cx < MAP_SIZE; cx++) {
+				setFront(ctx, cx, cy, isFrontier(ctx, cx, cy));
+			}
+		}
+
+		ctx->scan = cy;
+
+		if (ctx->scan < MAP_SIZE) {
+			ctx->state   = EXPLORE_SCAN;
+			ctx->newGoal = hadGoal;
+			return ctx->state;
+		}
+	}
+
+	/* Reached but still a frontier, it can't be cleared */
+	if (ctx->goal >= 0 && near(ctx->goalX, ctx->goalY, x, y)) {
+		explore_reject_r(ctx);
+	}
+
+	/* Not moving, against something the sensors don't see */
+	if (!near(ctx->stuckX, ctx->stuckY, x, y)) {
+		ctx->stuckX = x;
+		ctx->stuckY = y;
+		ctx->stuck  = 0;
+	} else if (ctx->goal >= 0 && ++ctx->stuck >= EXPLORE_STUCK) {
+		ctx->stuck = 0;
+		explore_reject_r(ctx);
+	}
+
+	/* Cleared, what was given up may be reachable now */
+	if (ctx->goal >= 0) {
+		map_toCell_r(ctx->map, ctx->goalX, ctx->goalY, &cx, &cy);
+
+		if (!getFront(ctx, cx, cy)) {
+			ctx->goal = -1;
+			forget(ctx);
+		}
+	}
+
+	if (++ctx->triedAge >= EXPLORE_FORGET) {
+		forget(ctx);
+	}
+
+	if (ctx->goal < 0 || ++ctx->cycles >= EXPLORE_PERIOD) {
+		rank(ctx, x, y, degree);
+	}
+
+	ctx->newGoal |= (hadGoal && ctx->goal < 0);
+
+	if (ctx->goal >= 0) {
+		ctx->state = EXPLORE_GO;
+	} else {
+		ctx->state = ctx->nFront > 0 ? EXPLORE_SCAN : EXPLORE_DONE;
+	}
+
+	return ctx->state;
+}
+
+void explore_reject_r ( exploreCtx* ctx )
+{
+	if (ctx->goal < 0)
+		return;
+
+	ctx->tried[ctx->goal]++;
+	ctx->goal = -1;
+}
+
+#ifdef EXPLORE_DEFAULT
+
+void explore_init ( void )
+{
+	explore_init_r(&exploreDefault, map_default());
+}
+
+uint explore_update ( void )
+{
+	int  x, y;
+	bool changed;
+	uint state;
+
+	if (plan_state() == PLAN_NO_PATH) {
+		explore_reject_r(&exploreDefault);
+	}
+
+	sensors_position(&x, &y);
+
+	state = explore_update_r(&exploreDefault, x, y, sensors_compass(),
+		sensors_beacon() && sensors_beaconValid(), sensors_beaconBearing());
+
+	if (explore_goal_r(&exploreDefault, &x, &y, &changed)) {
+		if (changed && !plan_setGoal(x, y)) {
+			explore_reject_r(&exploreDefault);
+		}
+	} else if (changed) {
+		plan_stop();
+	}
+
+	return state;
+}
+
+void explore_reject ( void )
+{
+	explore_reject_r(&exploreDefault);
+}
+
+#endif /* EXPLORE_DEFAULT */
+
+
+/* ==========================================================================
+ * Queries
+ */
+
+bool explore_goal_r ( const exploreCtx* ctx, int* x, int* y, bool* changed )
+{
+	if (changed != NULL) {
+		(*changed) = ctx->newGoal;
+	}
+
+	if (ctx->goal < 0)
+		return false;
+
+	if (x != NULL) {
+		(*x) = ctx->goalX;
+	}
+
+	if (y != NULL) {
+		(*y) = ctx->goalY;
+	}
+
+	return true;
+}
+
+uint explore_frontiers_r ( const exploreCtx* ctx )
+{
+	return ctx->nFront;
+}
+
+#ifdef EXPLORE_DEFAULT
+
+bool explore_goal ( int* x, int* y )
+{
+	return explore_goal_r(&exploreDefault, x, y, NULL);
+}
+
+uint explore_frontiers ( void )
+{
+	return explore_frontiers_r(&exploreDefault);
+}
+
+#endif /* EXPLORE_DEFAULT */
+
+
+/* ==========================================================================
+ * Private functions
+ */
+
+/* ===================
+ * Look again at a cell that changed state, and at its neighbours.
+ */
+static void refresh ( exploreCtx* ctx, int cx, int cy )
+{
+	setFront(ctx, cx, cy, isFrontier(ctx, cx, cy));
+
+	if (cx > 0) {
+		setFront(ctx, cx - 1, cy, isFrontier(ctx, cx - 1, cy));
+	}
+
+	if (cx < MAP_SIZE - 1) {
+		setFront(ctx, cx + 1, cy, isFrontier(ctx, cx + 1, cy));
+	}
+
+	if (cy > 0) {
+		setFront(ctx, cx, cy - 1, isFrontier(ctx, cx, cy - 1));
+	}
+
+	if (cy < MAP_SIZE - 1) {
+		setFront(ctx, cx, cy + 1, isFrontier(ctx, cx, cy + 1));
+	}
+}
+
+/* ===================
+ * Choose the goal among the candidate blocks, keeping the current one
+ *  unless another is better by EXPLORE_HYST. Without candidates the
+ *  smaller blocks are, and then the ones given up, so there's always a
+ *  goal while there are frontiers.
+ */
+static void rank ( exploreCtx* ctx, int x, int y, int degree )
+{
+	int b, c, best, bestCost, goalCost;
+	int min = EXPLORE_MIN_CELLS;
+
+	ctx->cycles = 0;
+
+	while (1) {
+		best     = -1;
+		bestCost = 0;
+		goalCost = 0;
+
+		for (b = 0; b < EXPLORE_BLOCKS; b++) {
+			if (ctx->count[b] < min || ctx->tried[b] >= EXPLORE_TRIES)
+				continue;
+
+			c = cost(ctx, b, x, y, degree);
+
+			if (best < 0 || c < bestCost) {
+				best     = b;
+				bestCost = c;
+			}
+
+			if (b == ctx->goal) {
+				goalCost = c;
+			}
+		}
+
+		if (best >= 0 || ctx->nFront == 0)
+			break;
+
+		if (min > 1) {
+			min = 1;
+		} else {
+			forget(ctx);
+		}
+	}
+
+	if (best < 0) {
+		ctx->goal = -1;
+		return;
+	}
+
+	if (ctx->goal >= 0 && ctx->count[ctx->goal] >= min &&
+	    bestCost + EXPLORE_HYST >= goalCost)
+		return;
+
+	setGoal(ctx, best);
+}
+
+/* ===================
+ * Cost (in mm) of going to a block
+ */
+static int cost ( const exploreCtx* ctx, int b, int x, int y, int degree )
+{
+	int n = ctx->count[b];
+	int gx, gy, dx, dy, turn, diff;
+	int c;
+
+	map_cellCenter_r(ctx->map, ctx->sumX[b] / n, ctx->sumY[b] / n, &gx, &gy);
+
+	dx   = gx - x;
+	dy   = gy - y;
+	turn = abs(trig_norm(trig_atan2(dy, dx) - degree * 1000)) / 1000;
+	c    = trig_sqrt(dx * dx + dy * dy) + EXPLORE_K_TURN * turn - EXPLORE_K_SIZE * n +
+	       EXPLORE_K_TRIED * ctx->tried[b];
+
+	/* In the direction of the beacon */
+	if (ctx->beaconOn) {
+		diff = abs(trig_norm(trig_atan2(gy - ctx->beaconY, gx - ctx->beaconX) - ctx->beaconBear * 1000)) / 1000;
+
+		if (diff < EXPLORE_BEACON_CONE) {
+			c -= (EXPLORE_K_BEACON * (EXPLORE_BEACON_CONE - diff)) / EXPLORE_BEACON_CONE;
+		}
+	}
+
+	return c;
+}
+
+/* ===================
+ * Go to the frontier cell of a block closest to the middle of them.
+ */
+static void setGoal ( exploreCtx* ctx, int b )
+{
+	int n  = ctx->count[b];
+	int mx = ctx->sumX[b] / n;
+	int my = ctx->sumY[b] / n;
+	int x0 = (b % EXPLORE_BLOCKS_SIDE) * EXPLORE_BLOCK;
+	int y0 = (b / EXPLORE_BLOCKS_SIDE) * EXPLORE_BLOCK;
+	int cx, cy, d, best = -1, bx = mx, by = my;
+	int gx, gy;
+
+	for (cy = y0; cy < y0 + EXPLORE_BLOCK; cy++) {
+		for (cx = x0; cx < x0 + EXPLORE_BLOCK; cx++) {
+			if (!getFront(ctx, cx, cy))
+				continue;
+
+			d = (cx - mx) * (cx - mx) + (cy - my) * (cy - my);
+
+			if (best < 0 || d < best) {
+				best = d;
+				bx   = cx;
+				by   = cy;
+			}
+		}
+	}
+
+	map_cellCenter_r(ctx->map, bx, by, &gx, &gy);
+
+	if (b != ctx->goal || gx != ctx->goalX || gy != ctx->goalY) {
+		ctx->newGoal = true;
+	}
+
+	ctx->goal  = b;
+	ctx->goalX = gx;
+	ctx->goalY = gy;
+}
+
+/* ===================
+ * Forget the failed tries of all the blocks
+ */
+static void forget ( exploreCtx* ctx )
+{
+	uint b;
+
+	for (b = 0; b < EXPLORE_BLOCKS; b++) {
+		ctx->tried[b] = 0;
+	}
+
+	ctx->triedAge = 0;
+}
+
+/* ===================
+ * A free cell next to an unknown one. Outside the map isn't unknown, the
+ *  robot can't go there.
+ */
+static inline bool isFrontier ( const exploreCtx* ctx, int cx, int cy )
+{
+	if (map_cellState_r(ctx->map, cx, cy) != MAP_FREE)
+		return false;
+
+	return (cx > 0            && map_cellState_r(ctx->map, cx - 1, cy) == MAP_UNKNOWN) ||
+	       (cx < MAP_SIZE - 1 && map_cellState_r(ctx->map, cx + 1, cy) == MAP_UNKNOWN) ||
+	       (cy > 0            && map_cellState_r(ctx->map, cx, cy - 1) == MAP_UNKNOWN) ||
+	       (cy < MAP_SIZE - 1 && map_cellState_r(ctx->map, cx, cy + 1) == MAP_UNKNOWN);
+}
+
+static inline bool getFront ( const exploreCtx* ctx, int cx, int cy )
+{
+	uint i = cy * MAP_SIZE + cx;
+
+	return (ctx->front[i / 32] >> (i % 32)) & 1;
+}
+
+/* ===================
+ * Set the frontier bit of a cell, keeping the counts of its block.
+ */
+static inline void setFront ( exploreCtx* ctx, int cx, int cy, bool on )
+{
+	uint i = cy * MAP_SIZE + cx;
+	int  b = (cy / EXPLORE_BLOCK) * EXPLORE_BLOCKS_SIDE + cx / EXPLORE_BLOCK;
+
+	if (getFront(ctx, cx, cy) == on)
+		return;
+
+	ctx->front[i / 32] ^= 1u << (i % 32);
+
+	if (on) {
+		ctx->nFront++;
+		ctx->count[b]++;
+		ctx->sumX[b] += cx;
+		ctx->sumY[b] += cy;
+	} else {
+		ctx->nFront--;
+		ctx->count[b]--;
+		ctx->sumX[b] -= cx;
+		ctx->sumY[b] -= cy;
+	}
+}
+
+/* ===================
+ * Are two positions less than EXPLORE_REACH apart
+ */
+static inline bool near ( int x0, int y0, int x1, int y1 )
+{
+	if (abs(x1 - x0) >= EXPLORE_REACH || abs(y1 - y0) >= EXPLORE_REACH)
+		return false;
+
+	return trig_sqrt((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0)) < EXPLORE_REACH;
+}
+
+
+/* = EOF ==================================================================== */
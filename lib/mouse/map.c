@@ -0,0 +1,441 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/mouse/map.c
+ *  \brief Implement the occupancy grid.
+ *
+ *  The cells hold the log-odds offset by MAP_BIAS, so they are unsigned
+ *   and an unknown cell is MAP_BIAS.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/map.h>
+#include <conf.h>
+#include <mouse/sensors.h>
+#include <util/trig.h>
+
+
+/* ========================================================================== */
+
+#define MAP_MASK    ((1u << MAP_CELL_BITS) - 1)
+#define MAP_BIAS    (1 << (MAP_CELL_BITS - 1))
+#define MAP_HALF    (MAP_SIZE / 2)
+
+
+/* ===================
+ * Instance used by the non reentrant interface
+ */
+#ifdef MAP_DEFAULT
+static MR_TLS mapCtx mapDefault;
+#endif
+
+
+/* ========================================================================== */
+
+static inline int  getCell   ( const mapCtx* ctx, int cx, int cy );
+static inline void addCell   ( mapCtx* ctx, int cx, int cy, int delta );
+static inline int  cellState ( int value );
+
+static int  readLog ( const ushort* log, uint size, uint end, uint* seq, int* cx, int* cy );
+
+static void castRay ( mapCtx* ctx, int x, int y, int mdegree, int dist );
+
+
+/* ==========================================================================
+ * Management
+ */
+
+void map_clear_r ( mapCtx* ctx, int x, int y )
+{
+	uint fill = 0;
+	int  i;
+
+	for (i = 0; i < MAP_CELL_WORD; i++) {
+		fill |= MAP_BIAS << (i * MAP_CELL_BITS);
+	}
+
+	for (i = 0; i < MAP_WORDS; i++) {
+		ctx->cells[i] = fill;
+	}
+
+	ctx->originX = x;
+	ctx->originY = y;
+
+	/* Readers lose track of the changes, and read the whole map again */
+	ctx->changeSeq += MAP_CHANGES + 1;
+	ctx->stateSeq  += MAP_STATES + 1;
+}
+
+void map_update_r ( mapCtx* ctx, int x, int y, int degree )
+{
+	int obst[3];
+	int i;
+
+	obst[0] = sensors_obstR();
+	obst[1] = sensors_obstF();
+	obst[2] = sensors_obstL();
+
+	/* Sensors from right to left, anticlockwise */
+	for (i = 0; i < 3; i++) {
+		castRay(ctx, x, y, (degree + (i - 1) * OBST_ANGLE) * 1000, obst[i]);
+	}
+}
+
+#ifdef MAP_DEFAULT
+
+mapCtx* map_default ( void )
+{
+	return &mapDefault;
+}
+
+void map_init ( void )
+{
+	map_clear_r(&mapDefault, 0, 0);
+}
+
+void map_clear ( void )
+{
+	int x, y;
+
+	sensors_position(&x, &y);
+
+	map_clear_r(&mapDefault, x, y);
+}
+
+void map_update ( void )
+{
+	int x, y;
+
+	sensors_position(&x, &y);
+
+	map_update_r(&mapDefault, x, y, sensors_compass());
+}
+
+#endif /* MAP_DEFAULT */
+
+
+/* ==========================================================================
+ * Queries
+ */
+
+bool map_toCell_r ( const mapCtx* ctx, int x, int y, int* cx, int* cy )
+{
+	int i = floorDiv(x - ctx->originX, MAP_CELL) + MAP_HALF;
+	int j = floorDiv(y - ctx->originY, MAP_CELL) + MAP_HALF;
+
+	if (i < 0 || i >= MAP_SIZE || j < 0 || j >= MAP_SIZE)
+		return false;
+
+	if (cx != NULL) {
+		(*cx) = i;
+	}
+
+	if (cy != NULL) {
+		(*cy) = j;
+	}
+
+	return true;
+}
+
+void map_cellCenter_r ( const mapCtx* ctx, int cx, int cy, int* x, int* y )
+{
+	if (x != NULL) {
+		(*x) = ctx->originX + (cx - MAP_HALF) * MAP_CELL + MAP_CELL / 2;
+	}
+
+	if (y != NULL) {
+		(*y) = ctx->originY + (cy - MAP_HALF) * MAP_CELL + MAP_CELL / 2;
+	}
+}
+
+int map_logOdds_r ( const mapCtx* ctx, int cx, int cy )
+{
+	if (cx < 0 || cx >= MAP_SIZE || cy < 0 || cy >= MAP_SIZE)
+		return 0;
+
+	return getCell(ctx, cx, cy) - MAP_BIAS;
+}
+
+int map_cellState_r ( const mapCtx* ctx, int cx, int cy )
+{
+	if (cx < 0 || cx >= MAP_SIZE || cy < 0 || cy >= MAP_SIZE)
+		return MAP_UNKNOWN;
+
+	return cellState(getCell(ctx, cx, cy));
+}
+
+int map_state_r ( const mapCtx* ctx, int x, int y )
+{
+	int cx, cy;
+
+	if (!map_toCell_r(ctx, x, y, &cx, &cy))
+		return MAP_UNKNOWN;
+
+	return map_cellState_r(ctx, cx, cy);
+}
+
+int map_nearest_r ( const mapCtx* ctx, int x, int y, int degree, int maxDist )
+{
+	int x0, y0, x1, y1;
+	int dx, dy, sx, sy, err, e2;
+	int steps, n;
+
+	x1 = x + (maxDist * trig_cos(degree * 1000)) / TRIG_ONE;
+	y1 = y + (maxDist * trig_sin(degree * 1000)) / TRIG_ONE;
+
+	x0 = floorDiv(x  - ctx->originX, MAP_CELL) + MAP_HALF;
+	y0 = floorDiv(y  - ctx->originY, MAP_CELL) + MAP_HALF;
+	x1 = floorDiv(x1 - ctx->originX, MAP_CELL) + MAP_HALF;
+	y1 = floorDiv(y1 - ctx->originY, MAP_CELL) + MAP_HALF;
+
+	dx  =  abs(x1 - x0);
+	dy  = -abs(y1 - y0);
+	sx  = x0 < x1 ? 1 : -1;
+	sy  = y0 < y1 ? 1 : -1;
+	err = dx + dy;
+
+	steps = dx > -dy ? dx : -dy;
+
+	/* Distances are interpolated along the ray, one step per cell */
+	for (n = 0; n <= steps; n++) {
+		if (x0 < 0 || x0 >= MAP_SIZE || y0 < 0 || y0 >= MAP_SIZE)
+			break;
+
+		if (map_cellState_r(ctx, x0, y0) == MAP_OCCUPIED)
+			return steps ? (n * maxDist) / steps : 0;
+
+		e2 = 2 * err;
+
+		if (e2 >= dy) {
+			err += dy;
+			x0  += sx;
+		}
+
+		if (e2 <= dx) {
+			err += dx;
+			y0  += sy;
+		}
+	}
+
+	return -1;
+}
+
+int map_changes_r ( const mapCtx* ctx, uint* seq, int* cx, int* cy )
+{
+	return readLog(ctx->changes, MAP_CHANGES, ctx->changeSeq, seq, cx, cy);
+}
+
+uint map_changeSeq_r ( const mapCtx* ctx )
+{
+	return ctx->changeSeq;
+}
+
+int map_stateChanges_r ( const mapCtx* ctx, uint* seq, int* cx, int* cy )
+{
+	return readLog(ctx->states, MAP_STATES, ctx->stateSeq, seq, cx, cy);
+}
+
+uint map_stateSeq_r ( const mapCtx* ctx )
+{
+	return ctx->stateSeq;
+}
+
+#ifdef MAP_DEFAULT
+
+bool map_toCell ( int x, int y, int* cx, int* cy )
+{
+	return map_toCell_r(&mapDefault, x, y, cx, cy);
+}
+
+void map_cellCenter ( int cx, int cy, int* x, int* y )
+{
+	map_cellCenter_r(&mapDefault, cx, cy, x, y);
+}
+
+int map_logOdds ( int cx, int cy )
+{
+	return map_logOdds_r(&mapDefault, cx, cy);
+}
+
+int map_cellState ( int cx, int cy )
+{
+	return map_cellState_r(&mapDefault, cx, cy);
+}
+
+int map_state ( int x, int y )
+{
+	return map_state_r(&mapDefault, x, y);
+}
+
+int map_nearest ( int x, int y, int degree, int maxDist )
+{
+	return map_nearest_r(&mapDefault, x, y, degree, maxDist);
+}
+
+int map_changes ( uint* seq, int* cx, int* cy )
+{
+	return map_changes_r(&mapDefault, seq, cx, cy);
+}
+
+uint map_changeSeq ( void )
+{
+	return map_changeSeq_r(&mapDefault);
+}
+
+int map_stateChanges ( uint* seq, int* cx, int* cy )
+{
+	return map_stateChanges_r(&mapDefault, seq, cx, cy);
+}
+
+uint map_stateSeq ( void )
+{
+	return map_stateSeq_r(&mapDefault);
+}
+
+#endif /* MAP_DEFAULT */
+
+
+/* ========================================================================== */
+
+/* ===================
+ * Cast a sensor ray, dist is the sensor reading (in cm).
+ *
+ *  The cells from the sensor to the obstacle are missed, the one of the
+ *   obstacle is hit. When nothing was seen the whole range is missed.
+ */
+static void castRay ( mapCtx* ctx, int x, int y, int mdegree, int dist )
+{
+	int c = trig_cos(mdegree);
+	int s = trig_sin(mdegree);
+	int x0, y0, x1, y1;
+	int dx, dy, sx, sy, err, e2;
+	bool hit = (dist != OBST_SENS_INFINITE);
+
+	dist = hit ? dist * 10 : OBST_RANGE * 10;
+
+	x0 = floorDiv(x + (OBST_OFFSET * c) / TRIG_ONE - ctx->originX, MAP_CELL) + MAP_HALF;
+	y0 = floorDiv(y + (OBST_OFFSET * s) / TRIG_ONE - ctx->originY, MAP_CELL) + MAP_HALF;
+	x1 = floorDiv(x + ((OBST_OFFSET + dist) * c) / TRIG_ONE - ctx->originX, MAP_CELL) + MAP_HALF;
+	y1 = floorDiv(y + ((OBST_OFFSET + dist) * s) / TRIG_ONE - ctx->originY, MAP_CELL) + MAP_HALF;
+
+	dx  =  abs(x1 - x0);
+	dy  = -abs(y1 - y0);
+	sx  = x0 < x1 ? 1 : -1;
+	sy  = y0 < y1 ? 1 : -1;
+	err = dx + dy;
+
+	while (x0 >= 0 && x0 < MAP_SIZE && y0 >= 0 && y0 < MAP_SIZE) {
+		if (x0 == x1 && y0 == y1) {
+			addCell(ctx, x0, y0, hit ? MAP_HIT : -MAP_MISS);
+			break;
+		}
+
+		addCell(ctx, x0, y0, -MAP_MISS);
+
+		e2 = 2 * err;
+
+		if (e2 >= dy) {
+			err += dy;
+			x0  += sx;
+		}
+
+		if (e2 <= dx) {
+			err += dx;
+			y0  += sy;
+		}
+	}
+}
+
+static inline int getCell ( const mapCtx* ctx, int cx, int cy )
+{
+	uint i = cy * MAP_SIZE + cx;
+
+	return (ctx->cells[i / MAP_CELL_WORD] >> ((i % MAP_CELL_WORD) * MAP_CELL_BITS)) & MAP_MASK;
+}
+
+/* ===================
+ * Add to the log-odds of a cell, saturating at the range of the cell bits.
+ *  Cells that become occupied, or stop being so, are logged, and so are
+ *  all the state changes.
+ */
+static inline void addCell ( mapCtx* ctx, int cx, int cy, int delta )
+{
+	uint i     = cy * MAP_SIZE + cx;
+	uint shift = (i % MAP_CELL_WORD) * MAP_CELL_BITS;
+	uint* word = ctx->cells + i / MAP_CELL_WORD;
+	int  old   = ((*word) >> shift) & MAP_MASK;
+	int  value = old + delta;
+	bool crossOcc, crossFree;
+
+	value = value < 0 ? 0 : (value > (int) MAP_MASK ? (int) MAP_MASK : value);
+
+	(*word) = ((*word) & ~(MAP_MASK << shift)) | ((uint) value << shift);
+
+	/* Crossing the occupied level, and the free one */
+	crossOcc  = (old >= MAP_BIAS + MAP_OCC_LEVEL)  != (value >= MAP_BIAS + MAP_OCC_LEVEL);
+	crossFree = (old <= MAP_BIAS + MAP_FREE_LEVEL) != (value <= MAP_BIAS + MAP_FREE_LEVEL);
+
+	if (crossOcc) {
+		ctx->changes[ctx->changeSeq % MAP_CHANGES] = i;
+		ctx->changeSeq++;
+	}
+
+	if (crossOcc || crossFree) {
+		ctx->states[ctx->stateSeq % MAP_STATES] = i;
+		ctx->stateSeq++;
+	}
+}
+
+/* ===================
+ * State of a cell value (log-odds plus MAP_BIAS).
+ */
+static inline int cellState ( int value )
+{
+	if (value >= MAP_BIAS + MAP_OCC_LEVEL)
+		return MAP_OCCUPIED;
+
+	if (value <= MAP_BIAS + MAP_FREE_LEVEL)
+		return MAP_FREE;
+
+	return MAP_UNKNOWN;
+}
+
+/* ===================
+ * Read the next entry of a change log of the given size, end being the
+ *  number of changes logged.
+ */
+static int readLog ( const ushort* log, uint size, uint end, uint* seq, int* cx, int* cy )
+{
+	uint i;
+
+	if ((*seq) == end)
+		return 0;
+
+	if (end - (*seq) > size) {
+		(*seq) = end;
+		return -1;
+	}
+
+	i = log[(*seq) % size];
+	(*seq)++;
+
+	if (cx != NULL) {
+		(*cx) = i % MAP_SIZE;
+	}
+
+	if (cy != NULL) {
+		(*cy) = i / MAP_SIZE;
+	}
+
+	return 1;
+}
+
+
+/* = EOF ==================================================================== */
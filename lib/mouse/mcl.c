@@ -0,0 +1,617 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/mouse/mcl.c
+ *  \brief Implement the Monte Carlo localization.
+ *
+ *  The distance grid is a chamfer distance transform of the cells the walls
+ *   go through: two passes over the grid, each cell taking the smallest of
+ *   its distance and the ones of the neighbours already passed plus the
+ *   step to them. The weight of a reading for each distance d of its end
+ *   to a wall is MCL_FLOOR plus the rest scaled by s^2 / (s^2 + d^2), which
+ *   falls slower than a gaussian, so a wall a little off doesn't kill a
+ *   good particle.
+ *
+ *  The particles are drawn again with low variance sampling: a single
+ *   random offset, then evenly spaced through the sum of the weights, so a
+ *   particle with a weight w of a sum s is drawn n * w / s times, rounded
+ *   either way.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/mcl.h>
+#include <conf.h>
+#include <mouse/sensors.h>
+#include <util/trig.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Distance (in cm) between the centers of neighbour cells of the
+ *   grid, side by side and across a corner.
+ */
+#define STEP_SIDE    ((MCL_CELL + 5) / 10)
+#define STEP_CORNER  ((MCL_CELL * 141 + 500) / 1000)
+
+/**
+ *  \brief Largest distance (in cm) of the grid.
+ */
+#define DIST_MAX     255
+
+
+/* ===================
+ * Instance used by the non reentrant interface
+ */
+#ifdef MCL_DEFAULT
+static MR_TLS mclCtx mclDefault;
+#endif
+
+
+/* ========================================================================== */
+
+static void build     ( mclCtx* ctx );
+static void move      ( mclCtx* ctx, int dist, int turn );
+static void weigh     ( mclCtx* ctx );
+static void resample  ( mclCtx* ctx, uint n );
+static void estimate  ( mclCtx* ctx );
+static uint effective ( const mclCtx* ctx );
+
+static int segDist ( int x, int y, int x0, int y0, int x1, int y1 );
+
+static inline int  cellDist ( const mclCtx* ctx, int x, int y );
+static inline int  shorter  ( int d, int other );
+static inline int  unscale  ( int value );
+static inline int  noise    ( mclCtx* ctx, int amplitude );
+static inline uint rnd      ( mclCtx* ctx );
+
+
+/* ==========================================================================
+ * Management
+ */
+
+void mcl_init_r ( mclCtx* ctx )
+{
+	int d;
+
+	for (d = 0; d <= DIST_MAX; d++) {
+		ctx->weight[d] = MCL_FLOOR + ((255 - MCL_FLOOR) * MCL_SIGMA * MCL_SIGMA) /
+		                             (MCL_SIGMA * MCL_SIGMA + d * d);
+	}
+
+	for (d = 0; d < MCL_GRID * MCL_GRID; d++) {
+		ctx->dist[d] = DIST_MAX;
+	}
+
+	ctx->width  = 0;
+	ctx->height = 0;
+	ctx->built  = true;
+	ctx->n      = MCL_PARTICLES;
+	ctx->seed   = 2463534242u;           // Any but 0
+
+	mcl_setPose_r(ctx, 0, 0, 0, 0, 0);
+}
+
+void mcl_setArena_r ( mclCtx* ctx, int width, int height )
+{
+	int max = (MCL_GRID - 1) * MCL_CELL;
+	int i;
+
+	ctx->width  = width  < 0 ? 0 : (width  > max ? max : width);
+	ctx->height = height < 0 ? 0 : (height > max ? max : height);
+
+	for (i = 0; i < MCL_GRID * MCL_GRID; i++) {
+		ctx->dist[i] = DIST_MAX;
+	}
+
+	mcl_addWall_r(ctx, 0, 0, ctx->width, 0);
+	mcl_addWall_r(ctx, ctx->width, 0, ctx->width, ctx->height);
+	mcl_addWall_r(ctx, ctx->width, ctx->height, 0, ctx->height);
+	mcl_addWall_r(ctx, 0, ctx->height, 0, 0);
+}
+
+void mcl_addWall_r ( mclCtx* ctx, int x0, int y0, int x1, int y1 )
+{
+	int cx0 = x0 / MCL_CELL;
+	int cy0 = y0 / MCL_CELL;
+	int cx1 = x1 / MCL_CELL;
+	int cy1 = y1 / MCL_CELL;
+	int dx, dy, sx, sy, err, e2;
+	int i, j;
+
+	dx  =  abs(cx1 - cx0);
+	dy  = -abs(cy1 - cy0);
+	sx  = cx0 < cx1 ? 1 : -1;
+	sy  = cy0 < cy1 ? 1 : -1;
+	err = dx + dy;
+
+	/* The cells the wall goes through and their neighbours, with the
+	 *  distance of their center to it */
+	while (1) {
+		for (j = cy0 - 1; j <= cy0 + 1; j++) {
+			for (i = cx0 - 1; i <= cx0 + 1; i++) {
+				if (i >= 0 && i < MCL_GRID && j >= 0 && j < MCL_GRID) {
+					ctx->dist[j * MCL_GRID + i] = shorter(ctx->dist[j * MCL_GRID + i],
+						segDist(i * MCL_CELL + MCL_CELL / 2, j * MCL_CELL + MCL_CELL / 2,
+						        x0, y0, x1, y1) / 10);
+				}
+			}
+		}
+
+		if (cx0 == cx1 && cy0 == cy1)
+			break;
+
+		e2 = 2 * err;
+
+		if (e2 >= dy) {
+			err += dy;
+			cx0 += sx;
+		}
+
+		if (e2 <= dx) {
+			err += dx;
+			cy0 += sy;
+		}
+	}
+
+	ctx->built = false;
+}
+
+void mcl_setPose_r ( mclCtx* ctx, int x, int y, int degree, int errDist, int errAngle )
+{
+	uint i;
+
+	if (!ctx->built) {
+		build(ctx);
+	}
+
+	for (i = 0; i < ctx->n; i++) {
+		ctx->pX[i] = x + noise(ctx, errDist);
+		ctx->pY[i] = y + noise(ctx, errDist);
+		ctx->pA[i] = trig_norm(degree * 1000 + noise(ctx, errAngle * 1000));
+		ctx->pW[i] = MCL_ONE;
+	}
+
+	ctx->odoOn  = false;
+	ctx->bumped = false;
+
+	estimate(ctx);
+}
+
+bool mcl_update_r ( mclCtx* ctx, int x, int y, int degree )
+{
+	int dx, dy, turn, mid, dist;
+
+	ctx->bumped |= sensors_bump();
+
+	if (!ctx->odoOn) {
+		ctx->odoOn  = true;
+		ctx->odoX   = x;
+		ctx->odoY   = y;
+		ctx->odoDeg = degree;
+		return false;
+	}
+
+	dx   = x - ctx->odoX;
+	dy   = y - ctx->odoY;
+	turn = trig_norm((degree - ctx->odoDeg) * 1000);
+
+	if (dx * dx + dy * dy < MCL_STEP_DIST * MCL_STEP_DIST && abs(turn) < MCL_STEP_ANGLE * 1000)
+		return false;
+
+	/* Along the mean heading, the wheels don't move sideways */
+	mid  = ctx->odoDeg * 1000 + turn / 2;
+	dist = unscale(dx * trig_cos(mid) + dy * trig_sin(mid));
+
+	ctx->odoX   = x;
+	ctx->odoY   = y;
+	ctx->odoDeg = degree;
+
+	move(ctx, dist, turn);
+	weigh(ctx);
+
+	ctx->bumped = false;
+
+	if (effective(ctx) * 100 < ctx->n * MCL_RESAMPLE) {
+		resample(ctx, ctx->n);
+	}
+
+	estimate(ctx);
+
+	return true;
+}
+
+void mcl_setParticles_r ( mclCtx* ctx, uint n )
+{
+	n = n < 1 ? 1 : (n > MCL_PARTICLES ? MCL_PARTICLES : n);
+
+	resample(ctx, n);
+	estimate(ctx);
+}
+
+#ifdef MCL_DEFAULT
+
+void mcl_init ( void )
+{
+	mcl_init_r(&mclDefault);
+}
+
+void mcl_setArena ( int width, int height )
+{
+	mcl_setArena_r(&mclDefault, width, height);
+}
+
+void mcl_addWall ( int x0, int y0, int x1, int y1 )
+{
+	mcl_addWall_r(&mclDefault, x0, y0, x1, y1);
+}
+
+void mcl_setPose ( int x, int y, int degree, int errDist, int errAngle )
+{
+	mcl_setPose_r(&mclDefault, x, y, degree, errDist, errAngle);
+}
+
+bool mcl_update ( void )
+{
+	int x, y;
+
+	sensors_position(&x, &y);
+
+	return mcl_update_r(&mclDefault, x, y, sensors_compass());
+}
+
+void mcl_setParticles ( uint n )
+{
+	mcl_setParticles_r(&mclDefault, n);
+}
+
+#endif /* MCL_DEFAULT */
+
+
+/* ==========================================================================
+ * Queries
+ */
+
+uint mcl_pose_r ( const mclCtx* ctx, int* x, int* y, int* degree )
+{
+	if (x != NULL) {
+		(*x) = ctx->estX;
+	}
+
+	if (y != NULL) {
+		(*y) = ctx->estY;
+	}
+
+	if (degree != NULL) {
+		(*degree) = ctx->estDeg;
+	}
+
+	return ctx->spread;
+}
+
+uint mcl_particles_r ( const mclCtx* ctx )
+{
+	return ctx->n;
+}
+
+#ifdef MCL_DEFAULT
+
+uint mcl_pose ( int* x, int* y, int* degree )
+{
+	return mcl_pose_r(&mclDefault, x, y, degree);
+}
+
+uint mcl_particles ( void )
+{
+	return mcl_particles_r(&mclDefault);
+}
+
+#endif /* MCL_DEFAULT */
+
+
+/* ==========================================================================
+ * Private functions
+ */
+
+/* ===================
+ * Distance transform of the wall cells, in two passes.
+ */
+static void build ( mclCtx* ctx )
+{
+	uchar* c;
+	int    x, y, d;
+
+	/* From the cells above and on the left */
+	for (y = 0; y < MCL_GRID; y++) {
+		for (x = 0; x < MCL_GRID; x++) {
+			c = ctx->dist + y * MCL_GRID + x;
+			d = c[0];
+
+			if (x > 0) {
+				d = shorter(d, c[-1] + STEP_SIDE);
+			}
+
+			if (y > 0) {
+				d = shorter(d, c[-MCL_GRID] + STEP_SIDE);
+				d = x > 0            ? shorter(d, c[-MCL_GRID - 1] + STEP_CORNER) : d;
+				d = x < MCL_GRID - 1 ? shorter(d, c[-MCL_GRID + 1] + STEP_CORNER) : d;
+			}
+
+			c[0] = d;
+		}
+	}
+
+	/* From the cells below and on the right */
+	for (y = MCL_GRID - 1; y >= 0; y--) {
+		for (x = MCL_GRID - 1; x >= 0; x--) {
+			c = ctx->dist + y * MCL_GRID + x;
+			d = c[0];
+
+			if (x < MCL_GRID - 1) {
+				d = shorter(d, c[1] + STEP_SIDE);
+			}
+
+			if (y < MCL_GRID - 1) {
+				d = shorter(d, c[MCL_GRID] + STEP_SIDE);
+				d = x < MCL_GRID - 1 ? shorter(d, c[MCL_GRID + 1] + STEP_CORNER) : d;
+				d = x > 0            ? shorter(d, c[MCL_GRID - 1] + STEP_CORNER) : d;
+			}
+
+			c[0] = d;
+		}
+	}
+
+	ctx->built = true;
+}
+
+/* ===================
+ * Move the particles by the odometry, with a triangular noise up to the
+ *  largest error.
+ */
+static void move ( mclCtx* ctx, int dist, int turn )
+{
+	int  k    = ctx->bumped ? MCL_K_BUMP : 1;
+	int  errD = k * (abs(dist) * MCL_NOISE_DIST / 100);
+	int  errA = k * (abs(turn) * MCL_NOISE_TURN / 100 + abs(dist) * MCL_NOISE_DRIFT * 10);
+	int  d, a, mid;
+	uint i;
+
+	for (i = 0; i < ctx->n; i++) {
+		d   = dist + (noise(ctx, errD) + noise(ctx, errD)) / 2;
+		a   = turn + (noise(ctx, errA) + noise(ctx, errA)) / 2;
+		mid = ctx->pA[i] + a / 2;
+
+		ctx->pX[i] += unscale(d * trig_cos(mid));
+		ctx->pY[i] += unscale(d * trig_sin(mid));
+		ctx->pA[i]  = trig_norm(ctx->pA[i] + a);
+	}
+}
+
+/* ===================
+ * Weight the particles by the readings, and scale the weights so that the
+ *  largest is in [MCL_ONE, 2 * MCL_ONE[.
+ */
+static void weigh ( mclCtx* ctx )
+{
+	int  reach[3];
+	int  i, a;
+	uint p, w, max = 0, shift = 0;
+
+	reach[0] = sensors_obstR();
+	reach[1] = sensors_obstF();
+	reach[2] = sensors_obstL();
+
+	for (i = 0; i < 3; i++) {
+		reach[i] = reach[i] == OBST_SENS_INFINITE ? 0 : OBST_OFFSET + reach[i] * 10;
+	}
+
+	for (p = 0; p < ctx->n; p++) {
+		/* Out of the arena, or too close to a wall */
+		if (ctx->pX[p] <= 0 || ctx->pX[p] >= ctx->width ||
+		    ctx->pY[p] <= 0 || ctx->pY[p] >= ctx->height ||
+		    cellDist(ctx, ctx->pX[p], ctx->pY[p]) * 10 < MCL_RADIUS) {
+			ctx->pW[p] = 0;
+			continue;
+		}
+
+		w = ctx->pW[p];
+
+		/* Sensors from right to left, anticlockwise */
+		for (i = 0; i < 3; i++) {
+			if (reach[i] == 0)
+				continue;
+
+			a = ctx->pA[p] + (i - 1) * OBST_ANGLE * 1000;
+			w = (w * ctx->weight[cellDist(ctx,
+				ctx->pX[p] + unscale(reach[i] * trig_cos(a)),
+				ctx->pY[p] + unscale(reach[i] * trig_sin(a)))]) >> 8;
+		}
+
+		ctx->pW[p] = w;
+		max = w > max ? w : max;
+	}
+
+	/* None is possible, start again from all of them */
+	if (max == 0) {
+		for (p = 0; p < ctx->n; p++) {
+			ctx->pW[p] = MCL_ONE;
+		}
+
+		return;
+	}
+
+	while ((max << shift) < MCL_ONE) {
+		shift++;
+	}
+
+	for (p = 0; p < ctx->n; p++) {
+		ctx->pW[p] <<= shift;
+	}
+}
+
+/* ===================
+ * Draw n particles, in proportion to their weights.
+ */
+static void resample ( mclCtx* ctx, uint n )
+{
+	uint sum = 0, step, u, c, p, i = 0;
+
+	for (p = 0; p < ctx->n; p++) {
+		sum += ctx->pW[p];
+	}
+
+	step = sum / n;
+	u    = step > 0 ? rnd(ctx) % step : 0;
+	c    = ctx->pW[0];
+
+	for (p = 0; p < n; p++, u += step) {
+		while (u >= c && i < ctx->n - 1) {
+			c += ctx->pW[++i];
+		}
+
+		ctx->tX[p] = ctx->pX[i];
+		ctx->tY[p] = ctx->pY[i];
+		ctx->tA[p] = ctx->pA[i];
+	}
+
+	for (p = 0; p < n; p++) {
+		ctx->pX[p] = ctx->tX[p];
+		ctx->pY[p] = ctx->tY[p];
+		ctx->pA[p] = ctx->tA[p];
+		ctx->pW[p] = MCL_ONE;
+	}
+
+	ctx->n = n;
+}
+
+/* ===================
+ * Weighted mean of the particles, the heading from the mean of its sine
+ *  and cosine, and mean distance to it. The weights are taken to 8 bits.
+ */
+static void estimate ( mclCtx* ctx )
+{
+	int  sumX = 0, sumY = 0, sumC = 0, sumS = 0;
+	int  a, dx, dy;
+	uint sum = 0, spread = 0, v, p;
+
+	for (p = 0; p < ctx->n; p++) {
+		v     = ctx->pW[p] >> 8;
+		sum  += v;
+		sumX += (int) v * ctx->pX[p];
+		sumY += (int) v * ctx->pY[p];
+		sumC += (int) v * trig_cos(ctx->pA[p]);
+		sumS += (int) v * trig_sin(ctx->pA[p]);
+	}
+
+	if (sum == 0)
+		return;
+
+	a = trig_atan2(sumS, sumC);
+
+	ctx->estX   = sumX / (int) sum;
+	ctx->estY   = sumY / (int) sum;
+	ctx->estDeg = (a + (a < 0 ? -500 : 500)) / 1000;
+
+	for (p = 0; p < ctx->n; p++) {
+		dx      = ctx->pX[p] - ctx->estX;
+		dy      = ctx->pY[p] - ctx->estY;
+		spread += (ctx->pW[p] >> 8) * trig_sqrt(dx * dx + dy * dy);
+	}
+
+	ctx->spread = spread / sum;
+}
+
+/* ===================
+ * Effective number of particles, (sum w)^2 / sum w^2, with the weights
+ *  taken to 8 bits.
+ */
+static uint effective ( const mclCtx* ctx )
+{
+	uint sum = 0, sq = 0, v, p;
+
+	for (p = 0; p < ctx->n; p++) {
+		v    = ctx->pW[p] >> 8;
+		sum += v;
+		sq  += v * v;
+	}
+
+	return sq > 0 ? sum * sum / sq : 0;
+}
+
+/* ===================
+ * Distance (in mm) of a point to a segment.
+ */
+static int segDist ( int x, int y, int x0, int y0, int x1, int y1 )
+{
+	int dx   = x1 - x0;
+	int dy   = y1 - y0;
+	int len  = dx * dx + dy * dy;
+	int t    = (x - x0) * dx + (y - y0) * dy;
+	int dist = (x - x0) * dy - (y - y0) * dx;
+
+	/* Beyond an end, or along the segment (the cross product over its
+	 *  length) */
+	if (len == 0 || t <= 0)
+		return trig_sqrt((x - x0) * (x - x0) + (y - y0) * (y - y0));
+
+	if (t >= len)
+		return trig_sqrt((x - x1) * (x - x1) + (y - y1) * (y - y1));
+
+	return abs(dist) / trig_sqrt(len);
+}
+
+/* ===================
+ * Distance (in cm) to the nearest wall from a position (in mm), the most
+ *  out of the grid.
+ */
+static inline int cellDist ( const mclCtx* ctx, int x, int y )
+{
+	if (x < 0 || y < 0 || x >= MCL_GRID * MCL_CELL || y >= MCL_GRID * MCL_CELL)
+		return DIST_MAX;
+
+	return ctx->dist[(y / MCL_CELL) * MCL_GRID + x / MCL_CELL];
+}
+
+static inline int shorter ( int d, int other )
+{
+	return other < d ? other : d;
+}
+
+/* ===================
+ * Value scaled by TRIG_ONE, rounded: truncating the small steps of each
+ *  update would add up to a drift.
+ */
+static inline int unscale ( int value )
+{
+	return (value + (value < 0 ? -TRIG_ONE / 2 : TRIG_ONE / 2)) / TRIG_ONE;
+}
+
+/* ===================
+ * Uniform noise in [-amplitude, amplitude].
+ */
+static inline int noise ( mclCtx* ctx, int amplitude )
+{
+	return amplitude > 0 ? (int) (rnd(ctx) % (2 * amplitude + 1)) - amplitude : 0;
+}
+
+/* ===================
+ * Random number (xorshift32).
+ */
+static inline uint rnd ( mclCtx* ctx )
+{
+	ctx->seed ^= ctx->seed << 13;
+	ctx->seed ^= ctx->seed >> 17;
+	ctx->seed ^= ctx->seed << 5;
+
+	return ctx->seed;
+}
+
+
+/* = EOF ==================================================================== */
@@ -15,7 +15,36 @@
 
 #include <base.h>
 #include <mouse/mouse.h>
+#include <conf.h>
 #include <hal/robot.h>
+#include <util/mlog.h>
+#include <util/jobs.h>
+#include <util/rec.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Timer 2 tick period in microseconds.
+ */
+#define TICK_US  10000
+
+static MR_TLS bool started = false;         // A deadline was set
+static MR_TLS uint due     = 0;             // Tick at which the cycle ends
+static MR_TLS uint mode    = MOUSE_NORMAL;
+static MR_TLS bool wdtOn   = false;
+
+static MR_TLS mouseCycleStats stats;
+
+
+/* ========================================================================== */
+
+static void waitStep   ( uint period );
+static uint slack      ( void );
+static uint mlogJob    ( void* arg, uint budgetUs );
+static void account    ( uint late, uint period );
+static void enterMode  ( uint newMode );
+static uint levelMode  ( uint level );
 
 
 /* ========================================================================== */
@@ -23,6 +52,22 @@
 void mouse_init ( void )
 {
 	robot_init();
+	mlog_init();
+
+	jobs_init();
+	jobs_add("mlog", mlogJob, NULL);
+
+	started = false;
+	mode    = MOUSE_NORMAL;
+	wdtOn   = false;
+
+	mouse_cycleReset();
+	stats.level = 0;
+
+#ifdef WATCHDOG
+	robot_wdtEnable();
+	wdtOn = true;
+#endif
 }
 
 
@@ -30,28 +75,207 @@ void mouse_init ( void )
  * Timer
  */
 
-inline void waitStep10ms ( void )
+inline void mouse_waitStep10ms ( void )
+{
+	waitStep(1);
+}
+
+inline void mouse_waitStep20ms ( void )
+{
+	waitStep(2);
+}
+
+inline void mouse_waitStep40ms ( void )
+{
+	waitStep(4);
+}
+
+inline void mouse_waitStep80ms ( void )
+{
+	waitStep(8);
+}
+
+
+/* ==========================================================================
+ * Overruns
+ */
+
+uint mouse_mode ( void )
+{
+	return mode;
+}
+
+void mouse_setMode ( uint newMode )
+{
+	static const uint levels[] = {0, OVERRUN_SHED, OVERRUN_SLOW, OVERRUN_SAFE};
+
+	newMode = newMode > MOUSE_SAFE ? MOUSE_SAFE : newMode;
+
+	stats.level = levels[newMode];
+	enterMode(newMode);
+}
+
+void mouse_cycleStats ( mouseCycleStats* stats_ )
+{
+	if (stats_ != NULL) {
+		(*stats_) = stats;
+	}
+}
+
+void mouse_cycleReset ( void )
+{
+	started = false;
+
+	stats.cycles   = 0;
+	stats.overruns = 0;
+	stats.missed   = 0;
+	stats.late     = 0;
+	stats.maxLate  = 0;
+	stats.ticks    = 1;
+}
+
+int mouse_perTick ( int value )
+{
+	int ticks = stats.ticks;
+
+	if (ticks <= 1)
+		return value;
+
+	return (value + (value < 0 ? -ticks : ticks) / 2) / ticks;
+}
+
+
+/* ==========================================================================
+ * Helper functions
+ */
+
+/* ===================
+ * Wait for the end of the cycle, period in ticks
+ */
+static void waitStep ( uint period )
 {
-	while(!ticker.tick10ms);
-	ticker.tick10ms = 0;
+	uint now, us;
+	uint late = 0;
+
+	do {                                    // Both from the same tick
+		now = robot_ticks();
+		us  = robot_tickTime();
+	} while (now != robot_ticks());
+
+	if (!started) {                         // Start on the next tick
+		due     = now + 1;
+		started = true;
+	}
+
+	if ((int) (now - due) < 0) {
+		while ((int) (robot_ticks() - due) < 0) {
+			jobs_run(slack());              // Use the slack for the jobs
+			robot_idle();
+		}
+	} else {
+		late = (now - due) * TICK_US + us;  // The deadline tick already passed
+		due  = now;
+	}
+
+	late = rec_cycle(late);                 // The recorded one when replaying
+
+	due += period;
+	account(late, period);
+	jobs_cycle();
+
+	if (wdtOn && mode != MOUSE_SAFE) {
+		robot_wdtClear();
+	}
 }
 
-inline void waitStep20ms ( void )
+/* ===================
+ * Time left to the deadline, in microseconds
+ */
+static uint slack ( void )
 {
-	while(!ticker.tick10ms);
-	ticker.tick10ms = 0;
+	uint now, left;
+
+	do {                                    // Both from the same tick
+		now  = robot_ticks();
+		left = robot_tickLeft();
+	} while (now != robot_ticks());
+
+	return (int) (due - now) > 0 ? (due - now - 1) * TICK_US + left : 0;
 }
 
-inline void waitStep40ms ( void )
+/* ===================
+ * Send the log on the serial port
+ */
+static uint mlogJob ( void* arg, uint budgetUs )
 {
-	while(!ticker.tick10ms);
-	ticker.tick10ms = 0;
+	return mlog_drain();
 }
 
-inline void waitStep80ms ( void )
+/* ===================
+ * Account a cycle and update the operating mode
+ */
+static void account ( uint late, uint period )
 {
-	while(!ticker.tick10ms);
-	ticker.tick10ms = 0;
+	uint newMode;
+
+	stats.cycles++;
+	stats.late  = late;
+	stats.ticks = period + late / TICK_US;
+
+	if (late > 0) {
+		stats.overruns++;
+		stats.missed += late / TICK_US;
+		stats.maxLate = late > stats.maxLate ? late : stats.maxLate;
+
+		stats.level += OVERRUN_COST;
+		stats.level  = stats.level > OVERRUN_SAFE ? OVERRUN_SAFE : stats.level;
+	} else if (stats.level > 0) {
+		stats.level--;
+	}
+
+	if (mode == MOUSE_SAFE)
+		return;
+
+	/* Go up as soon as a threshold is reached, and down only when the level
+	 * drops below half of it */
+	newMode = levelMode(stats.level);
+
+	if (newMode < mode) {
+		newMode = levelMode(2 * stats.level);
+		newMode = newMode > mode ? mode : newMode;
+	}
+
+	if (newMode != mode) {
+		mlogWarn(MLOG_MODE, newMode, late, stats.level);
+		enterMode(newMode);
+	}
+}
+
+/* ===================
+ * Switch the operating mode
+ */
+static void enterMode ( uint newMode )
+{
+	mode = newMode;
+
+	if (mode == MOUSE_SAFE && !wdtOn) {
+		robot_wdtEnable();                  // Never cleared from now on
+		wdtOn = true;
+	}
+}
+
+static uint levelMode ( uint level )
+{
+	if (level >= OVERRUN_SAFE)
+		return MOUSE_SAFE;
+
+	if (level >= OVERRUN_SLOW)
+		return MOUSE_SLOW;
+
+	if (level >= OVERRUN_SHED)
+		return MOUSE_SHED;
+
+	return MOUSE_NORMAL;
 }
 
 
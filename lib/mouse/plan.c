@@ -0,0 +1,785 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/mouse/plan.c
+ *  \brief Implement the path planning.
+ *
+ *  D* Lite as in S. Koenig and M. Likhachev, "Fast Replanning for
+ *   Navigation in Unknown Terrain", 2005, with the search going backwards
+ *   from the goal: g and rhs are the costs to the goal, and the robot
+ *   follows the node with the least cost to the goal.
+ *
+ *  When the search is started again the blocked nodes are rebuilt from
+ *   the map a few rows at a time, within the same time budget.
+ *
+ *  The budget is measured with the core timer, except in the simulation,
+ *   where that's the host clock: the work done would depend on the host
+ *   load, and the runs wouldn't repeat. There each row scanned and node
+ *   expanded is charged a fixed time instead (see spent()).
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/plan.h>
+#include <conf.h>
+#include <mouse/map.h>
+#include <mouse/sensors.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+#define PLAN_INF      0xFFFF
+#define KEY_INF       0xFFFFFFFF
+
+#define COST_STRAIGHT 10
+#define COST_DIAGONAL 14
+
+/**
+ *  \brief Core timer counts charged for a row scanned and for a node
+ *   expanded in the simulation, about what they take on the host.
+ */
+#define ROW_CORE      10
+#define EXPAND_CORE   10
+
+
+/* ===================
+ * Instance used by the non reentrant interface
+ */
+#ifdef PLAN_DEFAULT
+static MR_TLS planCtx planDefault;
+#endif
+
+/* ===================
+ * Neighbours, the straight ones first, and the opposite directions
+ */
+static const int dirX[8]     = {1, 0, -1,  0, 1, -1, -1,  1};
+static const int dirY[8]     = {0, 1,  0, -1, 1,  1, -1, -1};
+static const int opposite[8] = {2, 3,  0,  1, 6,  7,  4,  5};
+
+
+/* ========================================================================== */
+
+static void restart     ( planCtx* ctx );
+static bool scanRows    ( planCtx* ctx, uint t0, uint budget, uint* work );
+static void search      ( planCtx* ctx, uint t0, uint budget, uint* work );
+static void nodeChanged ( planCtx* ctx, int node );
+static void cellChanged ( planCtx* ctx, int cx, int cy );
+static int  bestNext    ( const planCtx* ctx, int node );
+
+static int  neighbour    ( int node, int dir );
+static void updateVertex ( planCtx* ctx, int node );
+static uint minRhs       ( const planCtx* ctx, int node );
+static uint cost         ( const planCtx* ctx, int from, int dir );
+static void calcKey      ( const planCtx* ctx, int node, uint* k1, uint* k2 );
+static uint heuristic    ( int a, int b );
+
+static bool heapPush   ( planCtx* ctx, int node, uint k1, uint k2 );
+static void heapRemove ( planCtx* ctx, int node );
+static void heapUpdate ( planCtx* ctx, int node, uint k1, uint k2 );
+static void heapUp     ( planCtx* ctx, uint i );
+static void heapDown   ( planCtx* ctx, uint i );
+
+static inline bool isBlocked  ( const planCtx* ctx, int node );
+static inline bool keyLess    ( uint a1, uint a2, uint b1, uint b2 );
+static inline uint addCost    ( uint a, uint b );
+static inline uint spent      ( uint t0, uint work );
+
+
+/* ==========================================================================
+ * Management
+ */
+
+void plan_init_r ( planCtx* ctx, const mapCtx* map )
+{
+	ctx->map      = map;
+	ctx->mapSeq   = map_changeSeq_r(map);
+	ctx->state    = PLAN_IDLE;
+	ctx->restart  = false;
+	ctx->goal     = -1;
+	ctx->start    = -1;
+	ctx->expanded = 0;
+	ctx->scan     = MAP_SIZE;
+	ctx->heapLen  = 0;
+}
+
+bool plan_setGoal_r ( planCtx* ctx, int x, int y )
+{
+	int cx, cy;
+
+	if (!map_toCell_r(ctx->map, x, y, &cx, &cy)) {
+		ctx->state = PLAN_IDLE;
+		return false;
+	}
+
+	ctx->goal    = (cy / PLAN_SCALE) * PLAN_SIZE + cx / PLAN_SCALE;
+	ctx->state   = PLAN_BUSY;
+	ctx->restart = true;
+
+	return true;
+}
+
+void plan_stop_r ( planCtx* ctx )
+{
+	ctx->state = PLAN_IDLE;
+}
+
+uint plan_update_r ( planCtx* ctx, int x, int y, uint budgetUs )
+{
+	uint t0     = readCoreTimer();
+	uint budget = budgetUs * CORE_US;
+	uint work   = 0;
+	int  cx, cy, start;
+	int  x0, y0, x1, y1;
+	int  changed;
+
+	if (ctx->state == PLAN_IDLE)
+		return PLAN_IDLE;
+
+	/* Map changes, or all of the map if some were lost */
+	while ((changed = map_changes_r(ctx->map, &ctx->mapSeq, &cx, &cy)) != 0) {
+		if (changed < 0) {
+			ctx->restart = true;
+		} else if (!ctx->restart) {
+			cellChanged(ctx, cx, cy);
+		}
+	}
+
+	/* Off the map (going to a frontier at its border), from the closest
+	 * node on it.
+	 */
+	map_cellCenter_r(ctx->map, 0, 0, &x0, &y0);
+	map_cellCenter_r(ctx->map, MAP_SIZE - 1, MAP_SIZE - 1, &x1, &y1);
+
+	x = x < x0 ? x0 : (x > x1 ? x1 : x);
+	y = y < y0 ? y0 : (y > y1 ? y1 : y);
+
+	map_toCell_r(ctx->map, x, y, &cx, &cy);
+
+	start = (cy / PLAN_SCALE) * PLAN_SIZE + cx / PLAN_SCALE;
+
+	if (ctx->restart) {
+		ctx->start   = start;
+		ctx->restart = false;
+		restart(ctx);
+	}
+
+	/* The keys in the heap are lower bounds as long as km grows by the
+	 * distance the start moved.
+	 */
+	if (start != ctx->start) {
+		ctx->km   += heuristic(ctx->last, start);
+		ctx->last  = start;
+		ctx->start = start;
+	}
+
+	if (!scanRows(ctx, t0, budget, &work)) {
+		ctx->state = PLAN_BUSY;
+		return PLAN_BUSY;
+	}
+
+	search(ctx, t0, budget, &work);
+
+	return ctx->state;
+}
+
+uint plan_job ( void* ctx_, uint budgetUs )
+{
+#ifdef PLAN_DEFAULT
+	planCtx* ctx = ctx_ != NULL ? ctx_ : &planDefault;
+#else
+	planCtx* ctx = ctx_;
+#endif
+	uint t0      = readCoreTimer();
+	uint work    = 0;
+	uint done    = ctx->expanded + ctx->scan;
+
+	/* Restarts need the robot position, they wait for plan_update() */
+	if (ctx->state != PLAN_BUSY || ctx->restart)
+		return 0;
+
+	if (scanRows(ctx, t0, budgetUs * CORE_US, &work)) {
+		search(ctx, t0, budgetUs * CORE_US, &work);
+	}
+
+	return ctx->expanded + ctx->scan - done;
+}
+
+#ifdef PLAN_DEFAULT
+
+void plan_init ( void )
+{
+	plan_init_r(&planDefault, map_default());
+}
+
+bool plan_setGoal ( int x, int y )
+{
+	return plan_setGoal_r(&planDefault, x, y);
+}
+
+void plan_stop ( void )
+{
+	plan_stop_r(&planDefault);
+}
+
+uint plan_update ( void )
+{
+	int x, y;
+
+	sensors_position(&x, &y);
+
+	return plan_update_r(&planDefault, x, y, PLAN_BUDGET_US);
+}
+
+#endif /* PLAN_DEFAULT */
+
+
+/* ==========================================================================
+ * Path
+ */
+
+uint plan_state_r ( const planCtx* ctx )
+{
+	return ctx->state;
+}
+
+bool plan_next_r ( const planCtx* ctx, int* x, int* y )
+{
+	return plan_path_r(ctx, x, y, 1) == 1;
+}
+
+uint plan_path_r ( const planCtx* ctx, int* xs, int* ys, uint max )
+{
+	int  node = ctx->start;
+	uint n;
+
+	if (ctx->state != PLAN_READY)
+		return 0;
+
+	for (n = 0; n < max && node != ctx->goal; n++) {
+		node = bestNext(ctx, node);
+
+		if (node < 0)
+			break;
+
+		map_cellCenter_r(ctx->map, (node % PLAN_SIZE) * PLAN_SCALE, (node / PLAN_SIZE) * PLAN_SCALE,
+			xs + n, ys + n);
+
+		xs[n] += (PLAN_CELL - MAP_CELL) / 2;
+		ys[n] += (PLAN_CELL - MAP_CELL) / 2;
+	}
+
+	return n;
+}
+
+int plan_length_r ( const planCtx* ctx )
+{
+	if (ctx->state != PLAN_READY)
+		return -1;
+
+	return (ctx->rhs[ctx->start] * PLAN_CELL) / COST_STRAIGHT;
+}
+
+uint plan_expanded_r ( const planCtx* ctx )
+{
+	return ctx->expanded;
+}
+
+#ifdef PLAN_DEFAULT
+
+uint plan_state ( void )
+{
+	return plan_state_r(&planDefault);
+}
+
+bool plan_next ( int* x, int* y )
+{
+	return plan_next_r(&planDefault, x, y);
+}
+
+uint plan_path ( int* xs, int* ys, uint max )
+{
+	return plan_path_r(&planDefault, xs, ys, max);
+}
+
+int plan_length ( void )
+{
+	return plan_length_r(&planDefault);
+}
+
+uint plan_expanded ( void )
+{
+	return plan_expanded_r(&planDefault);
+}
+
+#endif /* PLAN_DEFAULT */
+
+
+/* ==========================================================================
+ * Search
+ */
+
+/* ===================
+ * Start the search from scratch, and the scan of the blocked nodes
+ */
+static void restart ( planCtx* ctx )
+{
+	uint i;
+
+	for (i = 0; i < PLAN_NODES; i++) {
+		ctx->g[i]       = PLAN_INF;
+		ctx->rhs[i]     = PLAN_INF;
+		ctx->heapIdx[i] = 0;
+	}
+
+	for (i = 0; i < PLAN_NODES / 32; i++) {
+		ctx->blocked[i] = 0;
+	}
+
+	ctx->heapLen = 0;
+	ctx->km      = 0;
+	ctx->last    = ctx->start;
+	ctx->scan    = 0;
+
+	ctx->rhs[ctx->goal] = 0;
+	heapPush(ctx, ctx->goal, heuristic(ctx->start, ctx->goal), 0);
+}
+
+/* ===================
+ * Mark the nodes near the occupied cells of the next map rows.
+ *  Returns true when all the rows were scanned.
+ */
+static bool scanRows ( planCtx* ctx, uint t0, uint budget, uint* work )
+{
+	int cx, px, py, px0, px1, py0, py1;
+
+	while (ctx->scan < MAP_SIZE) {
+		if (spent(t0, (*work)) >= budget)
+			return false;
+
+		(*work) += ROW_CORE;
+
+		py0 = floorDiv((int) ctx->scan - PLAN_MARGIN, PLAN_SCALE);
+		py1 = ((int) ctx->scan + PLAN_MARGIN) / PLAN_SCALE;
+		py0 = py0 < 0 ? 0 : py0;
+		py1 = py1 >= PLAN_SIZE ? PLAN_SIZE - 1 : py1;
+
+		for (cx = 0; cx < MAP_SIZE; cx++) {
+			if (map_cellState_r(ctx->map, cx, ctx->scan) != MAP_OCCUPIED)
+				continue;
+
+			px0 = floorDiv(cx - PLAN_MARGIN, PLAN_SCALE);
+			px1 = (cx + PLAN_MARGIN) / PLAN_SCALE;
+			px0 = px0 < 0 ? 0 : px0;
+			px1 = px1 >= PLAN_SIZE ? PLAN_SIZE - 1 : px1;
+
+			for (py = py0; py <= py1; py++) {
+				for (px = px0; px <= px1; px++) {
+					ctx->blocked[(py * PLAN_SIZE + px) / 32] |= 1u << ((py * PLAN_SIZE + px) % 32);
+				}
+			}
+		}
+
+		ctx->scan++;
+	}
+
+	return true;
+}
+
+/* ===================
+ * ComputeShortestPath(), until the start is consistent or the time is over
+ */
+static void search ( planCtx* ctx, uint t0, uint budget, uint* work )
+{
+	uint sk1, sk2, k1, k2;
+	uint gOld;
+	int  u, s, d;
+
+	while (ctx->heapLen > 0) {
+		calcKey(ctx, ctx->start, &sk1, &sk2);
+
+		if (!keyLess(ctx->heap[0].k1, ctx->heap[0].k2, sk1, sk2) &&
+		    ctx->rhs[ctx->start] <= ctx->g[ctx->start])
+			break;
+
+		if (ctx->restart || spent(t0, (*work)) >= budget) {
+			ctx->state = PLAN_BUSY;         // Resumed on the next update
+			return;
+		}
+
+		u = ctx->heap[0].node;
+		calcKey(ctx, u, &k1, &k2);
+
+		ctx->expanded++;
+		(*work) += EXPAND_CORE;
+
+		if (keyLess(ctx->heap[0].k1, ctx->heap[0].k2, k1, k2)) {
+			heapUpdate(ctx, u, k1, k2);
+
+		} else if (ctx->g[u] > ctx->rhs[u]) {
+			ctx->g[u] = ctx->rhs[u];
+			heapRemove(ctx, u);
+
+			for (d = 0; d < 8; d++) {
+				s = neighbour(u, d);
+
+				if (s < 0 || s == ctx->goal)
+					continue;
+
+				k1 = addCost(cost(ctx, s, opposite[d]), ctx->g[u]);
+
+				if (k1 < ctx->rhs[s]) {
+					ctx->rhs[s] = k1;
+					updateVertex(ctx, s);
+				}
+			}
+
+		} else {
+			gOld      = ctx->g[u];
+			ctx->g[u] = PLAN_INF;
+
+			if (u != ctx->goal) {
+				ctx->rhs[u] = minRhs(ctx, u);
+			}
+
+			updateVertex(ctx, u);
+
+			for (d = 0; d < 8; d++) {
+				s = neighbour(u, d);
+
+				if (s < 0 || s == ctx->goal)
+					continue;
+
+				if (ctx->rhs[s] == addCost(cost(ctx, s, opposite[d]), gOld)) {
+					ctx->rhs[s] = minRhs(ctx, s);
+					updateVertex(ctx, s);
+				}
+			}
+		}
+	}
+
+	/* The start may be left overconsistent, its rhs is the cost then */
+	ctx->state = ctx->rhs[ctx->start] < PLAN_INF ? PLAN_READY : PLAN_NO_PATH;
+}
+
+/* ===================
+ * A map cell changed, check the nodes within the margin
+ */
+static void cellChanged ( planCtx* ctx, int cx, int cy )
+{
+	int px, py, px0, px1, py0, py1;
+
+	px0 = floorDiv(cx - PLAN_MARGIN, PLAN_SCALE);
+	px1 = (cx + PLAN_MARGIN) / PLAN_SCALE;
+	py0 = floorDiv(cy - PLAN_MARGIN, PLAN_SCALE);
+	py1 = (cy + PLAN_MARGIN) / PLAN_SCALE;
+
+	for (py = py0 < 0 ? 0 : py0; py <= py1 && py < PLAN_SIZE; py++) {
+		for (px = px0 < 0 ? 0 : px0; px <= px1 && px < PLAN_SIZE; px++) {
+			nodeChanged(ctx, py * PLAN_SIZE + px);
+		}
+	}
+}
+
+/* ===================
+ * Check whether a node is blocked, and update the costs of the moves into
+ *  it, or past its corners, when that changed
+ */
+static void nodeChanged ( planCtx* ctx, int node )
+{
+	int  x0 = (node % PLAN_SIZE) * PLAN_SCALE - PLAN_MARGIN;
+	int  y0 = (node / PLAN_SIZE) * PLAN_SCALE - PLAN_MARGIN;
+	bool blocked = false;
+	int  cx, cy, d, s;
+
+	for (cy = y0; cy < y0 + PLAN_SCALE + 2 * PLAN_MARGIN && !blocked; cy++) {
+		for (cx = x0; cx < x0 + PLAN_SCALE + 2 * PLAN_MARGIN && !blocked; cx++) {
+			blocked = (map_cellState_r(ctx->map, cx, cy) == MAP_OCCUPIED);
+		}
+	}
+
+	if (blocked == isBlocked(ctx, node))
+		return;
+
+	ctx->blocked[node / 32] ^= 1u << (node % 32);
+
+	/* Nodes still being scanned have no costs yet */
+	if (ctx->scan < MAP_SIZE)
+		return;
+
+	/* The moves of the neighbours into the node and past its corners */
+	for (d = 0; d < 8; d++) {
+		s = neighbour(node, d);
+
+		if (s >= 0 && s != ctx->goal) {
+			ctx->rhs[s] = minRhs(ctx, s);
+			updateVertex(ctx, s);
+		}
+	}
+}
+
+/* ===================
+ * Neighbour with the least cost to the goal, -1 if there's none
+ */
+static int bestNext ( const planCtx* ctx, int node )
+{
+	uint best = PLAN_INF;
+	uint c;
+	int  next = -1;
+	int  d;
+
+	for (d = 0; d < 8; d++) {
+		if (neighbour(node, d) < 0)
+			continue;
+
+		c = addCost(cost(ctx, node, d), ctx->g[neighbour(node, d)]);
+
+		if (c < best) {
+			best = c;
+			next = neighbour(node, d);
+		}
+	}
+
+	return next;
+}
+
+
+/* ==========================================================================
+ * Helper functions
+ */
+
+/* ===================
+ * UpdateVertex(), keep the node in the open list while it's inconsistent
+ */
+static void updateVertex ( planCtx* ctx, int node )
+{
+	uint k1, k2;
+
+	if (ctx->g[node] != ctx->rhs[node]) {
+		calcKey(ctx, node, &k1, &k2);
+
+		if (ctx->heapIdx[node]) {
+			heapUpdate(ctx, node, k1, k2);
+		} else if (!heapPush(ctx, node, k1, k2)) {
+			ctx->restart = true;
+		}
+
+	} else if (ctx->heapIdx[node]) {
+		heapRemove(ctx, node);
+	}
+}
+
+/* ===================
+ * Least cost to the goal through the neighbours
+ */
+static uint minRhs ( const planCtx* ctx, int node )
+{
+	uint best = PLAN_INF;
+	uint c;
+	int  d;
+
+	for (d = 0; d < 8; d++) {
+		if (neighbour(node, d) < 0)
+			continue;
+
+		c = addCost(cost(ctx, node, d), ctx->g[neighbour(node, d)]);
+		best = c < best ? c : best;
+	}
+
+	return best;
+}
+
+/* ===================
+ * Neighbour of a node, -1 if it's outside the map
+ */
+static int neighbour ( int node, int dir )
+{
+	int x = node % PLAN_SIZE + dirX[dir];
+	int y = node / PLAN_SIZE + dirY[dir];
+
+	if (x < 0 || x >= PLAN_SIZE || y < 0 || y >= PLAN_SIZE)
+		return -1;
+
+	return y * PLAN_SIZE + x;
+}
+
+/* ===================
+ * Cost of a move to a neighbour, PLAN_INF if it isn't possible. The goal
+ *  may be within the margin of an obstacle (a frontier along a wall), the
+ *  moves into it are allowed.
+ */
+static uint cost ( const planCtx* ctx, int from, int dir )
+{
+	int to = neighbour(from, dir);
+
+	if (to < 0 || (isBlocked(ctx, to) && to != ctx->goal))
+		return PLAN_INF;
+
+	if (dir < 4)
+		return COST_STRAIGHT;
+
+	/* No cutting corners */
+	if (isBlocked(ctx, from + dirX[dir]) || isBlocked(ctx, from + dirY[dir] * PLAN_SIZE))
+		return PLAN_INF;
+
+	return COST_DIAGONAL;
+}
+
+static void calcKey ( const planCtx* ctx, int node, uint* k1, uint* k2 )
+{
+	uint m = ctx->g[node] < ctx->rhs[node] ? ctx->g[node] : ctx->rhs[node];
+
+	(*k2) = m;
+	(*k1) = (m == PLAN_INF) ? KEY_INF : m + heuristic(ctx->start, node) + ctx->km;
+}
+
+/* ===================
+ * Octile distance between two nodes
+ */
+static uint heuristic ( int a, int b )
+{
+	int dx = abs(a % PLAN_SIZE - b % PLAN_SIZE);
+	int dy = abs(a / PLAN_SIZE - b / PLAN_SIZE);
+
+	return dx > dy ? COST_STRAIGHT * dx + (COST_DIAGONAL - COST_STRAIGHT) * dy :
+	                 COST_STRAIGHT * dy + (COST_DIAGONAL - COST_STRAIGHT) * dx;
+}
+
+
+/* ==========================================================================
+ * Open list, binary heap
+ */
+
+static bool heapPush ( planCtx* ctx, int node, uint k1, uint k2 )
+{
+	uint i = ctx->heapLen;
+
+	if (i >= PLAN_HEAP)
+		return false;
+
+	ctx->heap[i].k1   = k1;
+	ctx->heap[i].k2   = k2;
+	ctx->heap[i].node = node;
+	ctx->heapIdx[node] = i + 1;
+	ctx->heapLen++;
+
+	heapUp(ctx, i);
+
+	return true;
+}
+
+static void heapRemove ( planCtx* ctx, int node )
+{
+	uint i = ctx->heapIdx[node] - 1;
+
+	ctx->heapIdx[node] = 0;
+	ctx->heapLen--;
+
+	if (i == ctx->heapLen)
+		return;
+
+	node = ctx->heap[ctx->heapLen].node;    // The last one takes its place
+
+	ctx->heap[i] = ctx->heap[ctx->heapLen];
+	ctx->heapIdx[node] = i + 1;
+
+	heapUp(ctx, i);
+	heapDown(ctx, ctx->heapIdx[node] - 1);
+}
+
+static void heapUpdate ( planCtx* ctx, int node, uint k1, uint k2 )
+{
+	uint i = ctx->heapIdx[node] - 1;
+
+	ctx->heap[i].k1 = k1;
+	ctx->heap[i].k2 = k2;
+
+	heapUp(ctx, i);
+	heapDown(ctx, ctx->heapIdx[node] - 1);
+}
+
+static void heapUp ( planCtx* ctx, uint i )
+{
+	planItem item = ctx->heap[i];
+	uint     parent;
+
+	while (i > 0) {
+		parent = (i - 1) / 2;
+
+		if (!keyLess(item.k1, item.k2, ctx->heap[parent].k1, ctx->heap[parent].k2))
+			break;
+
+		ctx->heap[i] = ctx->heap[parent];
+		ctx->heapIdx[ctx->heap[i].node] = i + 1;
+		i = parent;
+	}
+
+	ctx->heap[i] = item;
+	ctx->heapIdx[item.node] = i + 1;
+}
+
+static void heapDown ( planCtx* ctx, uint i )
+{
+	planItem item = ctx->heap[i];
+	uint     child;
+
+	while ((child = 2 * i + 1) < ctx->heapLen) {
+		if (child + 1 < ctx->heapLen &&
+		    keyLess(ctx->heap[child + 1].k1, ctx->heap[child + 1].k2, ctx->heap[child].k1, ctx->heap[child].k2)) {
+			child++;
+		}
+
+		if (!keyLess(ctx->heap[child].k1, ctx->heap[child].k2, item.k1, item.k2))
+			break;
+
+		ctx->heap[i] = ctx->heap[child];
+		ctx->heapIdx[ctx->heap[i].node] = i + 1;
+		i = child;
+	}
+
+	ctx->heap[i] = item;
+	ctx->heapIdx[item.node] = i + 1;
+}
+
+
+/* ========================================================================== */
+
+static inline bool isBlocked ( const planCtx* ctx, int node )
+{
+	return (ctx->blocked[node / 32] >> (node % 32)) & 1;
+}
+
+static inline bool keyLess ( uint a1, uint a2, uint b1, uint b2 )
+{
+	return a1 < b1 || (a1 == b1 && a2 < b2);
+}
+
+/* ===================
+ * Sum of costs, saturating at PLAN_INF
+ */
+static inline uint addCost ( uint a, uint b )
+{
+	return (a >= PLAN_INF || b >= PLAN_INF || a + b >= PLAN_INF) ? PLAN_INF : a + b;
+}
+
+/* ===================
+ * Core timer counts taken since t0, or in the simulation the ones charged
+ *  for the work done
+ */
+static inline uint spent ( uint t0, uint work )
+{
+#ifdef MR_SIM
+	return work;
+#else
+	return readCoreTimer() - t0;
+#endif
+}
+
+
+/* = EOF ==================================================================== */
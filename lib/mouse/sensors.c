@@ -17,6 +17,9 @@
 #include <conf.h>
 #include <hal/robot.h>
 #include <mouse/state.h>
+#include <mouse/mouse.h>
+#include <util/prof.h>
+#include <util/trig.h>
 
 
 /* ==========================================================================
@@ -40,23 +43,25 @@
 #define ST_THRESHOLD
 
 /**
- *  \brief The #ST_THRESHOLD for the ground detection.
+ *  \brief The default #ST_THRESHOLD for the ground detection.
+ *
+ *  The thresholds can be changed at run time with sensors_setThresholds().
  */
 #define GROUND_ST_THRESHOLD 5
 
 /**
- *  \brief The #ST_THRESHOLD for the beacon detection.
+ *  \brief The default #ST_THRESHOLD for the beacon detection.
  */
 #define BEACON_ST_THRESHOLD 5
 
 /**
- *  \brief The #ST_THRESHOLD for the bump detection.
+ *  \brief The default #ST_THRESHOLD for the bump detection.
  */
 #define BUMP_ST_THRESHOLD   5
 
 /**
- *  \brief Difference (in encoder ticks) between the value applied to the
- *   motors and the value read from the encoders to be considered the
+ *  \brief Default difference (in encoder ticks) between the value applied
+ *   to the motors and the value read from the encoders to be considered the
  *   robot is stucked.
  *
  *  This is used when the robot has no bump detection sensor. In this
@@ -69,37 +74,9 @@
 /* ========================================================================== */
 
 /* ===================
- * Beacon sensor
- */
-static bool beaconOn    = false;
-static int  beaconCount = 0;
-static int  beaconDir   = 0;
-
-/* ===================
- * Ground sensors
- */
-static uint groundCount[5] = {0, 0, 0, 0, 0};
-static bool groundOn[5]    = {false, false, false, false, false};
-
-/* ===================
- * Odometry (in millimeters)
- */
-static int odoPartLeft  = 0;
-static int odoPartRight = 0;
-static int odoIntLeft   = 0;
-static int odoIntRight  = 0;
-
-/* ===================
- * Battery
- */
-static int battery = 0;
-
-/* ===================
- * Bump sensor
+ * Instance used by the non reentrant interface
  */
-static bool bumpOn    = false;
-static int  bumpCount = 0;
-static int  bumpDir   = 0;
+MR_TLS sensorsCtx sensorsDefault;
 
 
 /* ========================================================================== */
@@ -113,11 +90,13 @@ static int  bumpDir   = 0;
 
 /* ========================================================================== */
 
-static void updateBeacon        ( void );
-static void updateGroundSensors ( void );
-static void updateOdometry      ( void );
-static void updateBattery       ( void );
-static void updateBump          ( void );
+static void updateBeacon        ( sensorsCtx* ctx );
+static void updateGroundSensors ( sensorsCtx* ctx );
+static void updateOdometry      ( sensorsCtx* ctx );
+static void updateBattery       ( sensorsCtx* ctx );
+static void updateBump          ( sensorsCtx* ctx );
+
+static inline int  obstDist  ( int adc );
 
 static inline void stBinSens ( uint value, bool* state, uint* count, uint threshold );
 
@@ -126,44 +105,128 @@ static inline void stBinSens ( uint value, bool* state, uint* count, uint thresh
  * Management
  */
 
-void sensors_init ( void )
+void sensors_init_r ( sensorsCtx* ctx, stateCtx* state )
 {
 	int i;
 
 	robot_enableObstSens();
 	robot_enableGroundSens();
 
-	beaconOn    = 0;
-	beaconCount = 0;
-	beaconDir   = 0;
+	ctx->state = state;
+
+	ctx->beaconOn    = false;
+	ctx->beaconCount = 0;
+	ctx->beaconDir   = 0;
+	ctx->beaconValid = false;
+	ctx->beaconWidth = 0;
+	ctx->beaconConf  = 0;
+	ctx->beaconBear  = 0;
 
 	for (i = 0; i < 5; i++) {
-		groundCount[i] = 0;
-		groundOn[i] = false;
+		ctx->groundCount[i] = 0;
+		ctx->groundOn[i] = false;
+	}
+
+	ctx->odoPartLeft  = 0;
+	ctx->odoPartRight = 0;
+	ctx->odoIntLeft   = 0;
+	ctx->odoIntRight  = 0;
+
+	ctx->heading      = 0;
+	ctx->headingRem   = 0;
+
+	ctx->posX         = 0;
+	ctx->posY         = 0;
+	ctx->lastX        = 0;
+	ctx->lastY        = 0;
+
+	ctx->battery = 0;
+
+	for (i = 0; i < 32; i++) {
+		ctx->batteryArray[i] = 96;
 	}
 
-	odoPartLeft  = 0;
-	odoPartRight = 0;
-	odoIntLeft   = 0;
-	odoIntRight  = 0;
+	ctx->batteryIdx = 0;
+	ctx->batterySum = 3072;   /* = (96 * 32) */
 
-	battery = 0;
+	ctx->bumpOn    = false;
+	ctx->bumpCount = 0;
+	ctx->bumpDir   = 0;
 
-	bumpOn    = false;
-	bumpCount = 0;
-	bumpDir   = 0;
+	ctx->groundSt  = GROUND_ST_THRESHOLD;
+	ctx->beaconSt  = BEACON_ST_THRESHOLD;
+	ctx->bumpSt    = BUMP_ST_THRESHOLD;
+	ctx->bumpThr   = BUMP_THRESHOLD;
 }
 
-void sensors_update ( void )
+void sensors_setThresholds_r ( sensorsCtx* ctx, uint groundSt, uint beaconSt, uint bumpSt, int bumpThr )
 {
+	int i;
+
+	ctx->groundSt = groundSt;
+	ctx->beaconSt = beaconSt;
+	ctx->bumpSt   = bumpSt;
+	ctx->bumpThr  = bumpThr;
+
+	/* The counters must stay within the new thresholds */
+	for (i = 0; i < 5; i++) {
+		ctx->groundCount[i] = ctx->groundCount[i] > groundSt ? groundSt : ctx->groundCount[i];
+	}
+
+	ctx->beaconCount = ctx->beaconCount > beaconSt ? beaconSt : ctx->beaconCount;
+	ctx->bumpCount   = ctx->bumpCount   > bumpSt   ? bumpSt   : ctx->bumpCount;
+}
+
+void sensors_update_r ( sensorsCtx* ctx )
+{
+	PROF_BEGIN(sensors_update);
+
+	PROF_BEGIN(robot_readSensors);
 	robot_readSensors();
+	PROF_END(robot_readSensors);
+
 	robot_readEncoders();
 
-	updateBeacon();
-	updateGroundSensors();
-	updateOdometry();
-	updateBattery();
-	updateBump();
+	PROF_BEGIN(updateOdometry);
+	updateOdometry(ctx);
+	PROF_END(updateOdometry);
+
+	PROF_BEGIN(updateBeacon);
+	updateBeacon(ctx);
+	PROF_END(updateBeacon);
+
+	PROF_BEGIN(updateGroundSensors);
+	updateGroundSensors(ctx);
+	PROF_END(updateGroundSensors);
+
+	PROF_BEGIN(updateBattery);
+	updateBattery(ctx);
+	PROF_END(updateBattery);
+
+	PROF_BEGIN(updateBump);
+	updateBump(ctx);
+	PROF_END(updateBump);
+
+	PROF_END(sensors_update);
+}
+
+void sensors_getThresholds_r ( const sensorsCtx* ctx, uint* groundSt, uint* beaconSt, uint* bumpSt, int* bumpThr )
+{
+	if (groundSt != NULL) {
+		(*groundSt) = ctx->groundSt;
+	}
+
+	if (beaconSt != NULL) {
+		(*beaconSt) = ctx->beaconSt;
+	}
+
+	if (bumpSt != NULL) {
+		(*bumpSt) = ctx->bumpSt;
+	}
+
+	if (bumpThr != NULL) {
+		(*bumpThr) = ctx->bumpThr;
+	}
 }
 
 void sensors_stop ( void )
@@ -179,17 +242,17 @@ void sensors_stop ( void )
 
 int sensors_obstL ( void )
 {
-	return sensors.obst_sens_left;
+	return obstDist(sensors.obst_sens_left);
 }
 
 int sensors_obstF ( void )
 {
-	return sensors.obst_sens_front;
+	return obstDist(sensors.obst_sens_front);
 }
 
 int sensors_obstR ( void )
 {
-	return sensors.obst_sens_right;
+	return obstDist(sensors.obst_sens_right);
 }
 
 
@@ -197,17 +260,37 @@ int sensors_obstR ( void )
  * Beacon search
  */
 
-bool sensors_beacon ( void )
+bool sensors_beacon_r ( const sensorsCtx* ctx )
 {
-	return beaconOn;
+	return ctx->beaconOn;
 }
 
-int sensors_beaconDir ( void )
+int sensors_beaconDir_r ( const sensorsCtx* ctx )
 {
 	/* Even if the beacon isn't visible
 	 * return the last known direction
 	 */
-	return beaconDir;
+	return ctx->beaconDir;
+}
+
+bool sensors_beaconValid_r ( const sensorsCtx* ctx )
+{
+	return ctx->beaconValid;
+}
+
+int sensors_beaconBearing_r ( const sensorsCtx* ctx )
+{
+	return (ctx->beaconBear + (ctx->beaconBear < 0 ? -500 : 500)) / 1000;
+}
+
+int sensors_beaconWidth_r ( const sensorsCtx* ctx )
+{
+	return ctx->beaconWidth;
+}
+
+int sensors_beaconConf_r ( const sensorsCtx* ctx )
+{
+	return ctx->beaconConf;
 }
 
 
@@ -215,34 +298,34 @@ int sensors_beaconDir ( void )
  * Target area and line detection (Ground sensors)
  */
 
-bool sensors_groundL ( void )
+bool sensors_groundL_r ( const sensorsCtx* ctx )
 {
-	return groundOn[4];
+	return ctx->groundOn[4];
 }
 
-bool sensors_groundCL ( void )
+bool sensors_groundCL_r ( const sensorsCtx* ctx )
 {
-	return groundOn[3];
+	return ctx->groundOn[3];
 }
 
-bool sensors_groundCF ( void )
+bool sensors_groundCF_r ( const sensorsCtx* ctx )
 {
-	return groundOn[2];
+	return ctx->groundOn[2];
 }
 
-bool sensors_groundCR ( void )
+bool sensors_groundCR_r ( const sensorsCtx* ctx )
 {
-	return groundOn[1];
+	return ctx->groundOn[1];
 }
 
-bool sensors_groundR ( void )
+bool sensors_groundR_r ( const sensorsCtx* ctx )
 {
-	return groundOn[0];
+	return ctx->groundOn[0];
 }
 
-bool sensors_groundC ( void )
+bool sensors_groundC_r ( const sensorsCtx* ctx )
 {
-	return ((groundOn[1] + groundOn[2] + groundOn[3]) >= 2);
+	return ((ctx->groundOn[1] + ctx->groundOn[2] + ctx->groundOn[3]) >= 2);
 }
 
 
@@ -250,25 +333,55 @@ bool sensors_groundC ( void )
  * Encoders and odometry
  */
 
-void sensors_odoPart ( int* odoL, int* odoR )
+void sensors_odoPart_r ( const sensorsCtx* ctx, int* odoL, int* odoR )
 {
 	if (odoL != NULL) {
-		(*odoL) = odoPartLeft / 10000;            // Convert to cm
+		(*odoL) = ctx->odoPartLeft / 10000;       // Convert to cm
 	}
 
 	if (odoR != NULL) {
-		(*odoR) = odoPartRight / 10000;           // Convert to cm
+		(*odoR) = ctx->odoPartRight / 10000;      // Convert to cm
 	}
 }
 
-void sensors_odoInt ( int* odoL, int* odoR )
+void sensors_odoInt_r ( const sensorsCtx* ctx, int* odoL, int* odoR )
 {
 	if (odoL != NULL) {
-		(*odoL) = odoIntLeft / 10000;             // Convert to cm
+		(*odoL) = ctx->odoIntLeft / 10000;        // Convert to cm
 	}
 
 	if (odoR != NULL) {
-		(*odoR) = odoIntRight / 10000;            // Convert to cm
+		(*odoR) = ctx->odoIntRight / 10000;       // Convert to cm
+	}
+}
+
+int sensors_compass_r ( const sensorsCtx* ctx )
+{
+	return (ctx->heading + (ctx->heading < 0 ? -500 : 500)) / 1000;
+}
+
+void sensors_position_r ( const sensorsCtx* ctx, int* posX, int* posY )
+{
+	if (posX != NULL) {
+		(*posX) = ctx->posX / 1000;               // Convert to mm
+	}
+
+	if (posY != NULL) {
+		(*posY) = ctx->posY / 1000;               // Convert to mm
+	}
+}
+
+void sensors_movement_r ( sensorsCtx* ctx, int* posX, int* posY )
+{
+	/* Only whole mm are consumed, the rest is kept for the next call */
+	if (posX != NULL) {
+		(*posX) = (ctx->posX - ctx->lastX) / 1000;
+		ctx->lastX += (*posX) * 1000;
+	}
+
+	if (posY != NULL) {
+		(*posY) = (ctx->posY - ctx->lastY) / 1000;
+		ctx->lastY += (*posY) * 1000;
 	}
 }
 
@@ -277,9 +390,9 @@ void sensors_odoInt ( int* odoL, int* odoR )
  * Battery level
  */
 
-uint sensors_battery ( void )
+uint sensors_battery_r ( const sensorsCtx* ctx )
 {
-	return battery;
+	return ctx->battery;
 }
 
 
@@ -287,9 +400,9 @@ uint sensors_battery ( void )
  * Bump detection
  */
 
-bool sensors_bump ( void )
+bool sensors_bump_r ( const sensorsCtx* ctx )
 {
-	return bumpOn;
+	return ctx->bumpOn;
 }
 
 
@@ -310,31 +423,82 @@ bool sensors_stopBtn ( void )
 
 /* ========================================================================== */
 
-static void updateBeacon ( void )
+static void updateBeacon ( sensorsCtx* ctx )
 {
-	stBinSens(robot_readBeaconSens(), &beaconOn, &beaconCount, BEACON_ST_THRESHOLD);
+	int center;
 
-	if (beaconOn)
-		beaconDir = state_getServoDegree();
+	/* In sweep mode the beacon sensor is handled by the actuators module,
+	 * which provides the results of the last passes.
+	 */
+	if (state_getBeaconSweep_r(ctx->state, &center, &ctx->beaconWidth, &ctx->beaconConf)) {
+		ctx->beaconOn    = (ctx->beaconConf > 0);
+		ctx->beaconValid = ctx->beaconOn;
+		ctx->beaconCount = 0;
+
+		if (ctx->beaconOn) {
+			ctx->beaconDir  = center;
+			ctx->beaconBear = trig_norm(ctx->heading - center * 1000);
+		}
+
+		return;
+	}
+
+	ctx->beaconWidth = 0;
+	ctx->beaconConf  = 0;
+
+	/* The sample is tagged with the estimated servo position, and is only
+	 * used for the direction when the servo isn't moving.
+	 */
+	ctx->beaconValid = state_getServoSettled_r(ctx->state);
+
+	stBinSens(robot_readBeaconSens(), &ctx->beaconOn, &ctx->beaconCount, ctx->beaconSt);
+
+	if (ctx->beaconOn && ctx->beaconValid) {
+		ctx->beaconDir  = state_getServoDegree_r(ctx->state);
+		ctx->beaconBear = trig_norm(ctx->heading - ctx->beaconDir * 1000);
+	}
 }
 
-static void updateGroundSensors ( void )
+static void updateGroundSensors ( sensorsCtx* ctx )
 {
 	int i;
 	uint sens = sensors.ground;
 
 	for (i = 0; i < 5; i++) {
-		stBinSens((sens & (1 << i)), groundOn + i, groundCount + i, GROUND_ST_THRESHOLD);
+		stBinSens((sens & (1 << i)), ctx->groundOn + i, ctx->groundCount + i, ctx->groundSt);
 	}
 }
 
-static void updateOdometry ( void )
+static void updateOdometry ( sensorsCtx* ctx )
 {
-	odoPartLeft  = ENC_DIST_PER_TICK * (-sensors.enc_left);
-	odoPartRight = ENC_DIST_PER_TICK * sensors.enc_right;
+	int yaw;
+	int dist;
+	int mid;
+
+	ctx->odoPartLeft  = ENC_DIST_PER_TICK * sensors.enc_left;
+	ctx->odoPartRight = ENC_DIST_PER_TICK * sensors.enc_right;
+
+	ctx->odoIntLeft  += ctx->odoPartLeft;
+	ctx->odoIntRight += ctx->odoPartRight;
 
-	odoIntLeft  += odoPartLeft;
-	odoIntRight += odoPartRight;
+	/* Rotation in radians is (R - L) / WHEEL_BASE (um / mm = 1 / 1000).
+	 * The remainder of the division is carried to the next cycle so small
+	 * rotations aren't lost.
+	 */
+	yaw             = (ctx->odoPartRight - ctx->odoPartLeft) * 57296 + ctx->headingRem;
+	ctx->headingRem = yaw % (WHEEL_BASE * 1000);
+	yaw             = yaw / (WHEEL_BASE * 1000);
+
+	/* The cycle is taken as a straight segment along the mean heading */
+	dist = (ctx->odoPartLeft + ctx->odoPartRight) / 2;
+	mid  = ctx->heading + yaw / 2;
+
+	ctx->posX += (dist * trig_cos(mid)) / TRIG_ONE;
+	ctx->posY += (dist * trig_sin(mid)) / TRIG_ONE;
+
+	ctx->heading = trig_norm(ctx->heading + yaw);
+
+	state_setYaw_r(ctx->state, yaw);
 }
 
 /* ===================
@@ -342,15 +506,8 @@ static void updateOdometry ( void )
  *  - Read battery voltage (average of the last 32 readings)
  *  - Value is multiplied by 10 (max. value is 101, i.e. 10,1 V)
  */
-static void updateBattery ( void )
+static void updateBattery ( sensorsCtx* ctx )
 {
-	static int array[32] = {96, 96, 96, 96, 96, 96, 96, 96,
-	                        96, 96, 96, 96, 96, 96, 96, 96,
-	                        96, 96, 96, 96, 96, 96, 96, 96,
-	                        96, 96, 96, 96, 96, 96, 96, 96};
-	static int i;
-	static int sum = 3072; /* = (96 * 32) */
-
 	uint value;
 
 	value = sensors.battery;
@@ -358,25 +515,37 @@ static void updateBattery ( void )
 	value = (value * 330 + 511) / 1023;
 	value = (value * (3300 + 6800) + 1650) / 33000;
 
-	sum = sum - array[i] + value;
-	array[i] = value;
-	i = (i + 1) & 0x1F;
+	ctx->batterySum = ctx->batterySum - ctx->batteryArray[ctx->batteryIdx] + value;
+	ctx->batteryArray[ctx->batteryIdx] = value;
+	ctx->batteryIdx = (ctx->batteryIdx + 1) & 0x1F;
 
-	battery = (sum >> 5);
+	ctx->battery = (ctx->batterySum >> 5);
 }
 
-static void updateBump ( void )
+static void updateBump ( sensorsCtx* ctx )
 {
 	uint stuck   = 0;
-	uint spLeft  = 0;
-	uint spRight = 0;
+	int  spLeft  = 0;
+	int  spRight = 0;
 
-	state_getSP(&spLeft, &spRight);
+	state_getSP_r(ctx->state, &spLeft, &spRight);
 
-	stuck = (abs(spLeft  - odoIntLeft)  >= BUMP_THRESHOLD ||
-		     abs(spRight - odoIntRight) >= BUMP_THRESHOLD);
+	stuck = (abs(spLeft  - mouse_perTick(sensors.enc_left))  >= ctx->bumpThr ||
+		     abs(spRight - mouse_perTick(sensors.enc_right)) >= ctx->bumpThr);
+
+	stBinSens(stuck, &ctx->bumpOn, &ctx->bumpCount, ctx->bumpSt);
+}
+
+/* ===================
+ * Obstacle distance (in cm) from the sensor reading, which is
+ *  OBST_K / (d + 1).
+ */
+static inline int obstDist ( int adc )
+{
+	if (adc <= OBST_K / (OBST_RANGE + 1))
+		return OBST_SENS_INFINITE;
 
-	stBinSens(stuck, &bumpOn, &bumpCount, BUMP_ST_THRESHOLD);
+	return (OBST_K + adc / 2) / adc - 1;
 }
 
 /* ===================
@@ -22,38 +22,101 @@
 
 /* ========================================================================== */
 
-static int servoDegree = 0;
+/* ===================
+ * Instance used by the non reentrant interface
+ */
+MR_TLS stateCtx stateDefault;
 
-static int spLeft      = 0;
-static int spRight     = 0;
 
+/* ==========================================================================
+ * Reentrant interface
+ */
 
-/* ========================================================================== */
+void state_init_r ( stateCtx* ctx )
+{
+	ctx->servoDegree  = 0;
+	ctx->servoSettled = false;
+
+	ctx->sweepActive  = false;
+	ctx->sweepCenter  = 0;
+	ctx->sweepWidth   = 0;
+	ctx->sweepConf    = 0;
+
+	ctx->yaw          = 0;
+
+	ctx->spLeft       = 0;
+	ctx->spRight      = 0;
+}
+
+inline void state_setServoDegree_r ( stateCtx* ctx, int degree )
+{
+	ctx->servoDegree = degree;
+}
+
+inline int state_getServoDegree_r ( const stateCtx* ctx )
+{
+	return ctx->servoDegree;
+}
+
+inline void state_setServoSettled_r ( stateCtx* ctx, bool settled )
+{
+	ctx->servoSettled = settled;
+}
+
+inline bool state_getServoSettled_r ( const stateCtx* ctx )
+{
+	return ctx->servoSettled;
+}
+
+inline void state_setBeaconSweep_r ( stateCtx* ctx, bool active, int center, int width, int confidence )
+{
+	ctx->sweepActive = active;
+	ctx->sweepCenter = center;
+	ctx->sweepWidth  = width;
+	ctx->sweepConf   = confidence;
+}
+
+inline bool state_getBeaconSweep_r ( const stateCtx* ctx, int* center, int* width, int* confidence )
+{
+	if (center != NULL) {
+		(*center) = ctx->sweepCenter;
+	}
+
+	if (width != NULL) {
+		(*width) = ctx->sweepWidth;
+	}
+
+	if (confidence != NULL) {
+		(*confidence) = ctx->sweepConf;
+	}
+
+	return ctx->sweepActive;
+}
 
-inline void state_setServoDegree ( int degree )
+inline void state_setYaw_r ( stateCtx* ctx, int value )
 {
-	servoDegree = degree;
+	ctx->yaw = value;
 }
 
-inline int state_getServoDegree ( void )
+inline int state_getYaw_r ( const stateCtx* ctx )
 {
-	return servoDegree;
+	return ctx->yaw;
 }
 
-inline void state_setSP ( int left, int right )
+inline void state_setSP_r ( stateCtx* ctx, int left, int right )
 {
-	spLeft  = left;
-	spRight = right;
+	ctx->spLeft  = left;
+	ctx->spRight = right;
 }
 
-inline void state_getSP ( int* left, int* right )
+inline void state_getSP_r ( const stateCtx* ctx, int* left, int* right )
 {
 	if (left != NULL) {
-		(*left) = spLeft;
+		(*left) = ctx->spLeft;
 	}
 
 	if (right != NULL) {
-		(*right) = spRight;
+		(*right) = ctx->spRight;
 	}
 }
 
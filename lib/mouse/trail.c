@@ -0,0 +1,437 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/mouse/trail.c
+ *  \brief Implement the breadcrumb trail.
+ *
+ *  The simplification keeps, instead of the positions since the last
+ *   keyframe, the directions from it that pass within TRAIL_TOL of all of
+ *   them. Each position at distance d narrows them to its own direction
+ *   plus or minus asin(TRAIL_TOL / d), and the last position that left some
+ *   is the next keyframe. Coming back towards the last keyframe is caught by
+ *   the distance to it, the farthest position is then the next keyframe.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/trail.h>
+#include <conf.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <util/trig.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Returning, angle (as the tangent, in %) of the point followed
+ *   beyond which the robot spins in place towards it.
+ */
+#define SPIN_TAN      58
+
+/**
+ *  \brief Sentinel of the segment being returned along, the trail still has
+ *   to be closed at the current position.
+ */
+#define SEG_START    TRAIL_POINTS
+
+
+/* ===================
+ * Instance used by the non reentrant interface
+ */
+#ifdef TRAIL_DEFAULT
+static MR_TLS trailCtx trailDefault;
+#endif
+
+
+/* ========================================================================== */
+
+static void record   ( trailCtx* ctx, int x, int y );
+static void addPoint ( trailCtx* ctx, int x, int y );
+static void dropPoint ( trailCtx* ctx );
+static void drive    ( trailCtx* ctx, int x, int y, int degree );
+
+static void closest ( const trailCtx* ctx, uint i, int x, int y, int* qx, int* qy );
+
+static inline int dist  ( int dx, int dy );
+
+
+/* ==========================================================================
+ * Management
+ */
+
+void trail_init_r ( trailCtx* ctx, int x, int y )
+{
+	ctx->ptX[0] = x;
+	ctx->ptY[0] = y;
+	ctx->n      = 1;
+	ctx->state  = TRAIL_RECORD;
+	ctx->coneOn = false;
+	ctx->farD   = 0;
+	ctx->seg    = 0;
+	ctx->left   = 0;
+	ctx->right  = 0;
+}
+
+uint trail_update_r ( trailCtx* ctx, int x, int y, int degree )
+{
+	switch (ctx->state) {
+	case TRAIL_RECORD:
+		record(ctx, x, y);
+		break;
+
+	case TRAIL_RETURN:
+		/* Close the trail where the robot is */
+		if (ctx->seg == SEG_START) {
+			if (ctx->coneOn) {
+				addPoint(ctx, ctx->lastX, ctx->lastY);
+			}
+
+			if (ctx->n == 1 || dist(x - ctx->ptX[ctx->n - 1], y - ctx->ptY[ctx->n - 1]) >= TRAIL_STEP) {
+				addPoint(ctx, x, y);
+			}
+
+			ctx->seg = ctx->n - 1;
+		}
+
+		drive(ctx, x, y, degree);
+		break;
+	}
+
+	return ctx->state;
+}
+
+void trail_return_r ( trailCtx* ctx )
+{
+	if (ctx->state != TRAIL_RECORD)
+		return;
+
+	ctx->state = TRAIL_RETURN;
+	ctx->seg   = SEG_START;
+}
+
+#ifdef TRAIL_DEFAULT
+
+void trail_init ( void )
+{
+	int x, y;
+
+	sensors_position(&x, &y);
+	trail_init_r(&trailDefault, x, y);
+}
+
+uint trail_update ( void )
+{
+	int  x, y, left, right;
+	uint state;
+
+	sensors_position(&x, &y);
+
+	state = trail_update_r(&trailDefault, x, y, sensors_compass());
+
+	if (state != TRAIL_RECORD) {
+		trail_getVel_r(&trailDefault, &left, &right);
+		actuators_setVel(left, right);
+	}
+
+	return state;
+}
+
+void trail_return ( void )
+{
+	trail_return_r(&trailDefault);
+}
+
+#endif /* TRAIL_DEFAULT */
+
+
+/* ==========================================================================
+ * Queries
+ */
+
+void trail_getVel_r ( const trailCtx* ctx, int* left, int* right )
+{
+	if (left != NULL) {
+		(*left) = ctx->left;
+	}
+
+	if (right != NULL) {
+		(*right) = ctx->right;
+	}
+}
+
+uint trail_points_r ( const trailCtx* ctx, int* xs, int* ys, uint max )
+{
+	uint i;
+
+	for (i = 0; i < ctx->n && i < max; i++) {
+		if (xs != NULL) {
+			xs[i] = ctx->ptX[i];
+		}
+
+		if (ys != NULL) {
+			ys[i] = ctx->ptY[i];
+		}
+	}
+
+	return ctx->n;
+}
+
+#ifdef TRAIL_DEFAULT
+
+uint trail_points ( int* xs, int* ys, uint max )
+{
+	return trail_points_r(&trailDefault, xs, ys, max);
+}
+
+#endif /* TRAIL_DEFAULT */
+
+
+/* ==========================================================================
+ * Private functions
+ */
+
+/* ===================
+ * Narrow the directions from the last keyframe with a new position, or
+ *  start a new keyframe when none is left.
+ */
+static void record ( trailCtx* ctx, int x, int y )
+{
+	int dx = x - ctx->ptX[ctx->n - 1];
+	int dy = y - ctx->ptY[ctx->n - 1];
+	int d, a, half;
+
+	if (abs(dx) < TRAIL_STEP && abs(dy) < TRAIL_STEP && ctx->farD == 0)
+		return;
+
+	d = dist(dx, dy);
+
+	/* Going back towards the keyframe */
+	if (ctx->farD > 0 && d < ctx->farD - TRAIL_TOL) {
+		addPoint(ctx, ctx->farX, ctx->farY);
+		record(ctx, x, y);
+		return;
+	}
+
+	if (d < TRAIL_STEP)
+		return;
+
+	a    = trig_atan2(dy, dx);
+	half = (TRAIL_TOL * 57296) / d;
+	half = half > 90000 ? 90000 : half;
+
+	if (!ctx->coneOn) {
+		ctx->coneOn  = true;
+		ctx->coneRef = a;
+		ctx->coneLo  = -half;
+		ctx->coneHi  = half;
+	} else {
+		a = trig_norm(a - ctx->coneRef);
+
+		if (a < ctx->coneLo || a > ctx->coneHi) {
+			addPoint(ctx, ctx->lastX, ctx->lastY);
+			record(ctx, x, y);
+			return;
+		}
+
+		ctx->coneLo = a - half > ctx->coneLo ? a - half : ctx->coneLo;
+		ctx->coneHi = a + half < ctx->coneHi ? a + half : ctx->coneHi;
+	}
+
+	ctx->lastX = x;
+	ctx->lastY = y;
+
+	if (d > ctx->farD) {
+		ctx->farX = x;
+		ctx->farY = y;
+		ctx->farD = d;
+	}
+}
+
+/* ===================
+ * Add a keyframe, cutting out the loop back to the oldest segment it's
+ *  close to. The segment ending on the last keyframe can't be one, the new
+ *  keyframe is always close to it.
+ */
+static void addPoint ( trailCtx* ctx, int x, int y )
+{
+	int  qx, qy;
+	uint i;
+
+	ctx->coneOn = false;
+	ctx->farD   = 0;
+
+	for (i = 0; i + 2 < ctx->n; i++) {
+		closest(ctx, i, x, y, &qx, &qy);
+
+		if (abs(x - qx) < TRAIL_LOOP && abs(y - qy) < TRAIL_LOOP &&
+		    (x - qx) * (x - qx) + (y - qy) * (y - qy) < TRAIL_LOOP * TRAIL_LOOP) {
+			ctx->n = i + 1;
+
+			if (dist(qx - ctx->ptX[i], qy - ctx->ptY[i]) >= TRAIL_STEP) {
+				ctx->ptX[ctx->n] = qx;
+				ctx->ptY[ctx->n] = qy;
+				ctx->n++;
+			}
+
+			break;
+		}
+	}
+
+	if (ctx->n == TRAIL_POINTS) {
+		dropPoint(ctx);
+	}
+
+	ctx->ptX[ctx->n] = x;
+	ctx->ptY[ctx->n] = y;
+	ctx->n++;
+}
+
+/* ===================
+ * Drop the keyframe that makes the smallest triangle with its neighbours,
+ *  the one that changes the trail the least. The first and the last are
+ *  always kept.
+ */
+static void dropPoint ( trailCtx* ctx )
+{
+	int  area, best = -1;
+	uint i, drop = 1;
+
+	for (i = 1; i + 1 < ctx->n; i++) {
+		area = abs((ctx->ptX[i] - ctx->ptX[i - 1]) * (ctx->ptY[i + 1] - ctx->ptY[i - 1]) -
+		           (ctx->ptY[i] - ctx->ptY[i - 1]) * (ctx->ptX[i + 1] - ctx->ptX[i - 1]));
+
+		if (best < 0 || area < best) {
+			best = area;
+			drop = i;
+		}
+	}
+
+	for (i = drop; i + 1 < ctx->n; i++) {
+		ctx->ptX[i] = ctx->ptX[i + 1];
+		ctx->ptY[i] = ctx->ptY[i + 1];
+	}
+
+	ctx->n--;
+}
+
+/* ===================
+ * Pure pursuit of the point TRAIL_BLEND mm ahead, along the trail, of the
+ *  closest one of the segment being followed: the wheels follow the arc
+ *  through it tangent to the heading.
+ */
+static void drive ( trailCtx* ctx, int x, int y, int degree )
+{
+	int  c = trig_cos(degree * 1000);
+	int  s = trig_sin(degree * 1000);
+	int  ax, ay, ex, ey, len, along, qx, qy, d, tx, ty, gx, gy, home, vel, diff, outer;
+	uint i;
+
+	home = dist(x - ctx->ptX[0], y - ctx->ptY[0]);
+
+	if (home < TRAIL_HOME_DIST) {
+		ctx->state = TRAIL_HOME;
+		ctx->left  = 0;
+		ctx->right = 0;
+		return;
+	}
+
+	/* Past the end of the segment, or closer to the next one, on to it */
+	for (;;) {
+		ax    = ctx->ptX[ctx->seg];
+		ay    = ctx->ptY[ctx->seg];
+		ex    = ctx->ptX[ctx->seg - 1] - ax;
+		ey    = ctx->ptY[ctx->seg - 1] - ay;
+		len   = dist(ex, ey);
+		along = len == 0 ? 0 : ((x - ax) * ex + (y - ay) * ey) / len;
+		along = along < 0 ? 0 : along;
+
+		if (ctx->seg == 1)
+			break;
+
+		if (along < len) {
+			closest(ctx, ctx->seg - 1, x, y, &qx, &qy);
+			d = (x - qx) * (x - qx) + (y - qy) * (y - qy);
+			closest(ctx, ctx->seg - 2, x, y, &qx, &qy);
+
+			if ((x - qx) * (x - qx) + (y - qy) * (y - qy) >= d)
+				break;
+		}
+
+		ctx->seg--;
+	}
+
+	/* The point followed */
+	along += TRAIL_BLEND;
+	tx     = ctx->ptX[0];
+	ty     = ctx->ptY[0];
+
+	for (i = ctx->seg; i > 0; i--) {
+		ex  = ctx->ptX[i - 1] - ctx->ptX[i];
+		ey  = ctx->ptY[i - 1] - ctx->ptY[i];
+		len = dist(ex, ey);
+
+		if (along <= len) {
+			tx = ctx->ptX[i] + (ex * along) / len;
+			ty = ctx->ptY[i] + (ey * along) / len;
+			break;
+		}
+
+		along -= len;
+	}
+
+	/* In the frame of the robot */
+	gx = ((tx - x) * c + (ty - y) * s) >> TRIG_SHIFT;
+	gy = ((ty - y) * c - (tx - x) * s) >> TRIG_SHIFT;
+
+	vel = TRAIL_VEL;
+	vel = home < TRAIL_BLEND ? (vel * home) / TRAIL_BLEND : vel;
+
+	if (gx <= 0 || abs(gy) * 100 > gx * SPIN_TAN) {
+		ctx->left  = gy > 0 ? -vel / 2 :  vel / 2;
+		ctx->right = gy > 0 ?  vel / 2 : -vel / 2;
+		return;
+	}
+
+	/* Arc of curvature 2 gy / (gx^2 + gy^2), the outer wheel at vel */
+	diff  = (2 * vel * WHEEL_BASE * gy) / (gx * gx + gy * gy);
+	outer = vel + abs(diff) / 2;
+
+	ctx->left  = ((vel - diff / 2) * vel) / outer;
+	ctx->right = ((vel + diff / 2) * vel) / outer;
+}
+
+/* ===================
+ * Closest point to a position of the segment from keyframe i to i + 1
+ */
+static void closest ( const trailCtx* ctx, uint i, int x, int y, int* qx, int* qy )
+{
+	int ax   = ctx->ptX[i];
+	int ay   = ctx->ptY[i];
+	int ex   = ctx->ptX[i + 1] - ax;
+	int ey   = ctx->ptY[i + 1] - ay;
+	int len2 = ex * ex + ey * ey;
+	int t    = (x - ax) * ex + (y - ay) * ey;
+
+	/* t in 1/1024 of the length */
+	t     = t <= 0 ? 0 : (t >= len2 ? 1024 : t / ((len2 >> 10) + 1));
+	(*qx) = ax + (ex * t) / 1024;
+	(*qy) = ay + (ey * t) / 1024;
+}
+
+/* ===================
+ * Length of a vector
+ */
+static inline int dist ( int dx, int dy )
+{
+	return trig_sqrt(dx * dx + dy * dy);
+}
+
+
+/* = EOF ==================================================================== */
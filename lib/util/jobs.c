@@ -0,0 +1,182 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/util/jobs.c
+ *  \brief Implement the background jobs.
+ *
+ *  The time is measured with the core timer, except in the simulation,
+ *   where that's the host clock and the work done would depend on the host
+ *   load. There a job that did some work is charged its whole budget.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <util/jobs.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+static MR_TLS job  jobs[JOBS_MAX];
+static MR_TLS uint njobs = 0;
+static MR_TLS uint next  = 0;               // Job that goes first on the next run
+static MR_TLS uint cyclesTotal = 0;
+
+
+/* ========================================================================== */
+
+static inline uint spent ( uint start, uint work );
+
+
+/* ========================================================================== */
+
+void jobs_init ( void )
+{
+	njobs = 0;
+	next  = 0;
+	cyclesTotal = 0;
+}
+
+bool jobs_add ( const char* name, jobFunc func, void* arg )
+{
+	job* j;
+
+	if (njobs >= JOBS_MAX)
+		return false;
+
+	j = jobs + njobs++;
+
+	j->name = name;
+	j->func = func;
+	j->arg  = arg;
+
+	j->units      = 0;
+	j->time       = 0;
+	j->lastUnits  = 0;
+	j->lastTime   = 0;
+	j->totalUnits = 0;
+	j->totalTime  = 0;
+	j->cycles     = 0;
+	j->maxOver    = 0;
+
+	return true;
+}
+
+void jobs_remove ( jobFunc func, void* arg )
+{
+	uint i;
+
+	for (i = 0; i < njobs; i++) {
+		if (jobs[i].func == func && jobs[i].arg == arg) {
+			jobs[i] = jobs[--njobs];
+			next = 0;
+			return;
+		}
+	}
+}
+
+uint jobs_run ( uint slackUs )
+{
+	uint start = readCoreTimer();
+	uint total = 0;
+	uint idle  = 0;                         // Jobs in a row with nothing to do
+	uint work  = 0;                         // Time taken by the jobs
+	uint used, budget, t, units;
+	job* j;
+
+	while (njobs > 0 && idle < njobs) {
+		used = spent(start, work);
+
+		if (used + JOBS_GUARD_US >= slackUs)
+			break;
+
+		budget = slackUs - JOBS_GUARD_US - used;
+		budget = budget > JOBS_SLICE_US ? JOBS_SLICE_US : budget;
+
+		j    = jobs + next;
+		next = (next + 1) % njobs;
+
+		t     = readCoreTimer();
+		units = j->func(j->arg, budget);
+		t     = (readCoreTimer() - t) / CORE_US;
+
+#ifdef MR_SIM
+		t     = units ? budget : 0;
+#endif
+
+		work += t;
+
+		j->units += units;
+		j->time  += t;
+		j->maxOver = (t > budget && t - budget > j->maxOver) ? t - budget : j->maxOver;
+
+		total += units;
+		idle   = units ? 0 : idle + 1;
+	}
+
+	return total;
+}
+
+void jobs_cycle ( void )
+{
+	uint i;
+
+	cyclesTotal++;
+
+	for (i = 0; i < njobs; i++) {
+		jobs[i].lastUnits   = jobs[i].units;
+		jobs[i].lastTime    = jobs[i].time;
+		jobs[i].totalUnits += jobs[i].units;
+		jobs[i].totalTime  += jobs[i].time;
+		jobs[i].cycles     += jobs[i].units ? 1 : 0;
+
+		jobs[i].units = 0;
+		jobs[i].time  = 0;
+	}
+}
+
+const job* jobs_get ( uint i )
+{
+	return i < njobs ? jobs + i : NULL;
+}
+
+void jobs_report ( void )
+{
+	uint n = cyclesTotal ? cyclesTotal : 1;
+	uint i;
+
+	printf("%-12s %10s %8s %12s %10s %10s %8s\n", "job", "last", "last us", "per cycle",
+		"us/cycle", "busy", "max over");
+
+	for (i = 0; i < njobs; i++) {
+		printf("%-12s %10u %8u %12u %10u %9u%% %8u\n", jobs[i].name,
+			jobs[i].lastUnits, jobs[i].lastTime,
+			jobs[i].totalUnits / n, jobs[i].totalTime / n,
+			(jobs[i].cycles * 100) / n, jobs[i].maxOver);
+	}
+}
+
+
+/* ========================================================================== */
+
+/* ===================
+ * Time (in microseconds) taken since start, or in the simulation the time
+ *  charged to the jobs
+ */
+static inline uint spent ( uint start, uint work )
+{
+#ifdef MR_SIM
+	return work;
+#else
+	return (readCoreTimer() - start) / CORE_US;
+#endif
+}
+
+
+/* = EOF ==================================================================== */
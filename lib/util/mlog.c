@@ -0,0 +1,140 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/util/mlog.c
+ *  \brief Implement the binary logger.
+ *
+ *  The buffer is written by mlog_write() and read by mlog_drain(), both
+ *   from the main loop, so no locking is needed.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <util/mlog.h>
+#include <hal/robot.h>
+
+
+/* ========================================================================== */
+
+#define MLOG_BUF_MASK  (MLOG_BUF_WORDS - 1)
+
+static MR_TLS uint mlogBuf[MLOG_BUF_WORDS];
+static MR_TLS uint mlogHead    = 0;         // Next word to write
+static MR_TLS uint mlogTail    = 0;         // Next word to send
+static MR_TLS uint mlogDropped = 0;
+
+/* Bytes of the word being sent. 5 bytes when it's a header (sync + word) */
+static MR_TLS uchar txBytes[5];
+static MR_TLS uint  txPos   = 0;
+static MR_TLS uint  txLen   = 0;
+static MR_TLS uint  txNargs = 0;            // Argument words still to send
+
+
+/* ========================================================================== */
+
+void mlog_init ( void )
+{
+	mlogHead    = 0;
+	mlogTail    = 0;
+	mlogDropped = 0;
+
+	txPos   = 0;
+	txLen   = 0;
+	txNargs = 0;
+}
+
+void mlog_write ( uint level, uint id, uint nargs, const int* args )
+{
+	uint head = mlogHead;
+	uint tick = robot_ticks();
+	uint i;
+
+	if (nargs > MLOG_MAX_ARGS) {
+		nargs = MLOG_MAX_ARGS;
+	}
+
+	if (mlogDropped) {
+		if (MLOG_BUF_WORDS - (head - mlogTail) < nargs + 3) {
+			mlogDropped++;
+			return;
+		}
+
+		mlogBuf[head++ & MLOG_BUF_MASK] = MLOG_HDR(tick, MLOG_WARN, 1, MLOG_DROPPED);
+		mlogBuf[head++ & MLOG_BUF_MASK] = mlogDropped;
+		mlogDropped = 0;
+
+	} else if (MLOG_BUF_WORDS - (head - mlogTail) < nargs + 1) {
+		mlogDropped++;
+		return;
+	}
+
+	mlogBuf[head++ & MLOG_BUF_MASK] = MLOG_HDR(tick, level, nargs, id);
+
+	for (i = 0; i < nargs; i++) {
+		mlogBuf[head++ & MLOG_BUF_MASK] = args[i];
+	}
+
+	mlogHead = head;
+}
+
+uint mlog_drain ( void )
+{
+	uint sent = 0;
+	uint word;
+	uint i;
+
+	while (true) {
+		if (txPos == txLen) {
+			if (mlogTail == mlogHead)
+				return sent;
+
+			word = mlogBuf[mlogTail++ & MLOG_BUF_MASK];
+
+			txPos = 0;
+			txLen = 0;
+
+			if (txNargs == 0) {
+				txNargs = MLOG_HDR_NARGS(word);
+				txBytes[txLen++] = MLOG_SYNC;
+			} else {
+				txNargs--;
+			}
+
+			for (i = 0; i < 4; i++) {
+				txBytes[txLen++] = (word >> (8 * i)) & 0xFF;
+			}
+		}
+
+		if (!robot_serialPut(txBytes[txPos]))
+			return sent;
+
+		txPos++;
+		sent++;
+	}
+}
+
+void mlog_flush ( void )
+{
+	while (mlogTail != mlogHead || txPos != txLen) {
+		mlog_drain();
+	}
+}
+
+uint mlog_dropped ( void )
+{
+	return mlogDropped;
+}
+
+bool mlog_sending ( void )
+{
+	return (txPos != txLen || txNargs != 0);
+}
+
+
+/* = EOF ==================================================================== */
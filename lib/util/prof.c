@@ -0,0 +1,112 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/util/prof.c
+ *  \brief Implement the execution time of code regions.
+ *
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <util/prof.h>
+#include <detpic32.h>
+
+#ifdef MR_SIM
+#include <sim.h>
+#endif
+
+
+/* ========================================================================== */
+
+static MR_TLS profRegion* regions = NULL;
+
+
+/* ========================================================================== */
+
+void prof_end ( profRegion* region, uint end )
+{
+	uint cycles = end - region->start;          // Wraps correctly
+	int  bucket;
+
+	if (region->count == 0) {                   // First run
+		region->min  = cycles;
+		region->next = regions;
+		regions      = region;
+	}
+
+	region->count++;
+	region->sum += cycles;
+
+	region->min = cycles < region->min ? cycles : region->min;
+	region->max = cycles > region->max ? cycles : region->max;
+
+	bucket = cycles ? 32 - __builtin_clz(cycles) - PROF_FIRST_SHIFT : 0;
+	bucket = bucket < 0 ? 0 : (bucket >= PROF_BUCKETS ? PROF_BUCKETS - 1 : bucket);
+
+	region->hist[bucket]++;
+
+#ifdef MR_SIM
+	sim_traceEvent(region->name, region->start, end);
+#endif
+}
+
+const profRegion* prof_regions ( void )
+{
+	return regions;
+}
+
+uint prof_avg ( const profRegion* region )
+{
+	return region->count ? (uint) (region->sum / region->count) : 0;
+}
+
+void prof_reset ( void )
+{
+	profRegion* region;
+	int i;
+
+	for (region = regions; region != NULL; region = region->next) {
+		region->count = 0;
+		region->sum   = 0;
+		region->min   = 0;
+		region->max   = 0;
+
+		for (i = 0; i < PROF_BUCKETS; i++) {
+			region->hist[i] = 0;
+		}
+	}
+
+	/* Regions are linked again on their next run */
+	regions = NULL;
+}
+
+void prof_report ( void )
+{
+	const profRegion* region;
+	int i;
+
+	printf("%-24s %8s %9s %9s %9s  histogram (first < %d ns, x2)\n", "region", "runs",
+		"min us", "avg us", "max us", (1 << PROF_FIRST_SHIFT) * 50);
+
+	for (region = regions; region != NULL; region = region->next) {
+		printf("%-24s %8u %5u.%02u %6u.%02u %6u.%02u ", region->name, region->count,
+			region->min / CORE_US, (region->min % CORE_US) * (100 / CORE_US),
+			prof_avg(region) / CORE_US, (prof_avg(region) % CORE_US) * (100 / CORE_US),
+			region->max / CORE_US, (region->max % CORE_US) * (100 / CORE_US));
+
+		for (i = 0; i < PROF_BUCKETS; i++) {
+			printf(" %u", region->hist[i]);
+		}
+
+		printf("\n");
+	}
+}
+
+
+/* = EOF ==================================================================== */
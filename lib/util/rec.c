@@ -0,0 +1,296 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/util/rec.c
+ *  \brief Implement the record and replay of the robot inputs.
+ *
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <util/rec.h>
+#include <util/mlog.h>
+
+
+/* ========================================================================== */
+
+#define REC_OFF     0
+#define REC_RECORD  1
+#define REC_REPLAY  2
+
+/**
+ *  \brief Bytes sent on each MLOG_REC record. The first argument of the
+ *   record is the number of bytes, the others the bytes packed in words.
+ */
+#define REC_CHUNK   ((MLOG_MAX_ARGS - 1) * 4)
+
+/**
+ *  \brief Largest entry: tag and 5 varints of up to 5 bytes.
+ */
+#define REC_ENTRY_MAX  (1 + 5 * 5)
+
+static MR_TLS uint mode = REC_OFF;
+static MR_TLS uint cycles = 0;
+
+/* Recording */
+static MR_TLS uchar chunk[REC_CHUNK];
+static MR_TLS uint  chunkLen = 0;
+
+/* Replaying */
+static MR_TLS const uchar* journal = NULL;
+static MR_TLS uint journalLen = 0;
+static MR_TLS uint pos        = 0;
+static MR_TLS bool diverged   = false;
+
+
+/* ========================================================================== */
+
+static void flush  ( void );
+static void put    ( uint tag, uint nvalues, const int* values );
+static bool take   ( uint kind, uint* bit, uint nvalues, int* values );
+
+
+/* ==========================================================================
+ * Control
+ */
+
+void rec_record ( void )
+{
+	mode     = REC_RECORD;
+	cycles   = 0;
+	chunkLen = 0;
+}
+
+void rec_replay ( const uchar* data, uint len )
+{
+	mode     = REC_REPLAY;
+	cycles   = 0;
+	journal    = data;
+	journalLen = len;
+	pos        = 0;
+	diverged   = false;
+}
+
+void rec_stop ( void )
+{
+	if (mode == REC_RECORD) {
+		flush();
+	}
+
+	mode = REC_OFF;
+}
+
+bool rec_replaying ( void )
+{
+	return mode == REC_REPLAY;
+}
+
+bool rec_done ( void )
+{
+	return (journal != NULL && pos >= journalLen);
+}
+
+bool rec_diverged ( uint* cycle )
+{
+	if (diverged && cycle != NULL) {
+		(*cycle) = cycles;
+	}
+
+	return diverged;
+}
+
+uint rec_cycles ( void )
+{
+	return cycles;
+}
+
+uint rec_next ( void )
+{
+	if (mode != REC_REPLAY || pos >= journalLen)
+		return REC_END;
+
+	return REC_TAG_KIND(journal[pos]);
+}
+
+
+/* ==========================================================================
+ * Hooks
+ */
+
+uint rec_cycle ( uint late )
+{
+	int value = late;
+
+	if (mode == REC_RECORD) {
+		put(REC_TAG(REC_CYCLE, 0), 1, &value);
+		flush();
+	} else if (mode == REC_REPLAY) {
+		if (take(REC_CYCLE, NULL, 1, &value)) {
+			late = value;
+		}
+	} else {
+		return late;
+	}
+
+	cycles++;
+
+	return late;
+}
+
+void rec_sensors ( volatile int* adc )
+{
+	int values[5];
+	int i;
+
+	if (mode == REC_RECORD) {
+		for (i = 0; i < 5; i++) {
+			values[i] = adc[i];
+		}
+
+		put(REC_TAG(REC_SENSORS, 0), 5, values);
+
+	} else if (mode == REC_REPLAY && take(REC_SENSORS, NULL, 5, values)) {
+		for (i = 0; i < 5; i++) {
+			adc[i] = values[i];
+		}
+	}
+}
+
+void rec_encoders ( volatile int* left, volatile int* right )
+{
+	int values[2];
+
+	if (mode == REC_RECORD) {
+		values[0] = (*left);
+		values[1] = (*right);
+
+		put(REC_TAG(REC_ENCODERS, 0), 2, values);
+
+	} else if (mode == REC_REPLAY && take(REC_ENCODERS, NULL, 2, values)) {
+		(*left)  = values[0];
+		(*right) = values[1];
+	}
+}
+
+uint rec_bit ( uint kind, uint bit )
+{
+	if (mode == REC_RECORD) {
+		put(REC_TAG(kind, bit), 0, NULL);
+	} else if (mode == REC_REPLAY) {
+		take(kind, &bit, 0, NULL);
+	}
+
+	return bit;
+}
+
+void rec_vel ( int* left, int* right )
+{
+	int values[2];
+
+	if (mode == REC_RECORD) {
+		values[0] = (*left);
+		values[1] = (*right);
+
+		put(REC_TAG(REC_VEL, 0), 2, values);
+
+	} else if (mode == REC_REPLAY && take(REC_VEL, NULL, 2, values)) {
+		(*left)  = values[0];
+		(*right) = values[1];
+	}
+}
+
+
+/* ==========================================================================
+ * Helper functions
+ */
+
+/* ===================
+ * Send the recorded bytes on a MLOG_REC record
+ */
+static void flush ( void )
+{
+	int  args[MLOG_MAX_ARGS];
+	uint i;
+
+	if (chunkLen == 0)
+		return;
+
+	args[0] = chunkLen;
+
+	for (i = 0; i < (chunkLen + 3) / 4; i++) {
+		args[i + 1] = chunk[4 * i] | chunk[4 * i + 1] << 8 |
+		              chunk[4 * i + 2] << 16 | (uint) chunk[4 * i + 3] << 24;
+	}
+
+	mlog_write(MLOG_DEBUG, MLOG_REC, i + 1, args);
+
+	chunkLen = 0;
+}
+
+static void put ( uint tag, uint nvalues, const int* values )
+{
+	uint v, i;
+
+	if (chunkLen + REC_ENTRY_MAX > REC_CHUNK) {
+		flush();
+	}
+
+	chunk[chunkLen++] = tag;
+
+	for (i = 0; i < nvalues; i++) {
+		v = ((uint) values[i] << 1) ^ (uint) (values[i] >> 31);
+
+		while (v >= 0x80) {
+			chunk[chunkLen++] = (v & 0x7F) | 0x80;
+			v >>= 7;
+		}
+
+		chunk[chunkLen++] = v;
+	}
+}
+
+static bool take ( uint kind, uint* bit, uint nvalues, int* values )
+{
+	uint tag, v, shift, i;
+
+	if (pos >= journalLen || REC_TAG_KIND(journal[pos]) != kind) {
+		diverged = (pos < journalLen);
+		mode     = REC_OFF;
+		return false;
+	}
+
+	tag = journal[pos++];
+
+	if (bit != NULL) {
+		(*bit) = REC_TAG_BIT(tag);
+	}
+
+	for (i = 0; i < nvalues; i++) {
+		v     = 0;
+		shift = 0;
+
+		do {
+			if (pos >= journalLen || shift > 28) {
+				diverged = true;                    // Truncated journal
+				mode     = REC_OFF;
+				return false;
+			}
+
+			v |= (uint) (journal[pos] & 0x7F) << shift;
+			shift += 7;
+		} while (journal[pos++] & 0x80);
+
+		values[i] = (int) (v >> 1) ^ -(int) (v & 1);
+	}
+
+	return true;
+}
+
+
+/* = EOF ==================================================================== */
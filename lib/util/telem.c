@@ -0,0 +1,219 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/util/telem.c
+ *  \brief Implement the telemetry stream.
+ *
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <util/telem.h>
+#include <util/mlog.h>
+#include <hal/robot.h>
+#include <mouse/mouse.h>
+#include <mouse/sensors.h>
+#include <mouse/state.h>
+
+
+/* ========================================================================== */
+
+static MR_TLS uchar frame[TELEM_FRAME_MAX];
+static MR_TLS uchar wire[TELEM_WIRE_MAX];      // Being sent by DMA
+
+static MR_TLS int  prev[TELEM_N_FIELDS];       // Values on the last frame
+static MR_TLS uint fieldMask = 0;
+static MR_TLS uint seq       = 0;
+static MR_TLS uint sinceKey  = 0;              // Frames since the last key frame
+static MR_TLS uint skipped   = 0;
+
+
+/* ========================================================================== */
+
+static int   field     ( uint id );
+static uchar* putVarint ( uchar* p, int value );
+static uint  crc16     ( const uchar* data, uint len );
+static uint  cobs      ( const uchar* src, uint len, uchar* dst );
+
+
+/* ========================================================================== */
+
+void telem_init ( uint mask )
+{
+	fieldMask = mask & TELEM_ALL;
+	seq       = 0;
+	sinceKey  = 0;
+	skipped   = 0;
+}
+
+void telem_send ( void )
+{
+	uchar* p = frame;
+	uint tick = robot_ticks();
+	bool key  = (sinceKey == 0);
+	uint crc, len, i;
+	int  value;
+
+	if (robot_serialBusy() || mlog_sending() || mouse_mode() >= MOUSE_SHED) {
+		skipped++;
+		return;
+	}
+
+	*p++ = seq;
+	*p++ = key ? TELEM_KEY : 0;
+	*p++ = tick & 0xFF;
+	*p++ = (tick >> 8) & 0xFF;
+
+	if (key) {
+		for (i = 0; i < 4; i++) {
+			*p++ = (fieldMask >> (8 * i)) & 0xFF;
+		}
+	}
+
+	for (i = 0; i < TELEM_N_FIELDS; i++) {
+		if (!(fieldMask & (1u << i)))
+			continue;
+
+		value = field(i);
+		p = putVarint(p, key ? value : value - prev[i]);
+		prev[i] = value;
+	}
+
+	crc  = crc16(frame, p - frame);
+	*p++ = crc & 0xFF;
+	*p++ = (crc >> 8) & 0xFF;
+
+	wire[0]       = 0;
+	len           = cobs(frame, p - frame, &wire[1]);
+	wire[len + 1] = 0;
+
+	robot_serialSend(wire, len + 2);
+
+	seq = (seq + 1) & 0xFF;
+
+	if (++sinceKey >= TELEM_KEY_PERIOD) {
+		sinceKey = 0;
+	}
+}
+
+uint telem_skipped ( void )
+{
+	return skipped;
+}
+
+
+/* ==========================================================================
+ * Helper functions
+ */
+
+static int field ( uint id )
+{
+	int left, right;
+
+	switch (id) {
+	case TELEM_RAW_OBST_L:  return sensors.obst_sens_left;
+	case TELEM_RAW_OBST_F:  return sensors.obst_sens_front;
+	case TELEM_RAW_OBST_R:  return sensors.obst_sens_right;
+	case TELEM_RAW_BATTERY: return sensors.battery;
+	case TELEM_RAW_GROUND:  return sensors.ground;
+	case TELEM_RAW_ENC_L:   return sensors.enc_left;
+	case TELEM_RAW_ENC_R:   return sensors.enc_right;
+
+	case TELEM_VEL_L:       return actuators.vel_left;
+	case TELEM_VEL_R:       return actuators.vel_right;
+	case TELEM_SERVO:       return actuators.servo_pos;
+	case TELEM_LEDS:        return actuators.leds;
+
+	case TELEM_SP_L:        state_getSP(&left, &right); return left;
+	case TELEM_SP_R:        state_getSP(&left, &right); return right;
+	case TELEM_YAW:         return state_getYaw();
+
+	case TELEM_OBST_L:      return sensors_obstL();
+	case TELEM_OBST_F:      return sensors_obstF();
+	case TELEM_OBST_R:      return sensors_obstR();
+	case TELEM_GROUND:      return (sensors_groundL()  << 4) | (sensors_groundCL() << 3) |
+	                               (sensors_groundCF() << 2) | (sensors_groundCR() << 1) |
+	                                sensors_groundR();
+	case TELEM_BEACON:      return sensors_beacon();
+	case TELEM_BEACON_DIR:  return sensors_beaconDir();
+	case TELEM_ODO_L:       sensors_odoPart(&left, &right); return left;
+	case TELEM_ODO_R:       sensors_odoPart(&left, &right); return right;
+	case TELEM_COMPASS:     return sensors_compass();
+	case TELEM_BATTERY:     return sensors_battery();
+	case TELEM_BUMP:        return sensors_bump();
+	}
+
+	return 0;
+}
+
+/* ===================
+ * Zig-zag varint: 7 bits per byte, least significant first, small
+ *  magnitudes of both signs take one byte.
+ */
+static uchar* putVarint ( uchar* p, int value )
+{
+	uint v = ((uint) value << 1) ^ (uint) (value >> 31);
+
+	while (v >= 0x80) {
+		*p++ = (v & 0x7F) | 0x80;
+		v >>= 7;
+	}
+
+	*p++ = v;
+
+	return p;
+}
+
+/* ===================
+ * CRC-16/CCITT (poly 0x1021, init 0xFFFF)
+ */
+static uint crc16 ( const uchar* data, uint len )
+{
+	uint crc = 0xFFFF;
+	uint i, b;
+
+	for (i = 0; i < len; i++) {
+		crc ^= (uint) data[i] << 8;
+
+		for (b = 0; b < 8; b++) {
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+
+	return crc & 0xFFFF;
+}
+
+/* ===================
+ * Consistent overhead byte stuffing, removes the 0x00 bytes so they can
+ *  delimit the frames.
+ */
+static uint cobs ( const uchar* src, uint len, uchar* dst )
+{
+	uint code = 0;                              // Position of the code byte
+	uint out  = 1;
+	uint i;
+
+	for (i = 0; i < len; i++) {
+		if (src[i] != 0) {
+			dst[out++] = src[i];
+		}
+
+		if (src[i] == 0 || out - code == 0xFF) {
+			dst[code] = out - code;
+			code = out++;
+		}
+	}
+
+	dst[code] = out - code;
+
+	return out;
+}
+
+
+/* = EOF ==================================================================== */
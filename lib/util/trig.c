@@ -0,0 +1,157 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  lib/util/trig.c
+ *  \brief Implement the integer trigonometry.
+ *
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <util/trig.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief sin(d) * TRIG_ONE for d in [0, 90] degrees.
+ */
+static const short sinTable[91] = {
+	    0,   286,   572,   857,  1143,  1428,  1713,  1997,  2280,  2563,
+	 2845,  3126,  3406,  3686,  3964,  4240,  4516,  4790,  5063,  5334,
+	 5604,  5872,  6138,  6402,  6664,  6924,  7182,  7438,  7692,  7943,
+	 8192,  8438,  8682,  8923,  9162,  9397,  9630,  9860, 10087, 10311,
+	10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+	12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+	14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+	15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+	16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+	16384
+};
+
+/**
+ *  \brief atan(i / 64) in millidegrees for i in [0, 64].
+ */
+#define ATAN_STEPS  64
+
+static const ushort atanTable[ATAN_STEPS + 1] = {
+	    0,   895,  1790,  2684,  3576,  4467,  5356,  6242,  7125,  8005,
+	 8881,  9752, 10620, 11482, 12339, 13191, 14036, 14876, 15709, 16535,
+	17354, 18166, 18970, 19767, 20556, 21337, 22109, 22874, 23629, 24376,
+	25115, 25844, 26565, 27277, 27979, 28673, 29358, 30033, 30700, 31357,
+	32005, 32645, 33275, 33896, 34509, 35112, 35707, 36293, 36870, 37439,
+	37999, 38550, 39094, 39629, 40156, 40675, 41186, 41689, 42184, 42672,
+	43152, 43625, 44091, 44549, 45000
+};
+
+
+/* ========================================================================== */
+
+int trig_sin ( int mdegree )
+{
+	int sign = 1;
+	int d, r;
+
+	mdegree %= 360000;
+	mdegree += mdegree < 0 ? 360000 : 0;
+
+	if (mdegree >= 180000) {                    // sin(a) = -sin(a - 180)
+		mdegree -= 180000;
+		sign = -1;
+	}
+
+	if (mdegree > 90000) {                      // sin(a) = sin(180 - a)
+		mdegree = 180000 - mdegree;
+	}
+
+	d = mdegree / 1000;
+	r = mdegree % 1000;
+
+	if (r == 0)
+		return sign * sinTable[d];
+
+	return sign * (sinTable[d] + ((sinTable[d + 1] - sinTable[d]) * r + 500) / 1000);
+}
+
+int trig_cos ( int mdegree )
+{
+	return trig_sin(90000 - (mdegree % 360000));
+}
+
+int trig_norm ( int mdegree )
+{
+	mdegree %= 360000;
+
+	return mdegree > 180000 ? mdegree - 360000 : (mdegree <= -180000 ? mdegree + 360000 : mdegree);
+}
+
+int trig_atan2 ( int y, int x )
+{
+	uint ax = x < 0 ? -x : x;
+	uint ay = y < 0 ? -y : y;
+	uint num, den, t, i;
+	int  a;
+
+	if (ax == 0 && ay == 0)
+		return 0;
+
+	/* First octant: t = min / max in [0, 1], scaled by ATAN_STEPS << 8 */
+	num = ay < ax ? ay : ax;
+	den = ay < ax ? ax : ay;
+
+	while (num >= (1u << 17)) {                 // Keep num * (64 << 8) in range
+		num >>= 1;
+		den >>= 1;
+	}
+
+	t = (num * (ATAN_STEPS << 8)) / den;
+	i = t >> 8;
+
+	a = atanTable[i];
+
+	if (i < ATAN_STEPS) {
+		a += ((atanTable[i + 1] - atanTable[i]) * (t & 0xFF) + 128) >> 8;
+	}
+
+	/* Back to the whole circle */
+	if (ay > ax)
+		a = 90000 - a;
+
+	if (x < 0)
+		a = 180000 - a;
+
+	return (y < 0 && a != 180000) ? -a : a;
+}
+
+uint trig_sqrt ( uint value )
+{
+	uint root = 0;
+	uint bit  = 1u << 30;
+
+	while (bit > value) {
+		bit >>= 2;
+	}
+
+	/* One bit of the root per step, from the highest */
+	while (bit != 0) {
+		if (value >= root + bit) {
+			value -= root + bit;
+			root   = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+
+		bit >>= 2;
+	}
+
+	return root;
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,528 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  sim/batch.c
+ *  \brief Run many simulated robots, with different parameters, in parallel.
+ *
+ *  Every combination of the parameter values given in the command line is
+ *   run against a number of seeds. Each run drives a robot from the
+ *   (jittered) arena start pose to the target area below the beacon with a
+ *   simple reactive controller built on the sensors and actuators modules,
+ *   and its outcome is written as one line of CSV to the standard output.
+ *
+ *    usage: batch [-j threads] [-n seeds] [-s seed] [-t seconds] [-a arena]
+ *                 [name=v1,v2,... ...]
+ *
+ *  The arena defaults to DEFAULT_ARENA, next to the batch program, which
+ *   keeps the obstacles off the direct path to the target.
+ *
+ *  The parameters are kp, ki (both wheels), ground, beacon, bumpst (filter
+ *   thresholds), bump (stuck threshold) and speed (cm/s). The ones not
+ *   given keep the library defaults.
+ *
+ *  Runs are spread over the threads with a work stealing pool, each thread
+ *   simulating one robot at a time with its own module instances. The seed
+ *   of each run only depends on the base seed and on the seed index, so the
+ *   results are the same whatever the number of threads, and runs with the
+ *   same seed index see the same start pose and sensor noise.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+/* System headers go first, base.h defines an abs() macro */
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <base.h>
+#include <sim.h>
+#include <conf.h>
+#include <hal/robot.h>
+#include <mouse/state.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Cycles driving straight at the start, over which the wheels
+ *   speed overshoot is measured.
+ */
+#define LAUNCH_CYCLES    50
+
+/**
+ *  \brief Obstacle distance (in cm) below which the robot turns away.
+ */
+#define OBST_NEAR       19
+
+/**
+ *  \brief Cycles spent backing off (and then turning) after a bump.
+ */
+#define ESCAPE_CYCLES    40
+
+/**
+ *  \brief Cycles the robot waits for the beacon sweep, and then turns,
+ *   when the beacon is not in sight.
+ */
+#define SEARCH_WAIT     120
+#define SEARCH_TURN      30
+
+/**
+ *  \brief Cycles the robot is kept stopped after reaching the target.
+ */
+#define STOP_CYCLES      50
+
+/**
+ *  \brief Maximum start pose jitter (mm).
+ */
+#define START_JITTER    100
+
+/**
+ *  \brief Arena used when none is given, relative to the folder of the
+ *   batch program.
+ */
+#define DEFAULT_ARENA   "arenas/open.arena"
+
+
+/* ========================================================================== */
+
+#define MAX_VALUES 16
+#define MAX_THREADS 256
+
+enum { P_KP, P_KI, P_GROUND, P_BEACON, P_BUMPST, P_BUMP, P_SPEED, N_PARAMS };
+
+static const char* paramNames[N_PARAMS] = {
+	"kp", "ki", "ground", "beacon", "bumpst", "bump", "speed"
+};
+
+typedef struct {
+	int n;
+	int v[MAX_VALUES];
+} batchParam;
+
+typedef struct {
+	int  p[N_PARAMS];
+	uint seed;
+
+	bool reached;
+	uint time;                     ///< ms
+	int  overshoot;                ///< %
+	uint collisions;
+	int  dist;                     ///< mm
+} batchRun;
+
+/* ===================
+ * Work stealing queue: the runs [head, tail) still to do
+ */
+typedef struct {
+	pthread_mutex_t lock;
+	int             head;
+	int             tail;
+} batchQueue;
+
+
+/* ========================================================================== */
+
+static batchParam params[N_PARAMS];
+
+static simArena   arena;
+static uint       maxCycles = 6000;
+
+static batchRun*  runs;
+static int        nRuns;
+
+static batchQueue queues[MAX_THREADS];
+static int        nThreads;
+
+
+/* ========================================================================== */
+
+static void  runOne     ( batchRun* run );
+static void* worker     ( void* arg );
+static bool  takeRun    ( int self, int* run );
+static uint  mix        ( uint x );
+static bool  parseParam ( const char* arg );
+
+
+/* ========================================================================== */
+
+int main ( int argc, char** argv )
+{
+	pthread_t threads[MAX_THREADS];
+	char      path[FILENAME_MAX];
+	char*     arenaFile = NULL;
+	long      t;
+	int       seeds    = 4;
+	uint      baseSeed = 1;
+	int       opt;
+	int       i, j, k;
+
+	nThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+	while ((opt = getopt(argc, argv, "j:n:s:t:a:")) != -1) {
+		switch (opt) {
+		case 'j': nThreads  = atoi(optarg);                           break;
+		case 'n': seeds     = atoi(optarg);                           break;
+		case 's': baseSeed  = strtoul(optarg, NULL, 0);               break;
+		case 't': maxCycles = (uint) (atof(optarg) * 1000 / CICLE_T); break;
+		case 'a': arenaFile = optarg;                                 break;
+		default:
+			fprintf(stderr, "usage: %s [-j threads] [-n seeds] [-s seed] "
+			                "[-t seconds] [-a arena] [name=v1,v2,... ...]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (arenaFile == NULL) {
+		snprintf(path, sizeof(path), "%.*s%s",
+		         strrchr(argv[0], '/') ? (int) (strrchr(argv[0], '/') - argv[0] + 1) : 0,
+		         argv[0], DEFAULT_ARENA);
+		arenaFile = path;
+	}
+
+	if (!sim_loadArena(&arena, arenaFile)) {
+		fprintf(stderr, "batch: can't load arena %s\n", arenaFile);
+		return 1;
+	}
+
+	nThreads = nThreads < 1 ? 1 : (nThreads > MAX_THREADS ? MAX_THREADS : nThreads);
+	seeds    = seeds < 1 ? 1 : seeds;
+
+	for (; optind < argc; optind++) {
+		if (!parseParam(argv[optind])) {
+			fprintf(stderr, "batch: bad parameter %s\n", argv[optind]);
+			return 1;
+		}
+	}
+
+	/* The runs are the cartesian product of the values times the seeds */
+	nRuns = seeds;
+
+	for (i = 0; i < N_PARAMS; i++) {
+		nRuns *= params[i].n ? params[i].n : 1;
+	}
+
+	runs = calloc(nRuns, sizeof(batchRun));
+
+	for (i = 0; i < nRuns; i++) {
+		k = i / seeds;
+
+		for (j = N_PARAMS - 1; j >= 0; j--) {
+			if (params[j].n) {
+				runs[i].p[j] = params[j].v[k % params[j].n];
+				k /= params[j].n;
+			} else {
+				runs[i].p[j] = -1;       // Library default
+			}
+		}
+
+		runs[i].seed = mix(baseSeed * 2654435761u + (i % seeds));
+	}
+
+	/* Each thread starts with a contiguous slice of the runs */
+	for (t = 0; t < nThreads; t++) {
+		pthread_mutex_init(&queues[t].lock, NULL);
+		queues[t].head = (int) ((nRuns * t) / nThreads);
+		queues[t].tail = (int) ((nRuns * (t + 1)) / nThreads);
+	}
+
+	for (t = 0; t < nThreads; t++) {
+		pthread_create(threads + t, NULL, worker, (void*) t);
+	}
+
+	for (t = 0; t < nThreads; t++) {
+		pthread_join(threads[t], NULL);
+	}
+
+	printf("run,seed");
+	for (j = 0; j < N_PARAMS; j++) {
+		printf(",%s", paramNames[j]);
+	}
+	printf(",reached,time_ms,overshoot,collisions,dist_mm\n");
+
+	for (i = 0; i < nRuns; i++) {
+		printf("%d,%u", i, runs[i].seed);
+
+		for (j = 0; j < N_PARAMS; j++) {
+			printf(",%d", runs[i].p[j]);
+		}
+
+		printf(",%d,%u,%d,%u,%d\n", runs[i].reached, runs[i].time,
+		       runs[i].overshoot, runs[i].collisions, runs[i].dist);
+	}
+
+	free(runs);
+
+	return 0;
+}
+
+
+/* ==========================================================================
+ * Simulation of one robot
+ */
+
+static void runOne ( batchRun* run )
+{
+	simArena     a = arena;
+	stateCtx     state;
+	sensorsCtx   sens;
+	actuatorsCtx acts;
+
+	uint groundSt, beaconSt, bumpSt;
+	int  bumpThr;
+	int  kpL, kiL, kpR, kiR;
+	int  speed;
+	int  spL, spR;
+	int  peak = 0;
+	int  launchSp = 0;
+	int  escape = 0;
+	int  stop = 0;
+	int  search = 0;
+	int  left, right;
+	int  turn;
+	uint rng;
+	uint c;
+
+	/* Start pose jitter */
+	rng = run->seed;
+	rng = mix(rng); a.startX += (int) (rng % (2 * START_JITTER + 1)) - START_JITTER;
+	rng = mix(rng); a.startY += (int) (rng % (2 * START_JITTER + 1)) - START_JITTER;
+	rng = mix(rng); a.startHeading = (int) (rng % 360);
+
+	sim_setup(&a, NULL, run->seed);
+
+	robot_init();
+
+	state_init_r(&state);
+	sensors_init_r(&sens, &state);
+	actuators_init_r(&acts, &state);
+
+	/* Parameters (-1 keeps the default) */
+	actuators_getPIGains_r(&acts, &kpL, &kiL, &kpR, &kiR);
+	kpL = kpR = run->p[P_KP] >= 0 ? run->p[P_KP] : kpL;
+	kiL = kiR = run->p[P_KI] >= 0 ? run->p[P_KI] : kiL;
+	actuators_setPIGains_r(&acts, kpL, kiL, kpR, kiR);
+
+	sensors_getThresholds_r(&sens, &groundSt, &beaconSt, &bumpSt, &bumpThr);
+	groundSt = run->p[P_GROUND] >= 0 ? (uint) run->p[P_GROUND] : groundSt;
+	beaconSt = run->p[P_BEACON] >= 0 ? (uint) run->p[P_BEACON] : beaconSt;
+	bumpSt   = run->p[P_BUMPST] >= 0 ? (uint) run->p[P_BUMPST] : bumpSt;
+	bumpThr  = run->p[P_BUMP]   >= 0 ? run->p[P_BUMP]          : bumpThr;
+	sensors_setThresholds_r(&sens, groundSt, beaconSt, bumpSt, bumpThr);
+
+	speed = run->p[P_SPEED] >= 0 ? run->p[P_SPEED] : 30;
+
+	actuators_beaconTrack_r(&acts, true);
+
+	for (c = 0; c < maxCycles; c++) {
+		sim_step();
+
+		sensors_update_r(&sens);
+
+		if (run->reached) {
+			actuators_setVel_r(&acts, 0, 0);
+
+			if (++stop >= STOP_CYCLES)
+				break;
+
+		} else if (sensors_groundC_r(&sens)) {
+			run->reached = true;
+			run->time    = sim_time();
+			actuators_setVel_r(&acts, 0, 0);
+
+		} else if (c < LAUNCH_CYCLES) {
+			/* Straight line step response */
+			actuators_setVel_r(&acts, speed, speed);
+			state_getSP_r(&state, &spL, &spR);
+
+			launchSp = spL > launchSp ? spL : launchSp;
+
+			peak = sensors.enc_left  - spL > peak ? sensors.enc_left  - spL : peak;
+			peak = sensors.enc_right - spR > peak ? sensors.enc_right - spR : peak;
+
+		} else if (escape > 0) {
+			escape--;
+
+			if (escape > ESCAPE_CYCLES / 2) {
+				actuators_setVel_r(&acts, -speed / 2, -speed / 2);
+			} else {
+				actuators_setVel_r(&acts, speed / 2, -speed / 2);
+			}
+
+		} else if (sensors_bump_r(&sens)) {
+			escape = ESCAPE_CYCLES;
+
+		} else if (sensors_obstF() < OBST_NEAR) {
+			/* Spin away from the closest side */
+			if (sensors_obstL() < sensors_obstR()) {
+				actuators_setVel_r(&acts, speed / 2, -speed / 2);
+			} else {
+				actuators_setVel_r(&acts, -speed / 2, speed / 2);
+			}
+
+		} else if (sensors_obstL() < OBST_NEAR) {
+			actuators_setVel_r(&acts, speed, speed / 3);
+
+		} else if (sensors_obstR() < OBST_NEAR) {
+			actuators_setVel_r(&acts, speed / 3, speed);
+
+		} else if (sensors_beaconConf_r(&sens) > 0) {
+			/* The beacon direction is positive to the right */
+			turn  = (sensors_beaconDir_r(&sens) * speed) / 60;
+			left  = speed + turn;
+			right = speed - turn;
+
+			actuators_setVel_r(&acts, left, right);
+
+		} else {
+			/* Beacon out of sight, stop while sweeping then turn */
+			search = (search + 1) % (SEARCH_WAIT + SEARCH_TURN);
+
+			if (search < SEARCH_WAIT) {
+				actuators_setVel_r(&acts, 0, 0);
+			} else {
+				actuators_setVel_r(&acts, speed / 2, -speed / 2);
+			}
+		}
+
+		actuators_update_r(&acts);
+	}
+
+	run->overshoot  = launchSp > 0 ? (peak * 100) / launchSp : 0;
+	run->collisions = sim_collisions();
+	run->dist       = sim_beaconDist();
+}
+
+
+/* ==========================================================================
+ * Work stealing pool
+ */
+
+static void* worker ( void* arg )
+{
+	int self = (int) (long) arg;
+	int run;
+
+	while (takeRun(self, &run)) {
+		runOne(runs + run);
+	}
+
+	return NULL;
+}
+
+/* ===================
+ * Take a run from the own queue, or steal half of the runs left in the
+ *  queue of another thread.
+ */
+static bool takeRun ( int self, int* run )
+{
+	batchQueue* own = queues + self;
+	batchQueue* victim;
+	int         half;
+	int         i;
+
+	pthread_mutex_lock(&own->lock);
+
+	if (own->head < own->tail) {
+		(*run) = own->head++;
+		pthread_mutex_unlock(&own->lock);
+		return true;
+	}
+
+	pthread_mutex_unlock(&own->lock);
+
+	for (i = 1; i < nThreads; i++) {
+		victim = queues + (self + i) % nThreads;
+
+		pthread_mutex_lock(&victim->lock);
+
+		if (victim->head >= victim->tail) {
+			pthread_mutex_unlock(&victim->lock);
+			continue;
+		}
+
+		/* Steal from the end, the owner takes from the beginning */
+		half          = (victim->tail - victim->head + 1) / 2;
+		victim->tail -= half;
+
+		pthread_mutex_unlock(&victim->lock);
+
+		pthread_mutex_lock(&own->lock);
+		own->head = victim->tail + 1;
+		own->tail = victim->tail + half;
+		pthread_mutex_unlock(&own->lock);
+
+		(*run) = victim->tail;
+		return true;
+	}
+
+	return false;
+}
+
+
+/* ========================================================================== */
+
+/* ===================
+ * Integer hash (used to derive independent seeds)
+ */
+static uint mix ( uint x )
+{
+	x ^= x >> 16;
+	x *= 0x7FEB352Du;
+	x ^= x >> 15;
+	x *= 0x846CA68Bu;
+	x ^= x >> 16;
+
+	return x ? x : 1;
+}
+
+static bool parseParam ( const char* arg )
+{
+	const char* eq;
+	char*       end;
+	batchParam* p = NULL;
+	int         i;
+
+	if ((eq = strchr(arg, '=')) == NULL)
+		return false;
+
+	for (i = 0; i < N_PARAMS; i++) {
+		if (strlen(paramNames[i]) == (size_t) (eq - arg) &&
+		    strncmp(arg, paramNames[i], eq - arg) == 0) {
+			p = params + i;
+		}
+	}
+
+	if (p == NULL)
+		return false;
+
+	p->n = 0;
+
+	do {
+		if (p->n == MAX_VALUES)
+			return false;
+
+		p->v[p->n++] = (int) strtol(eq + 1, &end, 0);
+
+		if (end == eq + 1)
+			return false;
+
+		eq = end;
+	} while ((*eq) == ',');
+
+	return (*eq) == '\0';
+}
+
+
+/* = EOF ==================================================================== */
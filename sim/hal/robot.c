@@ -0,0 +1,456 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  sim/hal/robot.c
+ *  \brief Implement the robot library on top of the host simulation.
+ *
+ *  This is the host counterpart of lib/hal/robot.c. The structure and the
+ *   behavior visible through inc/hal/robot.h are kept the same, including
+ *   the timer 2 interrupt, which is called by the simulation every tick.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+/* System headers go first, base.h defines an abs() macro */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <base.h>
+#include <hal/robot.h>
+#include <conf.h>
+#include <sim.h>
+#include <util/rec.h>
+#include <detpic32.h>
+
+#include "../world.h"
+
+
+/* ==========================================================================
+ * Configuration values [can be changed]
+ */
+
+/**
+ *  \brief Watchdog period in milliseconds (the robot one depends on the
+ *   configuration bits).
+ */
+#define WDT_PERIOD  1024
+
+
+/* ========================================================================== */
+
+volatile MR_TLS mrSens  sensors;
+volatile MR_TLS mrActs  actuators;
+volatile MR_TLS mrClock ticker;
+
+static MR_TLS uint cntT2Ticks = 0;
+
+static MR_TLS bool wdtOn    = false;
+static MR_TLS uint wdtClear = 0;        // Simulation time of the last clear
+
+#ifdef ISR_PROF
+static MR_TLS mrIsrStats isrStats[N_ISRS];
+static MR_TLS uint       isrResetTime = 0;
+#endif
+
+
+/* ========================================================================== */
+
+static void replayEnd ( void );
+
+
+/* ==========================================================================
+ * Management
+ */
+
+void robot_init ( void )
+{
+	world_init();
+
+	actuators.vel_left  = 0;
+	actuators.vel_right = 0;
+	actuators.leds      = 0;
+
+	robot_setServo(0);
+
+	cntT2Ticks   = 0;
+	ticker.ticks = 0;
+
+	wdtOn = false;
+}
+
+void robot_enableObstSens ( void )
+{
+}
+
+void robot_disableObstSens ( void )
+{
+}
+
+void robot_enableGroundSens ( void )
+{
+}
+
+void robot_disableGroundSens ( void )
+{
+}
+
+void robot_idle ( void )
+{
+	replayEnd();
+
+	if (rec_replaying()) {
+		isr_t2();                               // The world isn't used
+	} else {
+		sim_step();
+	}
+
+	if (wdtOn && sim_time() - wdtClear >= WDT_PERIOD) {
+		fprintf(stderr, "sim: watchdog reset at %u ms\n", sim_time());
+		exit(3);
+	}
+}
+
+
+/* ==========================================================================
+ * Timer and watchdog
+ */
+
+uint robot_ticks ( void )
+{
+	return cntT2Ticks;
+}
+
+uint robot_tickTime ( void )
+{
+	return 0;                                   // Time only moves on ticks
+}
+
+uint robot_tickLeft ( void )
+{
+	return 10000;                               // The whole tick (10 ms)
+}
+
+void robot_wdtEnable ( void )
+{
+	wdtOn    = true;
+	wdtClear = sim_time();
+}
+
+void robot_wdtClear ( void )
+{
+	wdtClear = sim_time();
+}
+
+bool robot_wdtReset ( void )
+{
+	return false;
+}
+
+
+/* ==========================================================================
+ * Sensors
+ */
+
+void robot_readSensors ( void )
+{
+	int i;
+
+	replayEnd();
+
+	if (!rec_replaying()) {
+		for (i = 0; i < 3; i++) {
+			sensors.array[i] = (world_obstAdc(i) + world_obstAdc(i)) / 2;
+		}
+
+		sensors.array[3] = world_batteryAdc();
+		sensors.array[4] = world_ground();
+	}
+
+	rec_sensors(sensors.array);
+}
+
+void robot_readEncoders ( void )
+{
+	int left = 0, right = 0;
+
+	replayEnd();
+
+	if (!rec_replaying()) {
+		world_encoders(&left, &right);
+	}
+
+	sensors.enc_left  = ENC_LEFT_DIR  * left;
+	sensors.enc_right = ENC_RIGHT_DIR * right;
+
+	rec_encoders(&sensors.enc_left, &sensors.enc_right);
+}
+
+uint robot_readBeaconSens ( void )
+{
+	replayEnd();
+
+	return rec_bit(REC_BEACON, rec_replaying() ? 0 : world_beacon());
+}
+
+uint robot_startBtn ( void )
+{
+	replayEnd();
+
+	return rec_bit(REC_START, rec_replaying() ? 0 : world_startBtn());
+}
+
+uint robot_stopBtn ( void )
+{
+	replayEnd();
+
+	return rec_bit(REC_STOP, rec_replaying() ? 0 : world_stopBtn());
+}
+
+
+/* ==========================================================================
+ * Actuators
+ */
+
+void robot_setVel2 ( int velL, int velR )
+{
+	actuators.vel_left  = velL > 100 ? 100 : (velL < -100 ? -100 : velL);
+	actuators.vel_right = velR > 100 ? 100 : (velR < -100 ? -100 : velR);
+}
+
+void robot_setServo ( int pos )
+{
+	pos = pos < SERVO_POS_LEFT ? SERVO_POS_LEFT : pos;
+	pos = pos > SERVO_POS_RIGHT ? SERVO_POS_RIGHT : pos;
+
+	world_setServo(pos);
+
+	actuators.servo_pos = SERVO_POS_RIGHT - pos;   // PWM is minimum @ right position
+}
+
+void robot_setLed ( int ledNr )
+{
+	if (ledNr < 0 || ledNr >= N_LEDS)
+		return;
+
+	actuators.leds |= (1 << ledNr);
+}
+
+void robot_resetLed ( int ledNr )
+{
+	if (ledNr < 0 || ledNr >= N_LEDS)
+		return;
+
+	actuators.leds &= ~(1 << ledNr);
+}
+
+
+/* ==========================================================================
+ * Serial port
+ */
+
+uint robot_serialPut ( uchar c )
+{
+	putchar(c);
+
+	return 1;
+}
+
+uint robot_serialSend ( const uchar* buf, uint len )
+{
+	if (len == 0 || len > SERIAL_BLOCK_MAX)
+		return 0;
+
+	fwrite(buf, 1, len, stdout);                // Sent at once
+
+	return 1;
+}
+
+uint robot_serialBusy ( void )
+{
+	return 0;
+}
+
+
+/* ==========================================================================
+ * Interrupts profiling
+ *
+ * Only the timer 2 ISR runs on the simulation. It is never late and never
+ *  preempted.
+ */
+
+#ifdef ISR_PROF
+
+void robot_isrReset ( void )
+{
+	int i;
+
+	for (i = 0; i < N_ISRS; i++) {
+		isrStats[i].count       = 0;
+		isrStats[i].maxLatency  = 0;
+		isrStats[i].maxDuration = 0;
+		isrStats[i].preemptions = 0;
+		isrStats[i].busy        = 0;
+	}
+
+	isrResetTime = readCoreTimer();
+}
+
+void robot_isrStats ( uint isr, mrIsrStats* stats )
+{
+	if (isr >= N_ISRS || stats == NULL)
+		return;
+
+	(*stats) = isrStats[isr];
+}
+
+uint robot_isrLoad ( void )
+{
+	uint elapsed = readCoreTimer() - isrResetTime;
+
+	return elapsed ? (uint) (isrStats[ISR_T2].busy * 10000 / elapsed) : 0;
+}
+
+uint robot_isrMaxMasked ( void )
+{
+	return 0;
+}
+
+void robot_isrReport ( void )
+{
+	uint load = robot_isrLoad();
+
+	printf("ISR          count  max latency us  max duration us  preemptions\n");
+	printf("%-10s %7u  %11u.%02u  %12u.%02u  %11u\n", "isr_t2", isrStats[ISR_T2].count, 0, 0,
+		isrStats[ISR_T2].maxDuration / 20, (isrStats[ISR_T2].maxDuration % 20) * 5, 0);
+	printf("Interrupt load %u.%02u %%\n", load / 100, load % 100);
+}
+
+#else
+
+void robot_isrReset ( void )
+{
+}
+
+void robot_isrStats ( uint isr, mrIsrStats* stats )
+{
+	static const mrIsrStats none;
+
+	if (stats != NULL) {
+		(*stats) = none;
+	}
+}
+
+uint robot_isrLoad ( void )
+{
+	return 0;
+}
+
+uint robot_isrMaxMasked ( void )
+{
+	return 0;
+}
+
+void robot_isrReport ( void )
+{
+	printf("ISR profiling is disabled (ISR_PROF)\n");
+}
+
+#endif /* ISR_PROF */
+
+
+/* ==========================================================================
+ * DETPIC32 support functions
+ */
+
+unsigned int readCoreTimer ( void )
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (unsigned int) (ts.tv_sec * 20000000ULL + ts.tv_nsec / 50);
+}
+
+void resetCoreTimer ( void )
+{
+}
+
+void putChar ( char c )
+{
+	putchar(c);
+}
+
+void printStr ( const char* str )
+{
+	fputs(str, stdout);
+}
+
+void printInt ( int value, int radix )
+{
+	printf((radix & 0xFFFF) == 16 ? "%x" : "%d", value);
+}
+
+void printInt10 ( int value )
+{
+	printf("%d", value);
+}
+
+
+/* ==========================================================================
+ * Helper functions
+ */
+
+/* ===================
+ * Exit at the end of a replay, the program can't go on without inputs
+ */
+static void replayEnd ( void )
+{
+	uint cycle;
+
+	if (rec_diverged(&cycle)) {
+		fprintf(stderr, "sim: replay diverged on cycle %u\n", cycle);
+		exit(2);
+	}
+
+	if (rec_done()) {
+		fprintf(stderr, "sim: replay finished after %u cycles\n", rec_cycles());
+		exit(0);
+	}
+}
+
+
+/* ==========================================================================
+ * Interrupt Service Routines
+ */
+
+/* ===================
+ * Timer2 (called by the simulation every tick)
+ */
+void isr_t2 ( void )
+{
+#ifdef ISR_PROF
+	uint start = readCoreTimer();
+#endif
+
+	cntT2Ticks++;
+	ticker.ticks |= (cntT2Ticks ^ (cntT2Ticks - 1)) & 0xFF;
+
+	world_setMotors(actuators.vel_left, actuators.vel_right);
+
+#ifdef ISR_PROF
+	start = readCoreTimer() - start;
+
+	isrStats[ISR_T2].count++;
+	isrStats[ISR_T2].busy += start;
+	isrStats[ISR_T2].maxDuration = start > isrStats[ISR_T2].maxDuration ? start : isrStats[ISR_T2].maxDuration;
+#endif
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,55 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  sim/inc/conf.h
+ *  \brief Calibration values of the simulated robot.
+ *
+ *  The simulated robot is just another robot, so it has its own
+ *   calibration values. This header includes the library inc/conf.h and
+ *   overrides the values describing the robot physics.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __SIM_CONF_H__
+#define __SIM_CONF_H__
+
+
+#include_next <conf.h>
+
+
+/* ==========================================================================
+ * Servo calibration values
+ */
+
+#undef  SERVO_MAX_SPEED
+#define SERVO_MAX_SPEED 300
+
+#undef  SERVO_SETTLE_T
+#define SERVO_SETTLE_T   30
+
+
+/* ==========================================================================
+ * Wheels and encoders calibration
+ */
+
+#undef  ENC_TPR
+#define ENC_TPR       480
+
+#undef  ENC_LEFT_DIR
+#define ENC_LEFT_DIR    1
+
+#undef  WHEEL_CIRC
+#define WHEEL_CIRC    126
+
+#undef  WHEEL_BASE
+#define WHEEL_BASE    100
+
+
+/* ========================================================================== */
+#endif /* __SIM_CONF_H__ */
@@ -0,0 +1,55 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  sim/inc/detpic32.h
+ *  \brief Host replacement for the DETPIC32 board support header.
+ *
+ *  Provides the subset of the DETPIC32 API used by libmr and by the test
+ *   applications, so they can be built against the host simulation.
+ *
+ *  The core timer runs at the same 20 MHz of the board, but is based on the
+ *   host monotonic clock.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __DETPIC32_H__
+#define __DETPIC32_H__
+
+
+#include <stdio.h>
+
+
+/* ==========================================================================
+ * Interrupts
+ */
+
+#define EnableInterrupts()
+#define DisableInterrupts()
+
+
+/* ==========================================================================
+ * Core timer
+ */
+
+unsigned int readCoreTimer  ( void );
+void         resetCoreTimer ( void );
+
+
+/* ==========================================================================
+ * Serial port
+ */
+
+void putChar  ( char c );
+void printStr ( const char* str );
+void printInt ( int value, int radix );
+void printInt10 ( int value );
+
+
+/* ========================================================================== */
+#endif /* __DETPIC32_H__ */
@@ -0,0 +1,262 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  sim/inc/sim.h
+ *  \brief Host simulation of a Micro Rato robot.
+ *
+ *  The simulation implements the robot library (inc/hal/robot.h) on a Linux
+ *   host, so the sensors and actuators modules, and the applications built
+ *   on top of them, can run without the robot.
+ *
+ *  It simulates:
+ *   - A differential drive robot, with a first order model of each motor
+ *     (including dead band and gain asymmetries) and the encoders;
+ *   - The three obstacle sensors against the arena walls;
+ *   - The ground sensors against the ground markings;
+ *   - The beacon sensor, rotated by a servo with limited speed;
+ *   - The battery and the buttons.
+ *
+ *  The simulated time only advances when the application waits for the next
+ *   tick (see robot_idle()), so the simulation runs as fast as the host
+ *   allows, unless a speed factor is set.
+ *
+ *  When the robot is initialized (robot_init()) the simulation is
+ *   configured from the following environment variables, if not configured
+ *   before with the functions of this module:
+ *   - MR_SIM_ARENA: Arena description file (see sim_loadArena());
+ *   - MR_SIM_SPEED: Speed factor relative to real time (0, the default,
+ *     runs as fast as possible);
+ *   - MR_SIM_TIME:  Simulated seconds after which the program exits;
+ *   - MR_SIM_SEED:  Seed for the sensors noise;
+ *   - MR_SIM_TRACE: File where the robot pose is written every tick;
+ *   - MR_SIM_RECORD: If set, the robot inputs are recorded (see
+ *     inc/util/rec.h) and sent with the log to stdout;
+ *   - MR_SIM_REPLAY: Journal file replayed instead of simulating the
+ *     world. The program exits at the end of the journal, or with status 2
+ *     if it diverges;
+ *   - MR_SIM_PROF_TRACE: File where the profiled regions (see
+ *     inc/util/prof.h) are written as Chrome trace events.
+ *
+ *  The watchdog (robot_wdtEnable()) expires after 1024 ms of simulated time
+ *   without being cleared, and the program exits with status 3.
+ *
+ *  The simulation state, as the robot library state, is thread local: each
+ *   thread simulates its own robot. Several robots can run concurrently in
+ *   one process, one per thread, as long as each one uses its own instances
+ *   of the middleware modules (see the _r functions).
+ *
+ *  All distances are in millimeters and all angles in degrees
+ *   (anticlockwise, 0 degrees is the X axis).
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __SIM_H__
+#define __SIM_H__
+
+
+#include <base.h>
+
+
+/* ==========================================================================
+ * Arena
+ */
+
+#define SIM_MAX_WALLS 64
+#define SIM_MAX_MARKS 16
+
+typedef struct {
+	int x1, y1;
+	int x2, y2;
+} simWall;
+
+/**
+ *  \brief A ground marking. A circle if r > 0, a strip otherwise.
+ */
+typedef struct {
+	int x1, y1;
+	int x2, y2;
+	int r;                         ///< Circle radius
+	int w;                         ///< Strip width
+} simMark;
+
+typedef struct {
+	int     width;
+	int     height;
+
+	int     nWalls;
+	simWall walls[SIM_MAX_WALLS];
+
+	int     nMarks;
+	simMark marks[SIM_MAX_MARKS];
+
+	int     beaconX;
+	int     beaconY;
+	int     beaconRange;           ///< Beacon range, 0 for the model one
+
+	int     startX;
+	int     startY;
+	int     startHeading;
+} simArena;
+
+
+/* ==========================================================================
+ * Robot model
+ */
+
+/**
+ *  \brief Physical parameters of the simulated robot.
+ *
+ *  The wheels, encoders and servo geometry are the ones in conf.h.
+ */
+typedef struct {
+	int radius;                    ///< Robot radius (for collisions)
+	int maxSpeed;                  ///< Wheel speed at 100% (mm/s)
+	int gainLeft;                  ///< Left motor gain (% of maxSpeed)
+	int gainRight;                 ///< Right motor gain (% of maxSpeed)
+	int deadBand;                  ///< Command below which wheels don't move (%)
+	int tau;                       ///< Motors time constant (ms)
+
+	int obstK;                     ///< Obstacle sensors ADC = K / (cm + 1)
+	int obstRange;                 ///< Obstacle sensors range
+	int obstOffset;                ///< Obstacle sensors distance to the center
+	int obstAngle;                 ///< Angle of the left/right sensors
+	int obstNoise;                 ///< Obstacle sensors noise (ADC units)
+
+	int groundOffset;              ///< Ground sensors distance to the center
+	int groundSpacing;             ///< Distance between ground sensors
+
+	int beaconHalfWidth;           ///< Beacon beam half width
+	int beaconRange;               ///< Beacon maximum range
+	int servoSpeed;                ///< Servo real speed (degrees/s)
+
+	int battery;                   ///< Battery voltage (x10)
+} simModel;
+
+
+/* ==========================================================================
+ * Configuration
+ */
+
+/**
+ *  \brief Fill an arena with the default description.
+ *
+ *  The default arena is 3 x 2 m, with a couple of obstacles, a target area
+ *   below the beacon and the start position in the opposite corner.
+ */
+void sim_defaultArena ( simArena* arena );
+
+/**
+ *  \brief Load an arena description from a file.
+ *
+ *  The file has one element per line (lines starting with # are comments):
+ *   - size W H: arena size (adds the four surrounding walls);
+ *   - wall X1 Y1 X2 Y2: a wall segment;
+ *   - mark X Y R: a circular ground marking;
+ *   - line X1 Y1 X2 Y2 W: a ground strip of width W;
+ *   - beacon X Y [RANGE]: beacon position, and range when it's shorter
+ *     than the model one;
+ *   - start X Y HEADING: robot start pose.
+ *
+ *  \returns True if the file was loaded and false otherwise.
+ */
+bool sim_loadArena    ( simArena* arena, const char* path );
+
+/**
+ *  \brief Fill a robot model with the default parameters.
+ */
+void sim_defaultModel ( simModel* model );
+
+/**
+ *  \brief Configure the simulation.
+ *
+ *  Resets the simulated time and puts the robot at the arena start pose.
+ *
+ *  \param arena The arena, or NULL to use the default one.
+ *  \param model The robot model, or NULL to use the default one.
+ *  \param seed  Seed for the sensors noise.
+ */
+void sim_setup        ( const simArena* arena, const simModel* model, uint seed );
+
+/**
+ *  \brief Set the simulation speed relative to real time.
+ *
+ *  \param factor Speed factor, or 0 to run as fast as possible.
+ */
+void sim_setSpeed     ( int factor );
+
+
+/* ==========================================================================
+ * Execution
+ */
+
+/**
+ *  \brief Advance the simulation by one tick (10 ms).
+ *
+ *  This is done automatically by robot_idle(), so it is only needed by
+ *   tools driving the simulation directly.
+ */
+void sim_step         ( void );
+
+/**
+ *  \brief Provides the simulated time in milliseconds.
+ */
+uint sim_time         ( void );
+
+
+/* ==========================================================================
+ * Ground truth
+ */
+
+/**
+ *  \brief Provides the real pose of the robot.
+ *
+ *  Any argument can be NULL if you're not interested in the value.
+ */
+void sim_pose         ( int* x, int* y, int* heading );
+
+/**
+ *  \brief Provides the number of collisions with walls so far.
+ */
+uint sim_collisions   ( void );
+
+/**
+ *  \brief Provides the real distance from the robot center to the beacon.
+ */
+int  sim_beaconDist   ( void );
+
+
+/* ==========================================================================
+ * Replay
+ */
+
+/**
+ *  \brief Load a journal (see inc/util/rec.h) and start replaying it.
+ *
+ *  The journal is kept in memory until the next call.
+ *
+ *  \returns True if the file was loaded and false otherwise.
+ */
+bool sim_replay       ( const char* path );
+
+
+/* ==========================================================================
+ * Profiling
+ */
+
+/**
+ *  \brief Write a run of a profiled region to the trace file, if any.
+ *
+ *  \param start Core timer count at the beginning of the run.
+ *  \param end   Core timer count at the end of the run.
+ */
+void sim_traceEvent   ( const char* name, uint start, uint end );
+
+
+/* ========================================================================== */
+#endif /* __SIM_H__ */
@@ -0,0 +1,219 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  sim/replay.c
+ *  \brief Replay a recorded journal through the sensors and actuators
+ *   modules.
+ *
+ *  The journal (see inc/util/rec.h) is replayed with the usual main loop,
+ *   the application being replaced by the recorded velocities:
+ *
+ *  \code
+ *  mouse_waitStep10ms();
+ *  sensors_update();
+ *  actuators_setVel(...);       // Recorded values
+ *  actuators_update();
+ *  \endcode
+ *
+ *  The modules start with the library defaults. Button reads are skipped,
+ *   and runs that use the beacon sweep or tracking must be replayed with
+ *   the application itself (MR_SIM_REPLAY, see sim/inc/sim.h).
+ *
+ *    usage: replay [-n times] [-o] journal
+ *
+ *  Prints the number of cycles, where the replay diverged (if it did) and
+ *   a checksum of the motor and servo outputs, which can be compared
+ *   between two versions of the library. -o prints the outputs of every
+ *   cycle as CSV instead. -n replays the journal several times and prints
+ *   the time spent on each module per cycle.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+/* System headers go first, base.h defines an abs() macro */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <base.h>
+#include <sim.h>
+#include <hal/robot.h>
+#include <mouse/mouse.h>
+#include <mouse/state.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <util/rec.h>
+
+
+/* ========================================================================== */
+
+static bool  printOutputs = false;
+
+static uint  hash;                          // FNV-1a of the outputs
+static ulong nsSensors;
+static ulong nsActuators;
+
+
+/* ========================================================================== */
+
+static ulong nsNow ( void )
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+static void output ( uint cycle )
+{
+	int  values[3];
+	uint i, b;
+
+	values[0] = actuators.vel_left;
+	values[1] = actuators.vel_right;
+	values[2] = actuators.servo_pos;
+
+	for (i = 0; i < 3; i++) {
+		for (b = 0; b < 4; b++) {
+			hash = (hash ^ ((values[i] >> (8 * b)) & 0xFF)) * 16777619u;
+		}
+	}
+
+	if (printOutputs) {
+		printf("%u,%d,%d,%d\n", cycle, values[0], values[1], values[2]);
+	}
+}
+
+static void replay ( void )
+{
+	bool  pending = false;                  // actuators_update() still due
+	ulong t;
+
+	state_init_r(state_default());
+	mouse_init();
+	sensors_init();
+	actuators_init();
+
+	hash = 2166136261u;
+
+	while (!rec_diverged(NULL)) {
+		switch (rec_next()) {
+		case REC_END:
+			if (pending) {
+				t = nsNow();
+				actuators_update();
+				nsActuators += nsNow() - t;
+				output(rec_cycles());
+			}
+			return;
+
+		case REC_CYCLE:
+			if (pending) {
+				t = nsNow();
+				actuators_update();
+				nsActuators += nsNow() - t;
+				output(rec_cycles());
+			}
+
+			mouse_waitStep10ms();
+			pending = true;
+			break;
+
+		case REC_SENSORS:
+			t = nsNow();
+			sensors_update();
+			nsSensors += nsNow() - t;
+			break;
+
+		case REC_VEL:
+			actuators_setVel(0, 0);         // Replaced by the recorded values
+			break;
+
+		case REC_START:
+			robot_startBtn();
+			break;
+
+		case REC_STOP:
+			robot_stopBtn();
+			break;
+
+		default:                            // Read by the application
+			robot_readBeaconSens();
+			break;
+		}
+	}
+}
+
+
+/* ========================================================================== */
+
+int main ( int argc, char** argv )
+{
+	uint  times = 1;
+	uint  cycle, i;
+	ulong start, total;
+	int   opt;
+
+	while ((opt = getopt(argc, argv, "n:o")) != -1) {
+		switch (opt) {
+		case 'n':
+			times = strtoul(optarg, NULL, 0);
+			times = times ? times : 1;
+			break;
+		case 'o':
+			printOutputs = true;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-n times] [-o] journal\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind >= argc) {
+		fprintf(stderr, "usage: %s [-n times] [-o] journal\n", argv[0]);
+		return 1;
+	}
+
+	if (printOutputs) {
+		printf("cycle,vel_l,vel_r,servo\n");
+	}
+
+	start = nsNow();
+
+	for (i = 0; i < times; i++) {
+		if (!sim_replay(argv[optind])) {
+			fprintf(stderr, "replay: can't load journal %s\n", argv[optind]);
+			return 1;
+		}
+
+		replay();
+
+		printOutputs = false;               // Only once
+	}
+
+	total = nsNow() - start;
+
+	if (rec_diverged(&cycle)) {
+		fprintf(stderr, "replay: diverged on cycle %u\n", cycle);
+	}
+
+	fprintf(stderr, "replay: %u cycles, outputs checksum %08x\n", rec_cycles(), hash);
+
+	if (times > 1 && rec_cycles() > 0) {
+		fprintf(stderr, "replay: %u times, %.0f cycles/s, sensors %lu ns/cycle, actuators %lu ns/cycle\n",
+			times, (double) times * rec_cycles() * 1e9 / total,
+			nsSensors / ((ulong) times * rec_cycles()), nsActuators / ((ulong) times * rec_cycles()));
+	}
+
+	return rec_diverged(NULL) ? 2 : 0;
+}
+
+
+/* = EOF ==================================================================== */
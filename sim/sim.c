@@ -0,0 +1,727 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  sim/sim.c
+ *  \brief Implement the simulated world.
+ *
+ *  Physics run in floating point, this is host only code.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+/* System headers go first, base.h defines an abs() macro */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <base.h>
+#include <sim.h>
+#include <conf.h>
+#include <hal/robot.h>
+#include <util/rec.h>
+
+#include "world.h"
+
+
+/* ========================================================================== */
+
+#define TICK_MS    10
+#define DEG2RAD(a) ((a) * M_PI / 180.0)
+#define RAD2DEG(a) ((a) * 180.0 / M_PI)
+
+/**
+ *  \brief Time (in ms) the start button is kept pressed after the start.
+ */
+#define START_BTN_T 200
+
+
+/* ========================================================================== */
+
+static MR_TLS bool     configured = false;
+
+static MR_TLS simArena arena;
+static MR_TLS simModel model;
+
+static MR_TLS uint     simTime    = 0;      // ms
+static MR_TLS int      speed      = 0;
+static MR_TLS uint     timeLimit  = 0;      // ms, 0 is unlimited
+static MR_TLS FILE*    trace      = NULL;
+static MR_TLS struct timespec wallStart;
+
+static MR_TLS uint     rng        = 1;
+
+/* ===================
+ * Robot state
+ */
+static MR_TLS double   posX       = 0.0;
+static MR_TLS double   posY       = 0.0;
+static MR_TLS double   heading    = 0.0;    // rad
+
+static MR_TLS int      cmdLeft    = 0;
+static MR_TLS int      cmdRight   = 0;
+static MR_TLS double   velLeft    = 0.0;    // mm/s
+static MR_TLS double   velRight   = 0.0;
+static MR_TLS double   encLeft    = 0.0;    // ticks (fractional)
+static MR_TLS double   encRight   = 0.0;
+
+static MR_TLS double   servoAngle  = 0.0;   // degrees, clockwise
+static MR_TLS double   servoTarget = 0.0;
+
+static MR_TLS bool     colliding  = false;
+static MR_TLS uint     collisions = 0;
+
+/* ===================
+ * Replay
+ */
+static MR_TLS uchar*   journal    = NULL;
+
+/* ===================
+ * Profiling
+ */
+static MR_TLS FILE*    profTrace  = NULL;
+static MR_TLS long long profTime  = 0;    // Core timer counts, without wraps
+static MR_TLS uint     profLast   = 0;
+static MR_TLS uint     profEvents = 0;
+
+
+/* ========================================================================== */
+
+static void   physicsStep ( void );
+static bool   collides    ( double x, double y );
+static double rayCast     ( double x, double y, double angle, double range );
+static double segDist     ( double px, double py, double x1, double y1, double x2, double y2 );
+static void   addWall     ( simArena* a, int x1, int y1, int x2, int y2 );
+static int    noise       ( int amplitude );
+static void   throttle    ( void );
+static void   traceClose  ( void );
+
+
+/* ==========================================================================
+ * Configuration
+ */
+
+void sim_defaultArena ( simArena* a )
+{
+	memset(a, 0, sizeof(*a));
+
+	a->width  = 3000;
+	a->height = 2000;
+
+	addWall(a, 0,    0,    3000, 0);
+	addWall(a, 3000, 0,    3000, 2000);
+	addWall(a, 3000, 2000, 0,    2000);
+	addWall(a, 0,    2000, 0,    0);
+
+	addWall(a, 1000, 0,    1000, 1200);
+	addWall(a, 2000, 2000, 2000, 800);
+	addWall(a, 1400, 900,  1600, 900);
+
+	a->marks[0].x1 = 2600;
+	a->marks[0].y1 = 400;
+	a->marks[0].r  = 250;
+	a->nMarks      = 1;
+
+	a->beaconX = 2600;
+	a->beaconY = 400;
+
+	a->startX       = 300;
+	a->startY       = 300;
+	a->startHeading = 90;
+}
+
+bool sim_loadArena ( simArena* a, const char* path )
+{
+	FILE* f;
+	char  line[128];
+	char  key[16];
+	int   v[5];
+	int   n;
+
+	if ((f = fopen(path, "r")) == NULL)
+		return false;
+
+	memset(a, 0, sizeof(*a));
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (line[0] == '#')
+			continue;
+
+		n = sscanf(line, "%15s %d %d %d %d %d", key, v, v + 1, v + 2, v + 3, v + 4);
+
+		if (n <= 0)
+			continue;
+
+		if (!strcmp(key, "size") && n == 3) {
+			a->width  = v[0];
+			a->height = v[1];
+			addWall(a, 0,    0,    v[0], 0);
+			addWall(a, v[0], 0,    v[0], v[1]);
+			addWall(a, v[0], v[1], 0,    v[1]);
+			addWall(a, 0,    v[1], 0,    0);
+		} else if (!strcmp(key, "wall") && n == 5) {
+			addWall(a, v[0], v[1], v[2], v[3]);
+		} else if (!strcmp(key, "mark") && n == 4 && a->nMarks < SIM_MAX_MARKS) {
+			a->marks[a->nMarks].x1 = v[0];
+			a->marks[a->nMarks].y1 = v[1];
+			a->marks[a->nMarks].r  = v[2];
+			a->nMarks++;
+		} else if (!strcmp(key, "line") && n == 6 && a->nMarks < SIM_MAX_MARKS) {
+			a->marks[a->nMarks].x1 = v[0];
+			a->marks[a->nMarks].y1 = v[1];
+			a->marks[a->nMarks].x2 = v[2];
+			a->marks[a->nMarks].y2 = v[3];
+			a->marks[a->nMarks].w  = v[4];
+			a->nMarks++;
+		} else if (!strcmp(key, "beacon") && (n == 3 || n == 4)) {
+			a->beaconX     = v[0];
+			a->beaconY     = v[1];
+			a->beaconRange = n == 4 ? v[2] : 0;
+		} else if (!strcmp(key, "start") && n == 4) {
+			a->startX       = v[0];
+			a->startY       = v[1];
+			a->startHeading = v[2];
+		} else {
+			fprintf(stderr, "sim: %s: invalid line: %s", path, line);
+			fclose(f);
+			return false;
+		}
+	}
+
+	fclose(f);
+
+	return true;
+}
+
+void sim_defaultModel ( simModel* m )
+{
+	m->radius    = 80;
+	m->maxSpeed  = 600;
+	m->gainLeft  = 100;
+	m->gainRight = 96;
+	m->deadBand  = 8;
+	m->tau       = 60;
+
+	m->obstK      = 6000;
+	m->obstRange  = 800;
+	m->obstOffset = 60;
+	m->obstAngle  = 45;
+	m->obstNoise  = 3;
+
+	m->groundOffset  = 70;
+	m->groundSpacing = 15;
+
+	m->beaconHalfWidth = 9;
+	m->beaconRange     = 4000;
+	m->servoSpeed      = 300;
+
+	m->battery = 96;
+}
+
+void sim_setup ( const simArena* a, const simModel* m, uint seed )
+{
+	if (a != NULL) {
+		arena = (*a);
+	} else {
+		sim_defaultArena(&arena);
+	}
+
+	if (m != NULL) {
+		model = (*m);
+	} else {
+		sim_defaultModel(&model);
+	}
+
+	rng = seed ? seed : 1;
+
+	simTime = 0;
+
+	posX    = arena.startX;
+	posY    = arena.startY;
+	heading = DEG2RAD(arena.startHeading);
+
+	cmdLeft  = cmdRight = 0;
+	velLeft  = velRight = 0.0;
+	encLeft  = encRight = 0.0;
+
+	servoAngle  = 0.0;
+	servoTarget = 0.0;
+
+	colliding  = false;
+	collisions = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &wallStart);
+
+	configured = true;
+}
+
+void sim_setSpeed ( int factor )
+{
+	speed = factor < 0 ? 0 : factor;
+	clock_gettime(CLOCK_MONOTONIC, &wallStart);
+}
+
+
+/* ==========================================================================
+ * Execution
+ */
+
+void sim_step ( void )
+{
+	physicsStep();
+
+	simTime += TICK_MS;
+
+	isr_t2();
+
+	if (trace != NULL) {
+		fprintf(trace, "%u %.1f %.1f %.2f\n", simTime, posX, posY, RAD2DEG(heading));
+	}
+
+	if (timeLimit && simTime >= timeLimit) {
+		if (trace != NULL)
+			fclose(trace);
+
+		fprintf(stderr, "sim: %u ms simulated, %u collisions\n", simTime, collisions);
+		exit(0);
+	}
+
+	if (speed) {
+		throttle();
+	}
+}
+
+uint sim_time ( void )
+{
+	return simTime;
+}
+
+
+/* ==========================================================================
+ * Ground truth
+ */
+
+void sim_pose ( int* x, int* y, int* h )
+{
+	if (x != NULL) {
+		(*x) = (int) lround(posX);
+	}
+
+	if (y != NULL) {
+		(*y) = (int) lround(posY);
+	}
+
+	if (h != NULL) {
+		(*h) = (int) lround(RAD2DEG(atan2(sin(heading), cos(heading))));
+	}
+}
+
+uint sim_collisions ( void )
+{
+	return collisions;
+}
+
+int sim_beaconDist ( void )
+{
+	return (int) lround(hypot(arena.beaconX - posX, arena.beaconY - posY));
+}
+
+
+/* ==========================================================================
+ * Replay
+ */
+
+bool sim_replay ( const char* path )
+{
+	FILE* f;
+	long  len;
+
+	if ((f = fopen(path, "rb")) == NULL)
+		return false;
+
+	fseek(f, 0, SEEK_END);
+	len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	rec_stop();
+	free(journal);
+	journal = NULL;
+
+	if (len <= 0 || (journal = malloc(len)) == NULL || fread(journal, 1, len, f) != (size_t) len) {
+		fclose(f);
+		return false;
+	}
+
+	fclose(f);
+
+	rec_replay(journal, len);
+
+	return true;
+}
+
+
+/* ==========================================================================
+ * Profiling
+ */
+
+void sim_traceEvent ( const char* name, uint start, uint end )
+{
+	if (profTrace == NULL)
+		return;
+
+	if (profEvents == 0) {
+		profLast = start;                       // Trace starts at 0
+	}
+
+	/* Runs are written when they end, so nested regions come before the
+	 *  region they are in, and start earlier than the previous event.
+	 */
+	profTime += (int) (start - profLast);
+	profLast  = start;
+
+	fprintf(profTrace, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.2f,\"dur\":%.2f}",
+		profEvents++ ? ",\n" : "", name, profTime / 20.0, (end - start) / 20.0);
+}
+
+
+/* ==========================================================================
+ * World interface (used by the simulated robot library)
+ */
+
+void world_init ( void )
+{
+	simArena    a;
+	const char* env;
+
+	if (configured)
+		return;
+
+	if ((env = getenv("MR_SIM_ARENA")) != NULL) {
+		if (!sim_loadArena(&a, env)) {
+			fprintf(stderr, "sim: can't load arena %s\n", env);
+			exit(1);
+		}
+
+		sim_setup(&a, NULL, 1);
+	} else {
+		sim_setup(NULL, NULL, 1);
+	}
+
+	if ((env = getenv("MR_SIM_SEED")) != NULL) {
+		rng = strtoul(env, NULL, 0);
+		rng = rng ? rng : 1;
+	}
+
+	if ((env = getenv("MR_SIM_SPEED")) != NULL) {
+		sim_setSpeed(atoi(env));
+	}
+
+	if ((env = getenv("MR_SIM_TIME")) != NULL) {
+		timeLimit = (uint) (atof(env) * 1000);
+	}
+
+	if ((env = getenv("MR_SIM_TRACE")) != NULL) {
+		trace = fopen(env, "w");
+	}
+
+	if ((env = getenv("MR_SIM_PROF_TRACE")) != NULL && (profTrace = fopen(env, "w")) != NULL) {
+		fprintf(profTrace, "[\n");
+		atexit(traceClose);
+	}
+
+	if (getenv("MR_SIM_RECORD") != NULL) {
+		rec_record();
+	}
+
+	if ((env = getenv("MR_SIM_REPLAY")) != NULL && !sim_replay(env)) {
+		fprintf(stderr, "sim: can't load journal %s\n", env);
+		exit(1);
+	}
+}
+
+void world_setMotors ( int left, int right )
+{
+	cmdLeft  = left;
+	cmdRight = right;
+}
+
+void world_setServo ( int pos )
+{
+	servoTarget = (double) pos * (SERVO_DEGREE_MAX - SERVO_DEGREE_MIN)
+	                           / (SERVO_POS_RIGHT - SERVO_POS_LEFT);
+}
+
+void world_encoders ( int* left, int* right )
+{
+	(*left)   = (int) encLeft;
+	(*right)  = (int) encRight;
+
+	encLeft  -= (*left);
+	encRight -= (*right);
+}
+
+int world_obstAdc ( int sensor )
+{
+	static const int dir[3] = {-1, 0, 1};    // right, front, left
+
+	double a;
+	double d;
+	int    adc;
+
+	a = heading + DEG2RAD(dir[sensor] * model.obstAngle);
+	d = rayCast(posX + model.obstOffset * cos(a), posY + model.obstOffset * sin(a),
+	            a, model.obstRange);
+
+	adc = (int) (model.obstK / (d / 10.0 + 1.0)) + noise(model.obstNoise);
+
+	return adc < 0 ? 0 : (adc > 1023 ? 1023 : adc);
+}
+
+int world_batteryAdc ( void )
+{
+	/* Inverse of the conversion in sensors.c */
+	return (model.battery * 33000 / 10100) * 1023 / 330;
+}
+
+uint world_ground ( void )
+{
+	uint   bitmap = 0;
+	double sx, sy;
+	double lat;
+	int    i, j;
+
+	for (i = 0; i < 5; i++) {
+		lat = (i - 2) * model.groundSpacing;       // bit 0 is the right most
+
+		sx = posX + model.groundOffset * cos(heading) - lat * sin(heading);
+		sy = posY + model.groundOffset * sin(heading) + lat * cos(heading);
+
+		for (j = 0; j < arena.nMarks; j++) {
+			const simMark* m = arena.marks + j;
+
+			if (m->r > 0) {
+				if (hypot(sx - m->x1, sy - m->y1) <= m->r)
+					bitmap |= (1 << i);
+			} else {
+				if (segDist(sx, sy, m->x1, m->y1, m->x2, m->y2) <= m->w / 2.0)
+					bitmap |= (1 << i);
+			}
+		}
+	}
+
+	return bitmap;
+}
+
+bool world_beacon ( void )
+{
+	double bearing;
+	double dir;
+	double diff;
+	int    range = arena.beaconRange ? arena.beaconRange : model.beaconRange;
+
+	if (hypot(arena.beaconX - posX, arena.beaconY - posY) > range)
+		return false;
+
+	/* The beacon is above the walls, so it is never occluded */
+	bearing = atan2(arena.beaconY - posY, arena.beaconX - posX);
+	dir     = heading - DEG2RAD(servoAngle);
+	diff    = RAD2DEG(atan2(sin(bearing - dir), cos(bearing - dir)));
+
+	return fabs(diff) <= model.beaconHalfWidth;
+}
+
+bool world_startBtn ( void )
+{
+	return simTime < START_BTN_T;
+}
+
+bool world_stopBtn ( void )
+{
+	return false;
+}
+
+
+/* ========================================================================== */
+
+static void physicsStep ( void )
+{
+	const double dt = TICK_MS / 1000.0;
+
+	double alpha;
+	double target;
+	double dl, dr;
+	double v, w;
+	double nx, ny;
+	double step;
+
+	alpha = dt / (model.tau / 1000.0);
+	alpha = alpha > 1.0 ? 1.0 : alpha;
+
+	target   = abs(cmdLeft) < model.deadBand ? 0.0
+	         : cmdLeft / 100.0 * model.maxSpeed * model.gainLeft / 100.0;
+	velLeft += (target - velLeft) * alpha;
+
+	target    = abs(cmdRight) < model.deadBand ? 0.0
+	          : cmdRight / 100.0 * model.maxSpeed * model.gainRight / 100.0;
+	velRight += (target - velRight) * alpha;
+
+	dl = velLeft  * dt;
+	dr = velRight * dt;
+
+	v = (dl + dr) / 2.0;
+	w = (dr - dl) / WHEEL_BASE;
+
+	nx = posX + v * cos(heading + w / 2.0);
+	ny = posY + v * sin(heading + w / 2.0);
+
+	if (collides(nx, ny)) {
+		/* Against a wall the wheels stall */
+		if (!colliding)
+			collisions++;
+
+		colliding = true;
+		velLeft   = 0.0;
+		velRight  = 0.0;
+	} else {
+		colliding = false;
+		posX      = nx;
+		posY      = ny;
+		heading  += w;
+
+		encLeft  += dl * ENC_TPR / WHEEL_CIRC;
+		encRight += dr * ENC_TPR / WHEEL_CIRC;
+	}
+
+	/* Servo */
+	step = model.servoSpeed * dt;
+
+	if (servoAngle < servoTarget - step) {
+		servoAngle += step;
+	} else if (servoAngle > servoTarget + step) {
+		servoAngle -= step;
+	} else {
+		servoAngle = servoTarget;
+	}
+}
+
+static bool collides ( double x, double y )
+{
+	int i;
+
+	for (i = 0; i < arena.nWalls; i++) {
+		const simWall* wl = arena.walls + i;
+
+		if (segDist(x, y, wl->x1, wl->y1, wl->x2, wl->y2) < model.radius)
+			return true;
+	}
+
+	return false;
+}
+
+static double rayCast ( double x, double y, double angle, double range )
+{
+	double dx = cos(angle);
+	double dy = sin(angle);
+	double best = range;
+	double ex, ey, den, t, u;
+	int    i;
+
+	for (i = 0; i < arena.nWalls; i++) {
+		const simWall* wl = arena.walls + i;
+
+		ex  = wl->x2 - wl->x1;
+		ey  = wl->y2 - wl->y1;
+		den = dx * ey - dy * ex;
+
+		if (fabs(den) < 1e-9)
+			continue;
+
+		t = ((wl->x1 - x) * ey - (wl->y1 - y) * ex) / den;     // along the ray
+		u = ((wl->x1 - x) * dy - (wl->y1 - y) * dx) / den;     // along the wall
+
+		if (t >= 0.0 && t < best && u >= 0.0 && u <= 1.0)
+			best = t;
+	}
+
+	return best;
+}
+
+static double segDist ( double px, double py, double x1, double y1, double x2, double y2 )
+{
+	double ex = x2 - x1;
+	double ey = y2 - y1;
+	double l2 = ex * ex + ey * ey;
+	double t;
+
+	t = l2 > 0.0 ? ((px - x1) * ex + (py - y1) * ey) / l2 : 0.0;
+	t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+
+	return hypot(px - (x1 + t * ex), py - (y1 + t * ey));
+}
+
+static void addWall ( simArena* a, int x1, int y1, int x2, int y2 )
+{
+	if (a->nWalls >= SIM_MAX_WALLS)
+		return;
+
+	a->walls[a->nWalls].x1 = x1;
+	a->walls[a->nWalls].y1 = y1;
+	a->walls[a->nWalls].x2 = x2;
+	a->walls[a->nWalls].y2 = y2;
+	a->nWalls++;
+}
+
+/* ===================
+ * Uniform noise in [-amplitude, amplitude] (xorshift32).
+ */
+static int noise ( int amplitude )
+{
+	if (amplitude <= 0)
+		return 0;
+
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return (int) (rng % (2 * amplitude + 1)) - amplitude;
+}
+
+/* ===================
+ * Sleep until the wall clock catches up with the simulated time.
+ */
+static void throttle ( void )
+{
+	struct timespec now;
+	struct timespec ts;
+	long long ahead;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	ahead = (long long) simTime * 1000000 / speed
+	      - ((now.tv_sec - wallStart.tv_sec) * 1000000000LL + (now.tv_nsec - wallStart.tv_nsec));
+
+	if (ahead > 0) {
+		ts.tv_sec  = ahead / 1000000000LL;
+		ts.tv_nsec = ahead % 1000000000LL;
+		nanosleep(&ts, NULL);
+	}
+}
+
+
+/* ===================
+ * Close the profiling trace at exit
+ */
+static void traceClose ( void )
+{
+	fprintf(profTrace, "\n]\n");
+	fclose(profTrace);
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,81 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  sim/world.h
+ *  \brief Interface between the simulated world and the simulated robot
+ *         library.
+ *
+ *  This is internal to the simulation: sim/hal/robot.c uses these functions
+ *   to implement the robot library on top of the simulated world.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#ifndef __SIM_WORLD_H__
+#define __SIM_WORLD_H__
+
+
+#include <base.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Configure the simulation from the environment, unless it was
+ *   already configured with sim_setup().
+ */
+void world_init       ( void );
+
+/**
+ *  \brief Set the motors command (in %, negative is backwards).
+ */
+void world_setMotors  ( int left, int right );
+
+/**
+ *  \brief Set the servo target position (SERVO_POS_LEFT to SERVO_POS_RIGHT).
+ */
+void world_setServo   ( int pos );
+
+/**
+ *  \brief Read and reset the encoders counters.
+ */
+void world_encoders   ( int* left, int* right );
+
+/**
+ *  \brief Obstacle sensor ADC value (0 right, 1 front, 2 left).
+ */
+int  world_obstAdc    ( int sensor );
+
+/**
+ *  \brief Battery ADC value.
+ */
+int  world_batteryAdc ( void );
+
+/**
+ *  \brief Ground sensors bitmap (bit 0 is the right most sensor).
+ */
+uint world_ground     ( void );
+
+/**
+ *  \brief Beacon sensor output.
+ */
+bool world_beacon     ( void );
+
+bool world_startBtn   ( void );
+bool world_stopBtn    ( void );
+
+/**
+ *  \brief Timer 2 interrupt, implemented by the simulated robot library.
+ *
+ *  Called by sim_step() at every tick.
+ */
+void isr_t2           ( void );
+
+
+/* ========================================================================== */
+#endif /* __SIM_WORLD_H__ */
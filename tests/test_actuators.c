@@ -29,7 +29,7 @@ int main ( void )
 	actuators_init();
 
 	while (1) {
-		waitStep10ms();
+		mouse_waitStep10ms();
 
 		actuators_update();
 	}
@@ -0,0 +1,93 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tests/test_avoid.c
+ *  \brief Tests for the obstacle avoidance module.
+ *
+ *  Goes through a list of waypoints steering only with the obstacle
+ *   avoidance, towards the direction of the next waypoint. On
+ *   sim/arenas/maze.arena the first and the last legs have a wall across
+ *   the straight line. Every second prints the position, the avoidance
+ *   state and the directions of the goal and of the one taken.
+ *
+ *    MR_SIM_ARENA=sim/arenas/maze.arena MR_SIM_TIME=120 sim/test_avoid
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/mouse.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <mouse/avoid.h>
+#include <util/trig.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Waypoints, in mm from the start (maze.arena starts at (400, 400)
+ *   facing +y).
+ */
+#define WAYPOINTS  5
+
+static const int wayX[WAYPOINTS] = {2200,  2200,   200,   100,  1100};
+static const int wayY[WAYPOINTS] = {   0, -1100, -1100, -2100, -2100};
+
+/**
+ *  \brief Distance (in mm) to a waypoint at which it's reached.
+ */
+#define WAY_DIST  100
+
+
+/* ========================================================================== */
+
+int main ( void )
+{
+	uint cycle = 0;
+	uint way   = 0;
+	uint state = AVOID_GOAL;
+	int  x, y, goal;
+
+	printStr("Test Avoid started!\n");
+
+	mouse_init();
+	sensors_init();
+	actuators_init();
+	avoid_init();
+
+	while (1) {
+		mouse_waitStep10ms();
+
+		sensors_update();
+		sensors_position(&x, &y);
+
+		if (way < WAYPOINTS && abs(x - wayX[way]) < WAY_DIST && abs(y - wayY[way]) < WAY_DIST) {
+			printf("%4u s: waypoint %u reached\n", cycle / 100, way);
+			way++;
+		}
+
+		if (way < WAYPOINTS) {
+			goal  = trig_atan2(wayY[way] - y, wayX[way] - x) / 1000;
+			state = avoid_update(goal);
+		} else {
+			actuators_setVel(0, 0);
+		}
+
+		actuators_update();
+
+		if (++cycle % 100 == 0 && way < WAYPOINTS) {
+			printf("%4u s: position %5d, %5d mm, state %u, goal %4d, direction %4d, front %u\n",
+				cycle / 100, x, y, state, goal, avoid_direction(), avoid_density(0));
+		}
+	}
+}
+
+
+/* = EOF ==================================================================== */
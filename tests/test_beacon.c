@@ -0,0 +1,151 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tests/test_beacon.c
+ *  \brief Tests for the beacon triangulation module.
+ *
+ *  Sweeps for the beacon standing still, then tracks it while weaving
+ *   towards it, so the bearings are taken from both sides, until the
+ *   largest standard deviation of the beacon position is under DASH_ERR mm,
+ *   then dashes straight to it. Every second prints the position, the
+ *   number of bearings, the estimate and its error, and at the end where
+ *   the robot stopped and whether it's on the ground mark of the beacon.
+ *
+ *    MR_SIM_ARENA=sim/arenas/open.arena MR_SIM_TIME=60 sim/test_beacon
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/mouse.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <mouse/beacon.h>
+#include <util/trig.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Confidence of the sweep from which the beacon is tracked.
+ */
+#define LOCK_CONF    50
+
+/**
+ *  \brief Wheels velocities (in cm/s) of the weave, and time (in cycles)
+ *   of each turn.
+ */
+#define WEAVE_IN     24
+#define WEAVE_OUT    36
+#define WEAVE_TIME  150
+
+/**
+ *  \brief Error (in mm) under which the robot dashes, its velocity (in
+ *   cm/s), gain (in cm/s per degree) of the heading, and distance (in mm)
+ *   at which it stops.
+ */
+#define DASH_ERR    150
+#define DASH_VEL     40
+#define DASH_K        1
+#define DASH_STOP    50
+
+
+/* ========================================================================== */
+
+int main ( void )
+{
+	uint cycle = 0, weave = 0, error;
+	bool dash  = false, track = false;
+	int  x, y, bx = 0, by = 0, dx, dy, turn, l, r;
+
+	printStr("Test Beacon started!\n");
+
+	mouse_init();
+	sensors_init();
+	actuators_init();
+	beacon_init();
+
+	actuators_beaconSweep(true);
+
+	while (1) {
+		mouse_waitStep10ms();
+
+		sensors_update();
+		beacon_update();
+
+		sensors_position(&x, &y);
+		error = beacon_error(NULL, NULL, NULL);
+
+		if (!track && sensors_beaconConf() >= LOCK_CONF) {
+			track = true;
+
+			actuators_beaconTrack(true);
+			actuators_setVel(WEAVE_IN, WEAVE_OUT);
+
+			weave = WEAVE_TIME / 2;
+		}
+
+		/* Turn the other way */
+		if (track && !dash && --weave == 0) {
+			actuators_getVel(&l, &r);
+			actuators_setVel(r, l);
+
+			weave = WEAVE_TIME;
+		}
+
+		if (!dash && error < DASH_ERR && beacon_position(&bx, &by)) {
+			dash = true;
+
+			printf("Dashing to %d, %d mm after %u.%02u s, %u bearings, error %u mm\n",
+				bx, by, cycle / 100, cycle % 100, beacon_bearings(), error);
+		}
+
+		if (dash) {
+			beacon_position(&bx, &by);
+
+			dx = bx - x;
+			dy = by - y;
+
+			if (dx * dx + dy * dy < DASH_STOP * DASH_STOP) {
+				actuators_setVel(0, 0);
+				actuators_update();
+
+				printf("Stopped at %d, %d mm after %u.%02u s, %s the beacon mark\n",
+					x, y, cycle / 100, cycle % 100, sensors_groundC() ? "on" : "off");
+
+				while (1) {
+					mouse_waitStep10ms();
+
+					sensors_update();
+					actuators_update();
+				}
+			}
+
+			/* Heading error, in degrees */
+			turn = trig_norm(trig_atan2(dy, dx) - sensors_compass() * 1000) / 1000;
+			turn = turn > DASH_VEL ? DASH_VEL : (turn < -DASH_VEL ? -DASH_VEL : turn);
+
+			actuators_setVel(DASH_VEL - DASH_K * turn, DASH_VEL + DASH_K * turn);
+		}
+
+		actuators_update();
+
+		if (++cycle % 100 == 0) {
+			if (!beacon_position(&bx, &by)) {
+				bx = by = 0;
+			}
+
+			printf("%4u s: position %5d, %5d mm, %2u bearings, beacon %5d, %5d mm, error %u mm\n",
+				cycle / 100, x, y, beacon_bearings(), bx, by, error);
+		}
+	}
+}
+
+
+/* = EOF ==================================================================== */
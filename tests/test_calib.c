@@ -0,0 +1,53 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tests/test_calib.c
+ *  \brief Run the PI auto-tuning on the robot.
+ *
+ *  Press start to begin the experiment. The tuned gains are printed in
+ *   the conf.h format and then used to drive the robot forward.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/mouse.h>
+#include <mouse/actuators.h>
+#include <mouse/sensors.h>
+#include <mouse/calib.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+int main ( void )
+{
+	printStr("Test Calib started!");
+
+	mouse_init();
+	actuators_init();
+
+	while (!sensors_startBtn());
+
+	calib_tunePI();
+
+	actuators_setVel(20, 20);
+
+	while (!sensors_stopBtn()) {
+		mouse_waitStep10ms();
+
+		actuators_update();
+	}
+
+	actuators_stop();
+
+	return 0;
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,96 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tests/test_dwa.c
+ *  \brief Tests for the dynamic window planner module.
+ *
+ *  Drives to the beacon of sim/arenas/maze.arena like test_plan, but at
+ *   full speed: the path planner gives the way, and the dynamic window
+ *   planner follows a point LOOKAHEAD waypoints ahead on the path. Every
+ *   second prints the position, the planner state, the velocities and the
+ *   samples scored.
+ *
+ *    MR_SIM_ARENA=sim/arenas/maze.arena MR_SIM_TIME=60 sim/test_dwa
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/mouse.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <mouse/map.h>
+#include <mouse/plan.h>
+#include <mouse/dwa.h>
+#include <util/jobs.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+#define GOAL_X    2200
+#define GOAL_Y   -3100
+
+/**
+ *  \brief Waypoint of the path followed (the path nodes are PLAN_CELL mm
+ *   apart).
+ */
+#define LOOKAHEAD    4
+
+
+/* ========================================================================== */
+
+int main ( void )
+{
+	uint cycle = 0;
+	uint state = DWA_GO;
+	uint last, n;
+	int  x, y, vel, angVel;
+	int  xs[LOOKAHEAD], ys[LOOKAHEAD];
+
+	printStr("Test DWA started!\n");
+
+	mouse_init();
+	sensors_init();
+	actuators_init();
+	map_init();
+	plan_init();
+	dwa_init();
+
+	jobs_add("plan", plan_job, NULL);
+	plan_setGoal(GOAL_X, GOAL_Y);
+
+	while (1) {
+		mouse_waitStep10ms();
+
+		sensors_update();
+		map_update();
+
+		if (plan_update() == PLAN_READY && (n = plan_path(xs, ys, LOOKAHEAD)) > 0) {
+			state = dwa_update(xs[n - 1], ys[n - 1]);
+		} else if (plan_state() == PLAN_READY) {
+			state = dwa_update(GOAL_X, GOAL_Y);
+		} else {
+			actuators_setVel(0, 0);
+		}
+
+		actuators_update();
+
+		if (++cycle % 100 == 0 && state != DWA_ARRIVED) {
+			sensors_position(&x, &y);
+			dwa_getVel(&vel, &angVel);
+			dwa_samples(&last, NULL);
+
+			printf("%4u s: position %5d, %5d mm, state %u, %4d mm/s, %4d deg/s, samples %u\n",
+				cycle / 100, x, y, state, vel, angVel, last);
+		}
+	}
+}
+
+
+/* = EOF ==================================================================== */
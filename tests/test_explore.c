@@ -0,0 +1,135 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tests/test_explore.c
+ *  \brief Tests for the exploration module.
+ *
+ *  Explores the arena, going to the frontiers along the path of the
+ *   planner with the dynamic window planner, with the beacon sensor
+ *   sweeping. Against an obstacle the sensors missed (the wheels not
+ *   turning for STALL_TIME cycles) the robot backs off and the goal is
+ *   given up. Every second prints the position, the exploration state, the
+ *   number of frontier cells and the goal, and when the beacon is first
+ *   seen the time it took. On sim/arenas/hidden.arena the beacon is only
+ *   seen from the far side of the maze:
+ *
+ *    MR_SIM_ARENA=sim/arenas/hidden.arena MR_SIM_TIME=180 sim/test_explore
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/mouse.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <mouse/map.h>
+#include <mouse/plan.h>
+#include <mouse/dwa.h>
+#include <mouse/explore.h>
+#include <util/jobs.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Waypoint of the path followed (the path nodes are PLAN_CELL mm
+ *   apart).
+ */
+#define LOOKAHEAD    4
+
+/**
+ *  \brief Cycles without the wheels turning, while driven, before backing
+ *   off, and time (in cycles) and velocity (in cm/s) backing off.
+ */
+#define STALL_TIME  50
+#define BACK_TIME   50
+#define BACK_VEL    20
+
+
+/* ========================================================================== */
+
+int main ( void )
+{
+	uint cycle = 0, seen = 0, back = 0, stall = 0;
+	uint state, n;
+	int  x, y, gx, gy;
+	int  odoL, odoR, lastL = 0, lastR = 0, velL, velR;
+	int  xs[LOOKAHEAD], ys[LOOKAHEAD];
+
+	printStr("Test Explore started!\n");
+
+	mouse_init();
+	sensors_init();
+	actuators_init();
+	map_init();
+	plan_init();
+	dwa_init();
+	explore_init();
+
+	jobs_add("plan", plan_job, NULL);
+	actuators_beaconSweep(true);
+
+	while (1) {
+		mouse_waitStep10ms();
+
+		sensors_update();
+		map_update();
+		state = explore_update();
+
+		sensors_odoInt(&odoL, &odoR);
+		actuators_getVel(&velL, &velR);
+
+		if (odoL != lastL || odoR != lastR || (velL == 0 && velR == 0)) {
+			lastL = odoL;
+			lastR = odoR;
+			stall = 0;
+		} else {
+			stall++;
+		}
+
+		if (back > 0) {
+			back--;
+			plan_update();
+			actuators_setVel(-BACK_VEL, -BACK_VEL);
+		} else if (stall >= STALL_TIME) {
+			back  = BACK_TIME;
+			stall = 0;
+			explore_reject();
+		} else if (plan_update() == PLAN_READY && (n = plan_path(xs, ys, LOOKAHEAD)) > 0) {
+			dwa_update(xs[n - 1], ys[n - 1]);
+		} else {
+			actuators_setVel(0, 0);
+		}
+
+		actuators_update();
+
+		cycle++;
+
+		if (seen == 0 && sensors_beacon()) {
+			seen = cycle;
+
+			printf("Beacon seen after %u.%02u s, bearing %d\n",
+				cycle / 100, cycle % 100, sensors_beaconBearing());
+		}
+
+		if (cycle % 100 == 0) {
+			sensors_position(&x, &y);
+
+			if (!explore_goal(&gx, &gy)) {
+				gx = gy = 0;
+			}
+
+			printf("%4u s: position %5d, %5d mm, state %u, %4u frontiers, goal %5d, %5d mm\n",
+				cycle / 100, x, y, state, explore_frontiers(), gx, gy);
+		}
+	}
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,89 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tests/test_jobs.c
+ *  \brief Tests for the background jobs.
+ *
+ *  Spins in place, building the map, with a far goal for the planner and
+ *   the planner search running as a background job. A second job counts
+ *   how many loop iterations fit in the rest of the idle time. Every 2 s
+ *   prints the jobs report: work done on the last cycle and per cycle,
+ *   and the longest run beyond the budget.
+ *
+ *  The jobs take the idle time, so the host simulation runs in real time.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/mouse.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <mouse/map.h>
+#include <mouse/plan.h>
+#include <util/jobs.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+/* ===================
+ * Count loop iterations (in thousands) until the budget is over
+ */
+static uint countJob ( void* arg, uint budgetUs )
+{
+	uint start = readCoreTimer();
+	uint count = 0;
+
+	while (readCoreTimer() - start < budgetUs * CORE_US) {
+		count++;
+	}
+
+	return count / 1000 + 1;
+}
+
+
+/* ========================================================================== */
+
+int main ( void )
+{
+	uint cycle = 0;
+
+	printStr("Test Jobs started!\n");
+
+	mouse_init();
+	sensors_init();
+	actuators_init();
+	map_init();
+	plan_init();
+
+	jobs_add("plan", plan_job, NULL);
+	jobs_add("count", countJob, NULL);
+
+	plan_setGoal(3000, 3000);
+
+	actuators_setVel(-10, 10);
+
+	while (1) {
+		mouse_waitStep10ms();
+
+		sensors_update();
+		map_update();
+		plan_update();
+
+		actuators_update();
+
+		if (++cycle % 200 == 0) {
+			printf("%u s: plan state %u, length %d mm\n", cycle / 100, plan_state(), plan_length());
+			jobs_report();
+		}
+	}
+}
+
+
+/* = EOF ==================================================================== */
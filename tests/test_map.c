@@ -0,0 +1,108 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tests/test_map.c
+ *  \brief Tests for the map module.
+ *
+ *  Wanders around, turning away from the obstacles, and every 10 s prints
+ *   the map around the robot ('#' occupied, '.' free, 'R' the robot), the
+ *   distance to the nearest occupied cell ahead and the front sensor
+ *   reading.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/mouse.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <mouse/map.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Cells printed on each side of the robot.
+ */
+#define VIEW    32
+
+
+/* ========================================================================== */
+
+static void printMap ( void )
+{
+	char line[2 * VIEW + 2];
+	int  x, y, rx, ry;
+	int  i, j;
+
+	sensors_position(&x, &y);
+
+	if (!map_toCell(x, y, &rx, &ry))
+		return;
+
+	/* North (+Y) up */
+	for (j = ry + VIEW; j >= ry - VIEW; j--) {
+		for (i = rx - VIEW; i <= rx + VIEW; i++) {
+			switch (map_cellState(i, j)) {
+			case MAP_OCCUPIED: line[i - rx + VIEW] = '#'; break;
+			case MAP_FREE:     line[i - rx + VIEW] = '.'; break;
+			default:           line[i - rx + VIEW] = ' '; break;
+			}
+		}
+
+		line[VIEW] = (j == ry) ? 'R' : line[VIEW];
+		line[2 * VIEW + 1] = '\0';
+
+		printf("%s\n", line);
+	}
+
+	printf("position %d, %d mm, heading %d, nearest ahead %d mm, front sensor %d cm\n",
+		x, y, sensors_compass(), map_nearest(x, y, sensors_compass(), 1000), sensors_obstF());
+}
+
+
+/* ========================================================================== */
+
+int main ( void )
+{
+	uint cycle = 0;
+
+	printStr("Test Map started!\n");
+
+	mouse_init();
+	sensors_init();
+	actuators_init();
+	map_init();
+
+	while (1) {
+		mouse_waitStep10ms();
+
+		sensors_update();
+		map_update();
+
+		if (sensors_obstF() < 25 || sensors_bump()) {
+			actuators_setVel(-20, 20);
+		} else if (sensors_obstL() < 20) {
+			actuators_setVel(30, 10);
+		} else if (sensors_obstR() < 20) {
+			actuators_setVel(10, 30);
+		} else {
+			actuators_setVel(30, 30);
+		}
+
+		actuators_update();
+
+		if (++cycle % 1000 == 0) {
+			printMap();
+		}
+	}
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,127 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tests/test_mcl.c
+ *  \brief Tests for the Monte Carlo localization module.
+ *
+ *  Localizes the robot on the walls of sim/arenas/maze.arena, from a rough
+ *   guess of the start pose, while it follows the wall on the left. Every
+ *   second prints the odometry in the arena frame, the estimate, the mean
+ *   distance of the particles to it and their number, which is cut down to
+ *   FEW_PARTICLES after FEW_TIME seconds.
+ *
+ *    MR_SIM_ARENA=sim/arenas/maze.arena MR_SIM_TIME=120 sim/test_mcl
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/mouse.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <mouse/mcl.h>
+#include <util/trig.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Arena size and walls (in mm), as in sim/arenas/maze.arena.
+ */
+#define ARENA_W     4000
+#define ARENA_H     3000
+#define WALLS       5
+
+static const int walls[WALLS][4] = {
+	{ 1000,    0, 1000, 1800 },
+	{ 2000, 3000, 2000, 1200 },
+	{ 3000,    0, 3000, 1800 },
+	{ 2300, 1000, 2700, 1000 },
+	{  400, 2200,  800, 2200 },
+};
+
+/**
+ *  \brief Start pose in the arena (in mm and degrees), and the error of
+ *   the guess given.
+ */
+#define START_X      400
+#define START_Y      400
+#define START_DEG     90
+#define GUESS_DX     120
+#define GUESS_DY     -80
+#define GUESS_DDEG     8
+
+/**
+ *  \brief Distance to the wall (in cm) and velocity (in cm/s).
+ */
+#define WALL_DIST    15
+#define WALL_VEL     30
+
+/**
+ *  \brief Time (in s) after which FEW_PARTICLES are used.
+ */
+#define FEW_TIME      60
+#define FEW_PARTICLES (MCL_PARTICLES / 4)
+
+
+/* ========================================================================== */
+
+int main ( void )
+{
+	uint cycle = 0;
+	uint spread, i;
+	int  x, y, ox, oy, ex, ey, deg;
+	int  c = trig_cos(START_DEG * 1000);
+	int  s = trig_sin(START_DEG * 1000);
+
+	printStr("Test MCL started!\n");
+
+	mouse_init();
+	sensors_init();
+	actuators_init();
+	mcl_init();
+
+	mcl_setArena(ARENA_W, ARENA_H);
+
+	for (i = 0; i < WALLS; i++) {
+		mcl_addWall(walls[i][0], walls[i][1], walls[i][2], walls[i][3]);
+	}
+
+	mcl_setPose(START_X + GUESS_DX, START_Y + GUESS_DY, START_DEG + GUESS_DDEG,
+		2 * abs(GUESS_DX), 2 * GUESS_DDEG);
+
+	actuators_wallFollow(ACTUATORS_WALL_LEFT, WALL_DIST, WALL_VEL);
+
+	while (1) {
+		mouse_waitStep10ms();
+
+		sensors_update();
+		mcl_update();
+		actuators_update();
+
+		if (++cycle == FEW_TIME * 100) {
+			mcl_setParticles(FEW_PARTICLES);
+		}
+
+		if (cycle % 100 == 0) {
+			sensors_position(&x, &y);
+
+			ox = START_X + (x * c - y * s) / TRIG_ONE;
+			oy = START_Y + (x * s + y * c) / TRIG_ONE;
+
+			spread = mcl_pose(&ex, &ey, &deg);
+
+			printf("%4u s: odometry %5d, %5d mm, estimate %5d, %5d mm %4d deg, spread %4u mm, %3u particles\n",
+				cycle / 100, ox, oy, ex, ey, deg, spread, mcl_particles());
+		}
+	}
+}
+
+
+/* = EOF ==================================================================== */
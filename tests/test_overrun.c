@@ -0,0 +1,90 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tests/test_overrun.c
+ *  \brief Tests for the cycle overrun detection and the degraded modes.
+ *
+ *  Drives forward while more and more cycles overrun by one tick (none,
+ *   every 16th, every 4th, all of them), in steps of 200 cycles, and prints
+ *   the cycle statistics and the operating mode after each step. The robot
+ *   slows down and then stops on MOUSE_SAFE, where the watchdog resets it
+ *   (the simulation exits with status 3).
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <hal/robot.h>
+#include <mouse/mouse.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+/* ===================
+ * Keep the loop busy for a number of ticks
+ */
+static void work ( uint ticks )
+{
+	uint start = robot_ticks();
+
+	while (robot_ticks() - start < ticks) {
+		robot_idle();
+	}
+}
+
+
+/* ========================================================================== */
+
+int main ( void )
+{
+	static const uint every[] = {0, 16, 4, 1};     // Cycles between overruns
+
+	mouseCycleStats stats;
+	uint step = 0;
+	int  i;
+
+	printStr("Test Overrun started!\n");
+
+	mouse_init();
+	sensors_init();
+	actuators_init();
+
+	if (robot_wdtReset()) {
+		printStr("Reset by the watchdog\n");
+	}
+
+	actuators_setVel(30, 30);
+
+	while (1) {
+		for (i = 0; i < 200; i++) {
+			mouse_waitStep10ms();
+
+			sensors_update();
+			actuators_update();
+
+			if (every[step] && (i % every[step]) == 0) {
+				work(2);
+			}
+		}
+
+		mouse_cycleStats(&stats);
+
+		printf("work %u: %u overruns, %u ticks missed, worst %u us late, level %u, mode %u\n",
+			step, stats.overruns, stats.missed, stats.maxLate, stats.level, mouse_mode());
+
+		mouse_cycleReset();
+
+		step = step < 3 ? step + 1 : step;
+	}
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,106 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tests/test_plan.c
+ *  \brief Tests for the planner module.
+ *
+ *  Drives to a goal 2.2 m ahead and 3.1 m to the right of the start (the
+ *   beacon of sim/arenas/maze.arena), following the planner waypoints
+ *   while the map is built. Every second prints the position, the planner
+ *   state, the path length and the nodes expanded so far.
+ *
+ *    MR_SIM_ARENA=sim/arenas/maze.arena MR_SIM_TIME=120 sim/test_plan
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/mouse.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <mouse/map.h>
+#include <mouse/plan.h>
+#include <util/trig.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+#define GOAL_X    2200
+#define GOAL_Y   -3100
+
+/**
+ *  \brief Distance (in mm) to the goal at which it's reached.
+ */
+#define GOAL_DIST  150
+
+
+/* ========================================================================== */
+
+/* ===================
+ * Turn towards the waypoint, and move forward when facing it
+ */
+static void follow ( int x, int y, int wx, int wy )
+{
+	int err = trig_norm(trig_atan2(wy - y, wx - x) - sensors_compass() * 1000) / 1000;
+
+	if (abs(err) > 45) {
+		actuators_setVel(err > 0 ? -15 : 15, err > 0 ? 15 : -15);
+	} else {
+		actuators_setVel(30 - err / 3, 30 + err / 3);
+	}
+}
+
+
+/* ========================================================================== */
+
+int main ( void )
+{
+	uint cycle = 0;
+	uint state;
+	int  x, y, wx, wy;
+
+	printStr("Test Plan started!\n");
+
+	mouse_init();
+	sensors_init();
+	actuators_init();
+	map_init();
+	plan_init();
+
+	plan_setGoal(GOAL_X, GOAL_Y);
+
+	while (1) {
+		mouse_waitStep10ms();
+
+		sensors_update();
+		map_update();
+		state = plan_update();
+
+		sensors_position(&x, &y);
+
+		if (abs(x - GOAL_X) < GOAL_DIST && abs(y - GOAL_Y) < GOAL_DIST) {
+			actuators_setVel(0, 0);
+			plan_stop();
+		} else if (state == PLAN_READY && plan_next(&wx, &wy)) {
+			follow(x, y, wx, wy);
+		} else if (state != PLAN_BUSY) {
+			actuators_setVel(0, 0);
+		}
+
+		actuators_update();
+
+		if (++cycle % 100 == 0) {
+			printf("%4u s: position %5d, %5d mm, state %u, length %5d mm, expanded %u\n",
+				cycle / 100, x, y, state, plan_length(), plan_expanded());
+		}
+	}
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,66 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tests/test_prof.c
+ *  \brief Tests for the profiling of code regions.
+ *
+ *  Runs the sensors and actuators modules for 500 cycles and prints the
+ *   time spent on each region and on the ISRs. PROF MUST be enabled in
+ *   util/prof.h and ISR_PROF in hal/robot.h.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <hal/robot.h>
+#include <mouse/mouse.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <util/prof.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+int main ( void )
+{
+	int i;
+
+	printStr("Test Profiling started!\n");
+
+	mouse_init();
+	sensors_init();
+	actuators_init();
+
+	actuators_setVel(30, 30);
+
+	robot_isrReset();
+
+	for (i = 0; i < 500; i++) {
+		mouse_waitStep10ms();
+
+		PROF_BEGIN(cycle);
+
+		sensors_update();
+		actuators_update();
+
+		PROF_END(cycle);
+	}
+
+	actuators_stop();
+
+	prof_report();
+	robot_isrReport();
+
+	while (1) {
+		mouse_waitStep10ms();
+	}
+}
+
+
+/* = EOF ==================================================================== */
@@ -6,6 +6,8 @@
  *  \file  tests/test_sensors.c
  *  \brief Tests for sensors module.
  *
+ *  The readings are sent with the binary logger, decode the serial port
+ *   output with tools/mlogdump.
  *
  *  \version 0.1.0
  *  \date    Nov 2012
@@ -16,6 +18,7 @@
 #include <base.h>
 #include <mouse/mouse.h>
 #include <mouse/sensors.h>
+#include <util/mlog.h>
 #include <detpic32.h>
 
 
@@ -29,7 +32,7 @@ int main ( void )
 	sensors_init();
 
 	while (1) {
-		waitStep10ms();
+		mouse_waitStep10ms();
 
 		sensors_update();
 
@@ -39,7 +42,7 @@ int main ( void )
 		sensors_odoPart (&odoPL, &odoPR);
 		sensors_odoInt  (&odoIL, &odoIR);
 
-		printf("%3d %3d %3d | %d | %d%d%d%d%d | %3d %3d %5d %5d | %3d | %d%d\n",
+		mlogDebug(LOG_TEST_SENS,
 			sensors_obstL(), sensors_obstF(), sensors_obstR(),
 			sensors_beacon(),
 			sensors_groundL(), sensors_groundCL(), sensors_groundCF(), sensors_groundCR(), sensors_groundR(),
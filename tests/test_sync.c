@@ -0,0 +1,97 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tests/test_sync.c
+ *  \brief Tests for the cross-coupling between the wheels controllers.
+ *
+ *  Drives straight through a few velocity steps, where the wheels
+ *   controllers don't settle together, and every second prints the heading
+ *   and how far the robot drifted sideways. At the end prints the largest
+ *   drift. Build it with and without PI_SYNC (see inc/conf.h) to compare,
+ *   on the host:
+ *
+ *    make -C sim test_sync sync
+ *    sim/test_sync; sim/sync
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/mouse.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Velocities (in cm/s) driven, for STEP_TIME cycles each.
+ */
+#define STEPS        5
+#define STEP_TIME  100
+
+static const int steps[STEPS] = { 60, 20, 50, 10, 40 };
+
+
+/* ========================================================================== */
+
+int main ( void )
+{
+	uint cycle = 0, step = 0;
+	int  x, y, drift = 0;
+
+#ifdef PI_SYNC
+	printStr("Test Sync started, with PI_SYNC!\n");
+#else
+	printStr("Test Sync started, without PI_SYNC!\n");
+#endif
+
+	mouse_init();
+	sensors_init();
+	actuators_init();
+
+	actuators_setVel(steps[0], steps[0]);
+
+	while (1) {
+		mouse_waitStep10ms();
+
+		sensors_update();
+		sensors_position(&x, &y);
+
+		drift = abs(y) > drift ? abs(y) : drift;
+
+		if (++cycle % STEP_TIME == 0) {
+			printf("%4u s: %2d cm/s, position %5d, %4d mm, heading %3d deg\n",
+				cycle / 100, steps[step], x, y, sensors_compass());
+
+			if (++step == STEPS) {
+				break;
+			}
+
+			actuators_setVel(steps[step], steps[step]);
+		}
+
+		actuators_update();
+	}
+
+	actuators_setVel(0, 0);
+	actuators_update();
+
+	printf("Largest drift %d mm over %d mm\n", drift, x);
+
+	while (1) {
+		mouse_waitStep10ms();
+
+		sensors_update();
+		actuators_update();
+	}
+}
+
+
+/* = EOF ==================================================================== */
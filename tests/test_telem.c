@@ -0,0 +1,55 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tests/test_telem.c
+ *  \brief Tests for the telemetry stream.
+ *
+ *  Drives forward while the start button is pressed and streams all the
+ *   fields. Convert the serial port capture with tools/telemdump.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/mouse.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <util/telem.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+int main ( void )
+{
+	printStr("Test Telemetry started!\n");
+
+	mouse_init();
+	sensors_init();
+	actuators_init();
+	telem_init(TELEM_ALL);
+
+	while (1) {
+		mouse_waitStep10ms();
+
+		sensors_update();
+
+		if (sensors_startBtn()) {
+			actuators_setVel(30, 30);
+		} else {
+			actuators_setVel(0, 0);
+		}
+
+		actuators_update();
+
+		telem_send();
+	}
+}
+
+
+/* = EOF ==================================================================== */
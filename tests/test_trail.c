@@ -0,0 +1,143 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tests/test_trail.c
+ *  \brief Tests for the trail module.
+ *
+ *  Drives a circle back to the start, that is cut out of the trail, then
+ *   follows the wall on the left until OUT_TIME seconds recording the
+ *   trail, and drives it back to the start. Every second prints the
+ *   position and the number of keyframes, and at the end the length of the
+ *   way out, of the trail kept and the time taken back.
+ *
+ *    MR_SIM_ARENA=sim/arenas/maze.arena MR_SIM_TIME=180 sim/test_trail
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/mouse.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <mouse/trail.h>
+#include <util/trig.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Time (in 10 ms cycles) and wheels velocities (in cm/s) of the
+ *   circle.
+ */
+#define CIRCLE_TIME 330
+#define CIRCLE_IN   10
+#define CIRCLE_OUT  30
+
+/**
+ *  \brief Time (in s) going out, distance to the wall (in cm) and velocity
+ *   (in cm/s).
+ */
+#define OUT_TIME    60
+#define WALL_DIST   15
+#define WALL_VEL    30
+
+
+/* ========================================================================== */
+
+int main ( void )
+{
+	static int xs[TRAIL_POINTS], ys[TRAIL_POINTS];
+
+	uint cycle = 0, back = 0;
+	uint state, n, i;
+	int  x, y, lastX, lastY, dx, dy;
+	int  out = 0, kept = 0;
+
+	printStr("Test Trail started!\n");
+
+	mouse_init();
+	sensors_init();
+	actuators_init();
+	trail_init();
+
+	actuators_setVel(CIRCLE_IN, CIRCLE_OUT);
+
+	sensors_position(&lastX, &lastY);
+
+	while (1) {
+		mouse_waitStep10ms();
+
+		sensors_update();
+		state = trail_update();
+		actuators_update();
+
+		sensors_position(&x, &y);
+
+		dx = x - lastX;
+		dy = y - lastY;
+
+		if (state == TRAIL_RECORD && dx * dx + dy * dy >= 50 * 50) {
+			out  += trig_sqrt(dx * dx + dy * dy);
+			lastX = x;
+			lastY = y;
+		}
+
+		if (++cycle == CIRCLE_TIME) {
+			printf("Circle done, %u keyframes\n", trail_points(NULL, NULL, 0));
+
+			actuators_wallFollow(ACTUATORS_WALL_LEFT, WALL_DIST, WALL_VEL);
+		}
+
+		if (cycle == OUT_TIME * 100) {
+			n = trail_points(xs, ys, TRAIL_POINTS);
+
+			for (i = 1; i < n; i++) {
+				dx    = xs[i] - xs[i - 1];
+				dy    = ys[i] - ys[i - 1];
+				kept += trig_sqrt(dx * dx + dy * dy);
+			}
+
+			kept += trig_sqrt((x - xs[n - 1]) * (x - xs[n - 1]) + (y - ys[n - 1]) * (y - ys[n - 1]));
+
+			printf("Way out %d mm, trail %d mm in %u keyframes, returning\n",
+				out, kept, n);
+
+			actuators_wallFollow(ACTUATORS_WALL_OFF, 0, 0);
+			trail_return();
+		}
+
+		if (state == TRAIL_RETURN) {
+			back++;
+		}
+
+		if (state == TRAIL_HOME) {
+			printf("Home at %d, %d mm after %u.%02u s\n",
+				x, y, back / 100, back % 100);
+
+			actuators_setVel(0, 0);
+
+			while (1) {
+				mouse_waitStep10ms();
+
+				sensors_update();
+				actuators_update();
+			}
+		}
+
+		if (cycle % 100 == 0) {
+			n = trail_points(NULL, NULL, 0);
+
+			printf("%4u s: position %5d, %5d mm, state %u, %2u keyframes\n",
+				cycle / 100, x, y, state, n);
+		}
+	}
+}
+
+
+/* = EOF ==================================================================== */
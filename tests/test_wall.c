@@ -0,0 +1,72 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tests/test_wall.c
+ *  \brief Tests for the wall following mode of the actuators module.
+ *
+ *  Follows the wall on the left at WALL_DIST cm. On sim/arenas/maze.arena
+ *   the robot first turns left to find the outer wall, then goes round the
+ *   inside corners and round the ends of the walls inside the arena. Every
+ *   second prints the position, the wall following state and the distance
+ *   to the wall.
+ *
+ *    MR_SIM_ARENA=sim/arenas/maze.arena MR_SIM_TIME=120 sim/test_wall
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+#include <base.h>
+#include <mouse/mouse.h>
+#include <mouse/sensors.h>
+#include <mouse/actuators.h>
+#include <detpic32.h>
+
+
+/* ========================================================================== */
+
+/**
+ *  \brief Distance to the wall (in cm) and velocity (in cm/s).
+ */
+#define WALL_DIST   15
+#define WALL_VEL    30
+
+
+/* ========================================================================== */
+
+int main ( void )
+{
+	uint cycle = 0;
+	uint state;
+	int  x, y, dist;
+
+	printStr("Test Wall started!\n");
+
+	mouse_init();
+	sensors_init();
+	actuators_init();
+
+	actuators_wallFollow(ACTUATORS_WALL_LEFT, WALL_DIST, WALL_VEL);
+
+	while (1) {
+		mouse_waitStep10ms();
+
+		sensors_update();
+		actuators_update();
+
+		if (++cycle % 100 == 0) {
+			sensors_position(&x, &y);
+			state = actuators_wallState(&dist);
+
+			printf("%4u s: position %5d, %5d mm, state %u, wall %4d mm\n",
+				cycle / 100, x, y, state, dist);
+		}
+	}
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,183 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tools/mlogdump.c
+ *  \brief Decode the binary log sent by the robot.
+ *
+ *  Usage: mlogdump [-r journal] [file]
+ *
+ *  Reads the serial port capture from the file (or stdin) and prints one
+ *   line per log record, with the time in seconds and the level. Text
+ *   printed by the application on the same port is passed through, and
+ *   telemetry frames (see inc/util/telem.h) are skipped.
+ *
+ *  Recorded inputs (MLOG_REC records, see inc/util/rec.h) aren't printed.
+ *   With -r they are written to the journal file, to be replayed on the
+ *   host.
+ *
+ *  The message table is taken from inc/mlogfmt.h at build time, so this
+ *   MUST be rebuilt with the same table as the robot program.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+/* System headers go first, base.h defines an abs() macro */
+#include <stdio.h>
+#include <string.h>
+
+#include <base.h>
+#include <util/mlog.h>
+
+
+/* ========================================================================== */
+
+#define MLOG_FMT(id, fmt) fmt,
+
+static const char* formats[MLOG_N_FORMATS] = {
+	MLOG_FORMATS
+};
+
+#undef MLOG_FMT
+
+static const char levels[] = { 'D', 'I', 'W', 'E' };
+
+
+/* ========================================================================== */
+
+static bool readWord ( FILE* in, uint* word )
+{
+	int c, i;
+
+	(*word) = 0;
+
+	for (i = 0; i < 4; i++) {
+		if ((c = fgetc(in)) == EOF)
+			return false;
+
+		(*word) |= (uint) c << (8 * i);
+	}
+
+	return true;
+}
+
+static void printRecord ( ulong tick, uint hdr, const int* a )
+{
+	uint id = MLOG_HDR_ID(hdr);
+
+	printf("%6lu.%02lu %c ", tick / 100, tick % 100, levels[MLOG_HDR_LEVEL(hdr)]);
+
+	printf(formats[id],
+		a[ 0], a[ 1], a[ 2], a[ 3], a[ 4], a[ 5], a[ 6], a[ 7],
+		a[ 8], a[ 9], a[10], a[11], a[12], a[13], a[14], a[15],
+		a[16], a[17], a[18], a[19], a[20], a[21], a[22], a[23],
+		a[24], a[25], a[26], a[27], a[28], a[29], a[30]);
+
+	putchar('\n');
+}
+
+
+/* ========================================================================== */
+
+int main ( int argc, char* argv[] )
+{
+	FILE* in  = stdin;
+	FILE* rec = NULL;
+
+	int  args[MLOG_MAX_ARGS];
+	uint hdr, nargs, i;
+	int  c;
+	int  arg = 1;
+
+	ulong tick     = 0;                      // Tick with the wraps added
+	uint  lastTick = 0;
+	bool  text     = false;                  // In the middle of a text line
+
+	if (argc > 2 && strcmp(argv[1], "-r") == 0) {
+		if ((rec = fopen(argv[2], "wb")) == NULL) {
+			perror(argv[2]);
+			return 1;
+		}
+
+		arg = 3;
+	}
+
+	if (argc > arg && (in = fopen(argv[arg], "rb")) == NULL) {
+		perror(argv[arg]);
+		return 1;
+	}
+
+	while ((c = fgetc(in)) != EOF) {
+		if (c == 0) {                        // Telemetry frame, up to the next 0
+			while ((c = fgetc(in)) != EOF && c != 0)
+				;
+			continue;
+		}
+
+		if (c != MLOG_SYNC) {
+			putchar(c);
+			text = (c != '\n');
+			continue;
+		}
+
+		if (!readWord(in, &hdr))
+			break;
+
+		if (MLOG_HDR_ID(hdr) >= MLOG_N_FORMATS) {
+			fprintf(stderr, "mlogdump: bad record header 0x%08x\n", hdr);
+			continue;
+		}
+
+		nargs = MLOG_HDR_NARGS(hdr);
+
+		for (i = 0; i < MLOG_MAX_ARGS; i++) {
+			args[i] = 0;
+		}
+
+		for (i = 0; i < nargs; i++) {
+			if (!readWord(in, (uint*) &args[i]))
+				break;
+		}
+
+		if (i < nargs)
+			break;
+
+		tick    += (MLOG_HDR_TICK(hdr) - lastTick) & 0xFFFF;
+		lastTick = MLOG_HDR_TICK(hdr);
+
+		if (MLOG_HDR_ID(hdr) == MLOG_REC) {
+			for (i = 0; rec != NULL && i < (uint) args[0] && i < 4 * (nargs - 1); i++) {
+				fputc((args[1 + i / 4] >> (8 * (i % 4))) & 0xFF, rec);
+			}
+			continue;
+		}
+
+		if (MLOG_HDR_ID(hdr) == MLOG_DROPPED && rec != NULL) {
+			fprintf(stderr, "mlogdump: records were dropped, the journal has gaps\n");
+		}
+
+		if (text) {
+			putchar('\n');
+			text = false;
+		}
+
+		printRecord(tick, hdr, args);
+	}
+
+	if (in != stdin) {
+		fclose(in);
+	}
+
+	if (rec != NULL) {
+		fclose(rec);
+	}
+
+	return 0;
+}
+
+
+/* = EOF ==================================================================== */
@@ -0,0 +1,249 @@
+/* ==========================================================================
+ * libmr - A lowlevel library for "Micro Rato"
+ * ========================================================================== */
+
+/**
+ *  \file  tools/telemdump.c
+ *  \brief Convert a telemetry capture to CSV.
+ *
+ *  Usage: telemdump [file]
+ *
+ *  Reads the serial port capture from the file (or stdin) and prints one
+ *   CSV line per frame. A header line is printed on the first frame and
+ *   every time the field selection changes. Anything that isn't a valid
+ *   frame (log records, text, damaged frames) is skipped, and the delta
+ *   frames after a lost frame are skipped until the next key frame.
+ *
+ *  \version 0.1.0
+ *  \date    Oct 2026
+ *
+ *  \author Filipe Manco <filipe.manco@gmail.com>
+ */
+
+/* System headers go first, base.h defines an abs() macro */
+#include <stdio.h>
+
+#include <base.h>
+#include <util/telem.h>
+
+
+/* ========================================================================== */
+
+#define TELEM_FIELD(id, name) name,
+
+static const char* names[TELEM_N_FIELDS] = {
+	TELEM_FIELDS
+};
+
+#undef TELEM_FIELD
+
+static int   values[TELEM_N_FIELDS];
+static uint  mask     = 0;
+static bool  synced   = false;              // Values are valid
+static bool  headed   = false;              // Header line printed
+static uint  lastSeq  = 0;
+static uint  lastTick = 0;
+static ulong tick     = 0;                  // Tick with the wraps added
+
+static ulong nFrames = 0, nBad = 0, nLost = 0;   // nBad includes the log and text
+
+
+/* ========================================================================== */
+
+static uint crc16 ( const uchar* data, uint len )
+{
+	uint crc = 0xFFFF;
+	uint i, b;
+
+	for (i = 0; i < len; i++) {
+		crc ^= (uint) data[i] << 8;
+
+		for (b = 0; b < 8; b++) {
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+
+	return crc & 0xFFFF;
+}
+
+static int uncobs ( const uchar* src, uint len, uchar* dst )
+{
+	uint in = 0, out = 0;
+	uint code, i;
+
+	while (in < len) {
+		code = src[in++];
+
+		if (code == 0 || in + code - 1 > len)
+			return -1;
+
+		for (i = 1; i < code; i++) {
+			dst[out++] = src[in++];
+		}
+
+		if (code != 0xFF && in < len) {
+			dst[out++] = 0;
+		}
+	}
+
+	return out;
+}
+
+static bool getVarint ( const uchar** p, const uchar* end, int* value )
+{
+	uint v = 0;
+	uint shift = 0;
+
+	do {
+		if ((*p) >= end || shift > 28)
+			return false;
+
+		v |= (uint) ((**p) & 0x7F) << shift;
+		shift += 7;
+	} while (*(*p)++ & 0x80);
+
+	(*value) = (int) (v >> 1) ^ -(int) (v & 1);
+
+	return true;
+}
+
+static void header ( void )
+{
+	uint i;
+
+	printf("seq,tick");
+
+	for (i = 0; i < TELEM_N_FIELDS; i++) {
+		if (mask & (1u << i)) {
+			printf(",%s", names[i]);
+		}
+	}
+
+	putchar('\n');
+}
+
+static void frame ( const uchar* buf, uint len )
+{
+	const uchar* p   = buf + 4;
+	const uchar* end = buf + len - 2;
+
+	int  next[TELEM_N_FIELDS];
+	uint newMask = mask;
+	bool key;
+	uint seq, i;
+	int  v;
+
+	if (len < 6 || crc16(buf, len - 2) != (buf[len - 2] | (uint) buf[len - 1] << 8)) {
+		nBad++;
+		return;
+	}
+
+	seq = buf[0];
+	key = buf[1] & TELEM_KEY;
+
+	if (nFrames > 0 && seq != ((lastSeq + 1) & 0xFF)) {
+		nLost += (seq - lastSeq - 1) & 0xFF;
+		synced = false;
+	}
+
+	nFrames++;
+	lastSeq = seq;
+
+	if (key) {
+		if (len < 10) {
+			nBad++;
+			return;
+		}
+
+		newMask = buf[4] | buf[5] << 8 | buf[6] << 16 | (uint) buf[7] << 24;
+		p = buf + 8;
+
+	} else if (!synced) {
+		return;
+	}
+
+	for (i = 0; i < TELEM_N_FIELDS; i++) {
+		if (!(newMask & (1u << i)))
+			continue;
+
+		if (!getVarint(&p, end, &v)) {
+			nBad++;
+			synced = false;
+			return;
+		}
+
+		next[i] = key ? v : values[i] + v;
+	}
+
+	if (!headed || newMask != mask) {
+		mask   = newMask;
+		headed = true;
+		header();
+	}
+
+	synced = true;
+
+	tick    += ((buf[2] | buf[3] << 8) - lastTick) & 0xFFFF;
+	lastTick = buf[2] | buf[3] << 8;
+
+	printf("%u,%lu", seq, tick);
+
+	for (i = 0; i < TELEM_N_FIELDS; i++) {
+		if (mask & (1u << i)) {
+			values[i] = next[i];
+			printf(",%d", values[i]);
+		}
+	}
+
+	putchar('\n');
+}
+
+
+/* ========================================================================== */
+
+int main ( int argc, char* argv[] )
+{
+	FILE* in = stdin;
+
+	uchar raw[TELEM_WIRE_MAX];
+	uchar buf[TELEM_WIRE_MAX];
+	uint  len = 0;
+	bool  overflow = false;
+	int   c, n;
+
+	if (argc > 1 && (in = fopen(argv[1], "rb")) == NULL) {
+		perror(argv[1]);
+		return 1;
+	}
+
+	while ((c = fgetc(in)) != EOF) {
+		if (c != 0) {
+			if (len < sizeof(raw)) {
+				raw[len++] = c;
+			} else {
+				overflow = true;            // Not a frame
+			}
+			continue;
+		}
+
+		if (len > 0 && !overflow) {
+			if ((n = uncobs(raw, len, buf)) > 0 && n <= TELEM_FRAME_MAX) {
+				frame(buf, n);
+			}
+		}
+
+		len      = 0;
+		overflow = false;
+	}
+
+	fprintf(stderr, "telemdump: %lu frames, %lu lost, %lu rejected\n", nFrames, nLost, nBad);
+
+	if (in != stdin) {
+		fclose(in);
+	}
+
+	return 0;
+}
+
+
+/* = EOF ==================================================================== */